@@ -1,12 +1,21 @@
 #ifndef ESTD_H
 #define ESTD_H
 
+#include "estd/aio.h"
 #include "estd/array.h"
+#include "estd/codec.h"
 #include "estd/eerror.h"
 #include "estd/efile.h"
 #include "estd/emath.h"
 #include "estd/estring.h"
 #include "estd/global.h"
 #include "estd/grow.h"
+#include "estd/intern.h"
+#include "estd/regex.h"
+#include "estd/rope.h"
+#include "estd/shstring.h"
+#include "estd/strbuilder.h"
+#include "estd/strtable.h"
+#include "estd/utf8.h"
 
 #endif // ESTD_H
@@ -0,0 +1,160 @@
+#ifndef AIO_H
+#define AIO_H
+
+#if __STDC_VERSION__ < 202311L // <C23
+#include <stdbool.h>
+#endif
+#include <stddef.h>
+#include <stdint.h>
+
+#include "estd/eerror.h"
+#include "estd/efile.h"
+
+/*
+Asynchronous positioned reads and writes. On Linux requests are passed to kernel by io_uring,
+if it isn't available (old kernel, disabled by seccomp, other OS) pool of threads runs blocking
+pread/pwrite. Both backends have the same behavior: requests are submitted in batches, then
+completions are collected by aio_poll (doesn't block) or aio_wait, which call callbacks.
+Callbacks are always called in thread which calls aio_poll/aio_wait.
+One aio_context shouldn't be used from several threads at once
+*/
+
+/// Flags for aio_init
+#define AIO_DEFAULT 0
+#define AIO_FORCE_THREADS 1 // Don't try io_uring
+
+/// Buffer index of request which doesn't use registered buffer
+#define AIO_NO_BUFFER (-1)
+
+typedef enum AIO_OP {
+  AIO_READ,
+  AIO_WRITE,
+
+} AIO_OP;
+
+typedef struct aio_context aio_context;
+typedef struct aio_request aio_request;
+
+/// Function called when request is completed
+typedef void (*aio_callback)(aio_request *req, void *ctx);
+
+/// aio_request is one read or write. It must stay valid and unchanged until it is completed
+struct aio_request {
+  AIO_OP op;
+  int fd;
+  void *buffer;
+  size_t length;
+  uint64_t offset;       // Position in file
+  int buffer_index;      // Index of registered buffer containing buffer or AIO_NO_BUFFER
+  aio_callback callback; // Can be NULL
+  void *ctx;             // Passed to callback
+
+  // Result, valid when done is true
+  size_t result; // Count of transferred bytes. Read can be short at end of file
+  easy_error error;
+  bool done;
+
+  aio_request *next_; // Used by thread backend
+};
+
+/// @defgroup Aio Functions for asynchronous file operations
+/// @{
+
+/**
+ * @brief Create aio_context
+ * @note ctx should be freed after using
+ *
+ * @param queue_depth Max count of requests processed at once
+ * @param flags AIO_DEFAULT or AIO_FORCE_THREADS
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Initialized aio_context or NULL
+ */
+aio_context *aio_init(unsigned queue_depth, int flags, easy_error *err);
+
+/// @brief Freed aio_context. Waits for all submitted requests, but doesn't call their callbacks
+void aio_free_(aio_context *ctx);
+
+#define aio_free(ctx)                                                                              \
+  aio_free_(ctx);                                                                                  \
+  (ctx) = NULL
+
+/// @brief Returns true if ctx uses io_uring, false if it uses threads
+bool aio_uses_io_uring(const aio_context *ctx);
+
+/// @brief Returns count of submitted requests which aren't collected yet
+size_t aio_pending(const aio_context *ctx);
+
+/**
+ * @brief Register buffers, so kernel doesn't map them for every request
+ * @note Request uses registered buffer if its buffer_index is set. Buffers can be registered once
+ *
+ * @param ctx Pointer to aio_context object
+ * @param buffers Array of pointers to buffers
+ * @param sizes Array of sizes of buffers
+ * @param count Count of buffers
+ * @return 0 on success or easy_error
+ */
+easy_error aio_register_buffers(aio_context *ctx, void *const *buffers, const size_t *sizes,
+                                size_t count);
+
+/**
+ * @brief Prepare request for reading length bytes from offset of file
+ * @note Position of reader isn't used and isn't changed
+ *
+ * @param req Pointer to aio_request object
+ * @param reader Pointer to opened file
+ * @param buffer Buffer for data
+ * @param length Count of bytes
+ * @param offset Position in file
+ */
+void aio_prep_read(aio_request *req, freader *reader, void *buffer, size_t length,
+                   uint64_t offset);
+
+/**
+ * @brief Prepare request for writing length bytes at offset of file
+ * @note Data is written by file descriptor, so flush writer before (fwriter_flush)
+ *
+ * @param req Pointer to aio_request object
+ * @param writer Pointer to opened file
+ * @param data Data to write
+ * @param length Count of bytes
+ * @param offset Position in file
+ */
+void aio_prep_write(aio_request *req, fwriter *writer, const void *data, size_t length,
+                    uint64_t offset);
+
+/**
+ * @brief Submit batch of requests
+ * @note If queue is full, it waits until some requests are completed. If io_uring fails
+ * (SYSTEM_CALL_FAILED), requests queued before it stay pending and are completed as usual, the
+ * rest aren't submitted, so aio_pending counts only queued ones
+ *
+ * @param ctx Pointer to aio_context object
+ * @param requests Array of prepared requests
+ * @param count Count of requests
+ * @return 0 on success or easy_error
+ */
+easy_error aio_submit(aio_context *ctx, aio_request *requests, size_t count);
+
+/**
+ * @brief Collect completed requests without waiting
+ *
+ * @param ctx Pointer to aio_context object
+ * @return Count of collected requests
+ */
+size_t aio_poll(aio_context *ctx);
+
+/**
+ * @brief Wait until at least min_count requests are completed and collect them
+ * @note min_count is limited by count of pending requests
+ *
+ * @param ctx Pointer to aio_context object
+ * @param min_count Count of requests to wait
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of collected requests
+ */
+size_t aio_wait(aio_context *ctx, size_t min_count, easy_error *err);
+
+///@}
+
+#endif // AIO_H
@@ -0,0 +1,217 @@
+#ifndef CODEC_H
+#define CODEC_H
+
+#if __STDC_VERSION__ < 202311L // <C23
+#include <stdbool.h>
+#endif
+#include <stddef.h>
+#include <stdint.h>
+
+#include "estd/eerror.h"
+#include "estd/estring.h"
+
+/*
+Hex and base64 (RFC 4648) encoding and decoding. Big inputs are processed by SSSE3/AVX2 code on
+x86 if CPU supports them (checked at runtime), otherwise scalar code is used.
+Hex is encoded in lower case, decoding accepts both cases.
+Standard base64 is encoded with '=' padding, URL-safe base64 is encoded without it. Decoding of
+both alphabets accepts text with or without padding, but not whitespaces
+*/
+
+/// Count of chars needed to encode n bytes into hex
+#define HEX_ENCODED_SIZE(n) ((n) * 2)
+
+/// Count of bytes decoded from n hex chars
+#define HEX_DECODED_SIZE(n) ((n) / 2)
+
+/// Count of chars needed to encode n bytes into base64 (with padding)
+#define BASE64_ENCODED_SIZE(n) (((n) + 2) / 3 * 4)
+
+/// Max count of bytes decoded from n base64 chars
+#define BASE64_DECODED_SIZE(n) (((n) + 3) / 4 * 3)
+
+typedef enum {
+  BASE64_STANDARD, // A-Z a-z 0-9 + / with padding
+  BASE64_URL,      // A-Z a-z 0-9 - _ without padding
+
+} BASE64_ALPHABET;
+
+/// hex_decoder is state of streaming hex decoding
+typedef struct hex_decoder {
+  char pending; // First char of unfinished pair
+  bool has_pending;
+
+} hex_decoder;
+
+/// base64_encoder is state of streaming base64 encoding
+typedef struct base64_encoder {
+  BASE64_ALPHABET alphabet;
+  uint8_t pending[3]; // Bytes of unfinished group
+  size_t pending_length;
+
+} base64_encoder;
+
+/// base64_decoder is state of streaming base64 decoding
+typedef struct base64_decoder {
+  BASE64_ALPHABET alphabet;
+  char pending[4]; // Chars of unfinished group
+  size_t pending_length;
+
+} base64_decoder;
+
+/// @defgroup Codec Functions for hex and base64 encoding
+/// @{
+
+/**
+ * @brief Encode bytes into hex
+ * @note Pass out = NULL to get required size of out. Result isn't null-terminated.
+ * Hex encoding has no state, so data can be encoded in chunks by calling it for each chunk
+ *
+ * @param data Pointer to bytes
+ * @param length Count of bytes
+ * @param out Buffer for chars
+ * @param out_size Size of out
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of chars written into out (or required)
+ */
+size_t hex_encode(const void *data, size_t length, char *out, size_t out_size, easy_error *err);
+
+/**
+ * @brief Decode hex into bytes
+ * @note Pass out = NULL to get required size of out. Odd length is invalid
+ *
+ * @param data Pointer to chars
+ * @param length Count of chars
+ * @param out Buffer for bytes
+ * @param out_size Size of out
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of bytes written into out (or required). INVALID_ENCODING is set on bad input
+ */
+size_t hex_decode(const char *data, size_t length, void *out, size_t out_size, easy_error *err);
+
+/**
+ * @brief Encode bytes into base64
+ * @note Pass out = NULL to get required size of out. Result isn't null-terminated
+ *
+ * @param data Pointer to bytes
+ * @param length Count of bytes
+ * @param out Buffer for chars
+ * @param out_size Size of out
+ * @param alphabet BASE64_STANDARD or BASE64_URL
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of chars written into out (or required)
+ */
+size_t base64_encode(const void *data, size_t length, char *out, size_t out_size,
+                     BASE64_ALPHABET alphabet, easy_error *err);
+
+/**
+ * @brief Decode base64 into bytes
+ * @note Pass out = NULL to get required size of out. Bytes of out after decoded ones can be changed
+ *
+ * @param data Pointer to chars
+ * @param length Count of chars
+ * @param out Buffer for bytes
+ * @param out_size Size of out
+ * @param alphabet BASE64_STANDARD or BASE64_URL
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of bytes written into out (or required). INVALID_ENCODING is set on bad input
+ */
+size_t base64_decode(const char *data, size_t length, void *out, size_t out_size,
+                     BASE64_ALPHABET alphabet, easy_error *err);
+
+/// @brief Add hex of data to end of str. See hex_encode
+easy_error string_append_hex_encoded(string *str, const void *data, size_t length);
+
+/// @brief Add bytes decoded from hex to end of str. If data is invalid, str isn't changed
+easy_error string_append_hex_decoded(string *str, const char *data, size_t length);
+
+/// @brief Add base64 of data to end of str. See base64_encode
+easy_error string_append_base64_encoded(string *str, const void *data, size_t length,
+                                        BASE64_ALPHABET alphabet);
+
+/// @brief Add bytes decoded from base64 to end of str. If data is invalid, str isn't changed
+easy_error string_append_base64_decoded(string *str, const char *data, size_t length,
+                                        BASE64_ALPHABET alphabet);
+
+/// @brief Prepare decoder for new stream
+void hex_decoder_init(hex_decoder *dec);
+
+/**
+ * @brief Decode next chunk of hex stream
+ * @note Chunk can end in the middle of pair. Nothing is consumed if out is too small
+ *
+ * @param dec Pointer to hex_decoder object
+ * @param data Pointer to chars
+ * @param length Count of chars
+ * @param out Buffer for bytes. At least HEX_DECODED_SIZE(length + 1) bytes are required
+ * @param out_size Size of out
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of bytes written into out
+ */
+size_t hex_decoder_update(hex_decoder *dec, const char *data, size_t length, void *out,
+                          size_t out_size, easy_error *err);
+
+/// @brief Finish hex stream. Returns INVALID_ENCODING if stream has odd length
+easy_error hex_decoder_final(hex_decoder *dec);
+
+/// @brief Prepare encoder for new stream
+void base64_encoder_init(base64_encoder *enc, BASE64_ALPHABET alphabet);
+
+/**
+ * @brief Encode next chunk of stream
+ * @note Bytes of unfinished group are kept in enc. Nothing is consumed if out is too small
+ *
+ * @param enc Pointer to base64_encoder object
+ * @param data Pointer to bytes
+ * @param length Count of bytes
+ * @param out Buffer for chars. At least BASE64_ENCODED_SIZE(length) chars are required
+ * @param out_size Size of out
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of chars written into out
+ */
+size_t base64_encoder_update(base64_encoder *enc, const void *data, size_t length, char *out,
+                             size_t out_size, easy_error *err);
+
+/**
+ * @brief Encode rest of stream. Padding is added only for BASE64_STANDARD
+ *
+ * @param enc Pointer to base64_encoder object
+ * @param out Buffer for chars. 4 chars are enough
+ * @param out_size Size of out
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of chars written into out
+ */
+size_t base64_encoder_final(base64_encoder *enc, char *out, size_t out_size, easy_error *err);
+
+/// @brief Prepare decoder for new stream
+void base64_decoder_init(base64_decoder *dec, BASE64_ALPHABET alphabet);
+
+/**
+ * @brief Decode next chunk of stream
+ * @note Chars of unfinished group are kept in dec. Nothing is consumed if out is too small
+ *
+ * @param dec Pointer to base64_decoder object
+ * @param data Pointer to chars
+ * @param length Count of chars
+ * @param out Buffer for bytes. At least BASE64_DECODED_SIZE(length + 1) bytes are required
+ * @param out_size Size of out
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of bytes written into out
+ */
+size_t base64_decoder_update(base64_decoder *dec, const char *data, size_t length, void *out,
+                             size_t out_size, easy_error *err);
+
+/**
+ * @brief Decode rest of stream
+ *
+ * @param dec Pointer to base64_decoder object
+ * @param out Buffer for bytes. 3 bytes are enough
+ * @param out_size Size of out
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of bytes written into out. INVALID_ENCODING is set if stream is cut
+ */
+size_t base64_decoder_final(base64_decoder *dec, void *out, size_t out_size, easy_error *err);
+
+///@}
+
+#endif // CODEC_H
@@ -31,7 +31,12 @@ typedef enum {
   FILE_READ_FAILED = -10,
   PARSER_UNKOWN_ARGUMENT = -11,
   PARSER_NO_REQUIRED_PARAMETR = -12,
-  PARSER_NO_PASSED_PARAMETRS = -13
+  PARSER_NO_PASSED_PARAMETRS = -13,
+  NUMBER_INVALID = -14,
+  NUMBER_OUT_OF_RANGE = -15,
+  INVALID_ENCODING = -16,
+  REGEX_INVALID = -17,
+  SYSTEM_CALL_FAILED = -18
 
 } easy_error;
 
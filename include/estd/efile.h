@@ -1,6 +1,9 @@
 #ifndef EFILE_H
 #define EFILE_H
 
+#if __STDC_VERSION__ < 202311L // <C23
+#include <stdbool.h>
+#endif
 #include <stdint.h>
 #include <stdio.h>
 #include <sys/stat.h>
@@ -25,31 +28,103 @@ typedef enum FILE_MODE {
                     // append into existing.
 } FILE_MODE;
 
+/// Flags of read_file_parallel
+typedef enum FILE_READ_FLAGS {
+  FILE_READ_DEFAULT = 0,
+  FILE_READ_DIRECT = 1 // Bypass page cache (O_DIRECT) for cold reads of big files, if supported
+
+} FILE_READ_FLAGS;
+
+/// Size of range read by one pread of read_file_parallel (8 MiB), multiple of FILE_DIRECT_ALIGN
+#define FILE_PARALLEL_CHUNK ((size_t)8 * 1024 * 1024)
+
+/// Alignment of buffers, offsets and sizes used with FILE_READ_DIRECT
+#define FILE_DIRECT_ALIGN ((size_t)4096)
+
+/// Length for file_copy_range to copy until end of input
+#define FILE_COPY_ALL UINT64_MAX
+
+/// Size of buffer used to copy files when kernel can't copy them (1 MiB)
+#define FILE_COPY_BUFFER_SIZE ((size_t)1024 * 1024)
+
+/// Default size of fwriter buffer set by fwriter_set_buffer (1 MiB)
+#define FWRITER_BUFFER_SIZE ((size_t)1024 * 1024)
+
+/// When buffered fwriter flushes buffer. Zero fields are disabled, full buffer is always flushed
+typedef struct fwriter_policy {
+  size_t flush_bytes;      // Flush when buffer has at least flush_bytes
+  size_t flush_records;    // Flush after flush_records writing calls
+  uint64_t flush_interval; // Flush if flush_interval milliseconds passed since last flush. It's
+                           // checked on writing, there is no background thread
+  bool sync;               // Wait until data is on disk (fdatasync) after each flush
+
+} fwriter_policy;
+
 typedef struct fwriter {
   FILE *fp;
   FILE_MODE mode;
   string *path;
   int64_t pos;
-  size_t file_size;
+  size_t file_size; // End of file in append modes, where all writes go
+
+  // Own buffer of fwriter_set_buffer. If buffer is NULL, stdio buffer is used
+  char *buffer;
+  size_t buffer_size;
+  size_t buffered; // Count of bytes in buffer
+  size_t records;  // Count of writing calls since last flush
+  uint64_t last_flush;
+  fwriter_policy policy;
 
 } fwriter;
 
+/// Hints for memory-mapped files. Flags can be combined with |
+typedef enum FILE_MAP_ADVICE {
+  FILE_MAP_NORMAL = 0,     // No special treatment
+  FILE_MAP_SEQUENTIAL = 1, // File is read once from start to end, so aggressive read-ahead is used
+  FILE_MAP_WILLNEED = 2,   // Start reading whole file into page cache right now
+  FILE_MAP_HUGEPAGE = 4    // Use transparent huge pages if system supports them
+} FILE_MAP_ADVICE;
+
 typedef struct freader {
   FILE *fp;
   FILE_MODE mode;
   int64_t pos;
+  void *map;       // Mapped content of file or NULL if file isn't mapped
+  size_t map_size; // Size of mapped content
 
 } freader;
 
+/// Default size of line_reader buffer (64 KiB)
+#define LINE_READER_BUFFER_SIZE ((size_t)64 * 1024)
+
+/// line_reader reads file by big blocks and returns lines as views into its buffer
+/// @note Line longer than buffer makes buffer grow
+typedef struct line_reader {
+  freader *reader;
+  char *buffer;
+  size_t capacity;
+  size_t start;       // Start of unread data in buffer
+  size_t end;         // End of data in buffer
+  size_t line_number; // Number of last returned line, counting from 1
+  bool strip_cr;      // Remove '\r' before '\n' (CRLF line endings)
+  bool eof;
+
+} line_reader;
+
 #define file_position(io) (io)->pos
 #define file_mode(io) (io)->mode
 
 #define IS_VALID_FILE(io) ((io)->fp != NULL)
 #define IS_EOF(reader) (feof((reader)->fp))
 
+// Position (pos) is counted by reading and writing functions without asking OS.
+// Use these macros to move position or file_sync_position after using FILE* directly, file_getc
+// or file_putc
 #define get_position(io) ftell((io)->fp);
-#define file_seek(io, offset, origin) fseek((io->fp), (offset), (origin));
-#define file_rewind(io) rewind((io)->fp)
+#define file_sync_position(io) ((io)->pos = ftell((io)->fp))
+#define file_seek(io, offset, origin)                                                              \
+  ((fseek((io)->fp, (offset), (origin)) == 0 && file_sync_position(io) >= 0) ? 0 : -1)
+#define file_rewind(io) (rewind((io)->fp), (io)->pos = 0)
 
 #define file_getc(reader) fgetc((reader)->fp)
 #define file_putc(ch, writer) fputc(ch, (writer)->fp)
@@ -117,6 +192,21 @@ easy_error closew(fwriter *writer);
  */
 size_t write_bytes(fwriter *writer, const void *data, size_t size, size_t count, easy_error *err);
 
+/**
+ * @brief Writes several pieces of data by one call
+ * @note If writer is buffered and pieces don't fit into buffer, buffer and pieces are written by
+ * one writev call
+ *
+ * @param writer Pointer to opened file
+ * @param parts Array of pieces of data
+ * @param count Count of pieces
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ *
+ * @return Count of bytes written successfully (buffered bytes count as written), can be less than
+ * total size on error
+ */
+size_t write_bytesv(fwriter *writer, const string_view *parts, size_t count, easy_error *err);
+
 /**
  * @brief Formatted writing into opened file
  *
@@ -139,6 +229,23 @@ int writef(fwriter *writer, const char *format, ...);
  */
 size_t read_bytes(freader *reader, void *buffer, size_t size, size_t count, easy_error *err);
 
+/**
+ * @brief Read length bytes starting from offset of file
+ * @note Position of reader isn't used and isn't changed, so one reader can be used by several
+ * threads at once. Data buffered by stdio isn't seen, so don't mix it with writing into same
+ * file. On systems without pread it seeks and isn't thread-safe
+ *
+ * @param reader Pointer to opened file
+ * @param offset Position in file
+ * @param buffer Pointer to the buffer memory block where the data read will be stored
+ * @param length Count of bytes to be read
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ *
+ * @return Count of bytes readed successfully. It is less than length only at end of file
+ */
+size_t read_bytes_at(freader *reader, uint64_t offset, void *buffer, size_t length,
+                     easy_error *err);
+
 /**
  * @brief Formatted reading from opened file
  *
@@ -166,4 +273,126 @@ string *read_line(freader *reader, easy_error *err);
  */
 string *read_file(freader *reader, easy_error *err);
 
+/**
+ * @brief Read whole file by several threads
+ * @note File is split into ranges of FILE_PARALLEL_CHUNK bytes, which are read by concurrent
+ * preads into one buffer allocated for whole file. If file changes while reading,
+ * FILE_READ_FAILED is set. On systems without pread file is read by one thread
+ *
+ * @param filename Path to file
+ * @param nthreads Count of threads, 0 means count of CPUs
+ * @param flags Flags of FILE_READ_FLAGS
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ *
+ * @return Initialized string object
+ */
+string *read_file_parallel(const char *filename, size_t nthreads, int flags, easy_error *err);
+
+/**
+ * @brief Copy content of file src into file dst, which is created or rewritten
+ * @note Data is copied by kernel (copy_file_range, sendfile or splice for pipes), so it doesn't
+ * pass through user space. Buffered copying is used only when kernel can't copy.
+ * Copying file into itself is INVALID_ARGUMENT
+ *
+ * @param src Path to source file
+ * @param dst Path to destination file
+ * @return 0 on success or easy_error
+ */
+easy_error file_copy(const char *src, const char *dst);
+
+/**
+ * @brief Copy length bytes from in_offset of reader into out_offset of writer
+ * @note Positions of reader and writer aren't used and aren't changed. Offset of pipe is ignored.
+ * Writer is flushed before copying. Writers in append modes aren't supported
+ *
+ * @param reader Pointer to opened file
+ * @param in_offset Position in source file
+ * @param writer Pointer to opened file
+ * @param out_offset Position in destination file
+ * @param length Count of bytes or FILE_COPY_ALL
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of copied bytes. It is less than length only at end of input
+ */
+uint64_t file_copy_range(freader *reader, uint64_t in_offset, fwriter *writer,
+                         uint64_t out_offset, uint64_t length, easy_error *err);
+
+/**
+ * @brief Open file for reading and map its content into memory
+ * @note freader should be close after using, it also unmaps file.
+ * On systems without mmap content is read into memory. File must be regular (see read_file_mapped)
+ *
+ * @param filename Path to file
+ * @param advice Flags of FILE_MAP_ADVICE
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ *
+ * @return Pointer to opened file
+ */
+freader *freader_mmap(const char *filename, int advice, easy_error *err);
+
+/**
+ * @brief Get content of file without copying
+ * @note If reader wasn't opened by freader_mmap, file is mapped with FILE_MAP_SEQUENTIAL.
+ * View is read-only, isn't null-terminated and is valid until reader is closed.
+ * Position of reader isn't changed. Only regular files can be mapped, for pipes, devices and
+ * pseudo-files without size (like in /proc) INVALID_ARGUMENT is set, use read_file for them
+ *
+ * @param reader Pointer to opened file
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ *
+ * @return View of whole content of file
+ */
+string_view read_file_mapped(freader *reader, easy_error *err);
+
+/**
+ * @brief Make writer use own big buffer instead of stdio one
+ * @note Data is written into file descriptor directly, so flush writer by fwriter_flush before
+ * using its FILE* or file_seek. Buffer is flushed and freed by closew
+ *
+ * @param writer Pointer to opened file
+ * @param buffer_size Size of buffer. Pass 0 to use FWRITER_BUFFER_SIZE
+ * @param policy When buffer is flushed. Pass NULL to flush only full buffer
+ *
+ * @return 0 on success or easy_error
+ */
+easy_error fwriter_set_buffer(fwriter *writer, size_t buffer_size, const fwriter_policy *policy);
+
+/// @brief Write all buffered data into file
+easy_error fwriter_flush(fwriter *writer);
+
+/// @brief Write all buffered data and wait until it is on disk
+easy_error fwriter_sync(fwriter *writer);
+
+/**
+ * @brief Create line_reader for reading lines of opened file
+ * @note lr should be freed after using. Reading starts from current position of reader
+ *
+ * @param reader Pointer to opened file
+ * @param buffer_size Initial size of buffer. Pass 0 to use LINE_READER_BUFFER_SIZE
+ * @param strip_cr Remove '\r' at end of lines
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ *
+ * @return Initialized line_reader object or NULL
+ */
+line_reader *line_reader_init(freader *reader, size_t buffer_size, bool strip_cr,
+                              easy_error *err);
+
+/// @brief Freed line_reader object. File isn't closed
+void line_reader_free_(line_reader *lr);
+
+#define line_reader_free(lr)                                                                       \
+  line_reader_free_(lr);                                                                           \
+  (lr) = NULL
+
+/**
+ * @brief Read next line without '\n'
+ * @note View points into buffer of lr, so it's valid until next call
+ *
+ * @param lr Pointer to line_reader object
+ * @param line View of line is stored here
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ *
+ * @return true if line was read, false at end of file or on error
+ */
+bool line_reader_next(line_reader *lr, string_view *line, easy_error *err);
+
 #endif // EFILE_H
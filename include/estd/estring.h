@@ -5,6 +5,10 @@
 #include <stdbool.h>
 #endif
 #include <stddef.h>
+#include <stdint.h>
+#ifndef __STDC_NO_ATOMICS__
+#include <stdatomic.h>
+#endif
 
 #include "estd/eerror.h"
 
@@ -18,14 +22,56 @@
  */
 int boyer_moore_search(const char *T, const char *F);
 
+/**
+ * @brief Length-aware version of boyer_moore_search
+ * @note T and F don't have to be null-terminated. Empty F is found at position 0
+ *
+ * @param T Text to search in
+ * @param n Length of T
+ * @param F Fragment to search for
+ * @param m Length of F
+ * @return Position of first occurrence, -1 if F is not in T, or easy_error code
+ */
+ptrdiff_t boyer_moore_search_n(const char *T, size_t n, const char *F, size_t m);
+
+/**
+ * @brief Fast non-cryptographic 64-bit hash of bytes
+ * @note Result is never 0. It can differ between platforms, so don't store it
+ *
+ * @param data Pointer to bytes
+ * @param length Count of bytes
+ * @return Hash of data
+ */
+uint64_t hash_bytes(const char *data, size_t length);
+
+// Cached hash is atomic, so string_hash can be called by several threads for one shared string
+#ifndef __STDC_NO_ATOMICS__
+typedef _Atomic uint64_t string_hash_cache;
+#define string_hash_load(cache) atomic_load_explicit(&(cache), memory_order_relaxed)
+#define string_hash_store(cache, value)                                                            \
+  atomic_store_explicit(&(cache), (value), memory_order_relaxed)
+#else
+typedef uint64_t string_hash_cache; // Without atomics string_hash isn't thread-safe
+#define string_hash_load(cache) (cache)
+#define string_hash_store(cache, value) ((cache) = (value))
+#endif
+
 /// string is struct for easier usage of strings type
 typedef struct string {
   char *data;
-  size_t length;   // Size of string
-  size_t capacity; // Size of allocate memory
+  size_t length;          // Size of string
+  size_t capacity;        // Size of allocate memory
+  string_hash_cache hash; // Cached result of string_hash, 0 if it isn't computed yet
 
 } string;
 
+/// string_view is non-owning reference to sequence of chars. It doesn't have to be null-terminated
+typedef struct string_view {
+  const char *data;
+  size_t length;
+
+} string_view;
+
 // Macros for getting fields of string struct
 #define string_length(string) (string)->length
 #define string_capacity(string) (string)->capacity
@@ -37,6 +83,13 @@ typedef struct string {
  */
 #define is_empty(string) ((string)->length == 0)
 
+/**
+ * @def string_invalidate_hash(string)
+ * @brief Drop cached hash of string
+ * @warning Call it after changing string->data directly. Functions of library do it themselves
+ */
+#define string_invalidate_hash(string) string_hash_store((string)->hash, 0)
+
 /// @defgroup String Functions relative to string type
 /// @{
 
@@ -113,6 +166,102 @@ easy_error string_append(string *str, const char *cstr);
  */
 easy_error string_appendc(string *str, const char ch);
 
+/**
+ * @brief Add n bytes of data to end of str
+ *
+ * @param str Pointer to string object
+ * @param data Pointer to data
+ * @param n Count of bytes
+ * @return 0 on success or easy_error
+ */
+easy_error string_append_n(string *str, const char *data, size_t n);
+
+/**
+ * @brief Formatted appending to end of str
+ * @note Formats directly into free capacity of str, so usually doesn't allocate
+ *
+ * @param str Pointer to string object
+ * @param format Format string same as in printf
+ * @return 0 on success or easy_error
+ */
+easy_error string_appendf(string *str, const char *format, ...);
+
+/**
+ * @brief Add decimal representation of signed integer to end of str
+ *
+ * @param str Pointer to string object
+ * @param value Number
+ * @return 0 on success or easy_error
+ */
+easy_error string_append_i64(string *str, int64_t value);
+
+/**
+ * @brief Add decimal representation of unsigned integer to end of str
+ *
+ * @param str Pointer to string object
+ * @param value Number
+ * @return 0 on success or easy_error
+ */
+easy_error string_append_u64(string *str, uint64_t value);
+
+/**
+ * @brief Add shortest representation of double, which is read back to the same value
+ * @note Doesn't depend on locale. Uses plain notation for numbers in [1e-6, 1e21), otherwise
+ * exponential one (1.5e+300). Special values are written as nan, inf and -inf
+ *
+ * @param str Pointer to string object
+ * @param value Number
+ * @return 0 on success or easy_error
+ */
+easy_error string_append_f64(string *str, double value);
+
+/**
+ * @brief Add lowercase hexadecimal representation of number without leading zeros and prefix
+ *
+ * @param str Pointer to string object
+ * @param value Number
+ * @return 0 on success or easy_error
+ */
+easy_error string_append_hex(string *str, uint64_t value);
+
+/**
+ * @brief Parse signed decimal integer from beginning of data
+ * @note data doesn't have to be null-terminated. Leading whitespaces are not skipped
+ * @note On overflow *out is set to INT64_MAX or INT64_MIN and all digits are consumed
+ *
+ * @param data Pointer to chars. Use str->data or view.data to parse string or string_view
+ * @param length Count of chars in data
+ * @param out Pointer to result
+ * @param consumed Count of parsed chars is stored here. Pass NULL if you don't need it
+ * @return 0 on success or easy_error
+ */
+easy_error string_to_i64(const char *data, size_t length, int64_t *out, size_t *consumed);
+
+/**
+ * @brief Parse unsigned decimal integer from beginning of data
+ * @note Same as string_to_i64, except minus sign is not accepted
+ *
+ * @param data Pointer to chars
+ * @param length Count of chars in data
+ * @param out Pointer to result
+ * @param consumed Count of parsed chars is stored here. Pass NULL if you don't need it
+ * @return 0 on success or easy_error
+ */
+easy_error string_to_u64(const char *data, size_t length, uint64_t *out, size_t *consumed);
+
+/**
+ * @brief Parse double from beginning of data
+ * @note Accepts [+-]digits[.digits][(e|E)[+-]digits], inf, infinity and nan. '.' is decimal
+ * point in any locale. Result is correctly rounded
+ *
+ * @param data Pointer to chars
+ * @param length Count of chars in data
+ * @param out Pointer to result
+ * @param consumed Count of parsed chars is stored here. Pass NULL if you don't need it
+ * @return 0 on success or easy_error
+ */
+easy_error string_to_f64(const char *data, size_t length, double *out, size_t *consumed);
+
 /**
  * @brief Get char by index
  *
@@ -126,18 +275,69 @@ char string_at(const string *str, size_t index, easy_error *err);
 /// @brief string as Cstring or NULL if str is bad
 const char *string_cstr(const string *str);
 
+/// @brief View of whole string. If str is bad, view will be {NULL, 0}
+string_view string_as_view(const string *str);
+
+/// @brief View of Cstring. If cstr is NULL, view will be {NULL, 0}
+string_view string_view_from_cstr(const char *cstr);
+
 /**
  * @brief Find fragment in string and return positon of it
  * @note Use boyer moore algorithm for finding positon
  *
  * @param str Pointer to string object
  * @param fragment Fragment to find in str
- * @return Position of fragment or -1
+ * @return Position of fragment, -1 or easy_error code
  */
-int string_find(const string *str, const char *fragment);
+ptrdiff_t string_find(const string *str, const char *fragment);
+
+/**
+ * @brief Find first fragment in string, starting search from given position
+ *
+ * @param str Pointer to string object
+ * @param from Position to start search from
+ * @param fragment Fragment to find in str
+ * @return Position of fragment(counting from start of str), -1 or easy_error code
+ */
+ptrdiff_t string_find_from(const string *str, size_t from, const char *fragment);
+
+/**
+ * @brief Find last fragment in string
+ *
+ * @param str Pointer to string object
+ * @param fragment Fragment to find in str
+ * @return Position of last fragment, -1 or easy_error code
+ */
+ptrdiff_t string_rfind(const string *str, const char *fragment);
+
+/**
+ * @brief Find all non-overlapping fragments in string
+ * @note Only first out_size positions are written. To get buffer of right size, call fn with
+ * out = NULL and out_size = 0 first
+ *
+ * @param str Pointer to string object
+ * @param fragment Non empty fragment to find in str
+ * @param out Buffer for positions of fragments
+ * @param out_size Size of out buffer
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of found fragments
+ */
+size_t string_find_all(const string *str, const char *fragment, size_t *out, size_t out_size,
+                       easy_error *err);
+
+/**
+ * @brief Count non-overlapping fragments in string
+ *
+ * @param str Pointer to string object
+ * @param fragment Non empty fragment to find in str
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of fragments
+ */
+size_t string_count(const string *str, const char *fragment, easy_error *err);
 
 /**
  * @brief Compare two string
+ * @note Same as string_equal
  *
  * @param str1,str2 Pointers to string objects
  * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
@@ -145,6 +345,26 @@ int string_find(const string *str, const char *fragment);
  */
 bool string_compare_bool(const string *str1, const string *str2, easy_error *err);
 
+/**
+ * @brief Checks that two strings are equal
+ * @note Lengths are compared first, then cached hashes (if both strings have them), and only
+ * then content. So strings used as keys should have hash computed by string_hash
+ *
+ * @param str1,str2 Pointers to string objects
+ * @return true if strings are equal. If one of string is NULL return false
+ */
+bool string_equal(const string *str1, const string *str2);
+
+/**
+ * @brief Returns hash of string content. Hash is computed once and cached in str
+ * @note Cached hash is dropped by functions changing str. Several threads can hash one const
+ * string at once (if compiler has C11 atomics, otherwise use hash_bytes for shared strings)
+ *
+ * @param str Pointer to string object
+ * @return Hash of string (see hash_bytes) or 0 if str is NULL
+ */
+uint64_t string_hash(const string *str);
+
 /**
  * @brief Compare two string
  *
@@ -7,12 +7,38 @@ It was inspired by this repo:
 https://github.com/LekKit/sha256
 */
 
+#if __STDC_VERSION__ < 202311L // <C23
+#include <stdbool.h>
+#endif
 #include <stddef.h>
 #include <stdint.h>
 
+#include "estd/eerror.h"
+#include "estd/efile.h"
+
 #define SHA256_HASH_SIZE 32
 #define SHA256_HEX_SIZE ((SHA256_HASH_SIZE * 2) + 1)
 
+// Files are read by parts of this size (1 MiB). Bigger files are read by second thread into
+// two such buffers, while first one is hashed
+#define SHA256_FILE_BUFFER_SIZE ((size_t)1024 * 1024)
+
+// Size of state exported by sha256_export. Format of version 2 is same on all platforms and
+// ends with checksum
+#define SHA256_STATE_VERSION 2
+#define SHA256_STATE_SIZE 114
+
+// Implementations of compression function. Best one supported by CPU is chosen at runtime
+typedef enum SHA256_IMPL {
+  SHA256_AUTO,   // Not chosen yet
+  SHA256_SCALAR, // Portable C
+  SHA256_SSSE3,  // Message schedule by SSSE3
+  SHA256_AVX2,   // Message schedules of two blocks by AVX2
+  SHA256_SHANI,  // x86 SHA extensions
+  SHA256_ARMV8,  // ARMv8 crypto extension, only if compiler targets it
+
+} SHA256_IMPL;
+
 typedef struct sha256_buff {
   uint64_t data_size;
   uint32_t h[8];
@@ -27,8 +53,34 @@ void sha256_update(sha256_buff *buff, const void *data, size_t size);
 void sha256_finalize(sha256_buff *buff);
 void sha256_read(const sha256_buff *buff, uint8_t out_hash[SHA256_HASH_SIZE]);
 
+// State API. State of unfinished hash (before sha256_finalize) can be saved and imported later, so
+// hashing can be continued from it. Clone copies state to hash different data after same prefix
+easy_error sha256_export(const sha256_buff *buff, uint8_t out_state[SHA256_STATE_SIZE]);
+// Returns INVALID_ENCODING if state has unknown version, wrong checksum or fields which don't agree
+easy_error sha256_import(sha256_buff *buff, const void *state, size_t size);
+void sha256_clone(sha256_buff *dst, const sha256_buff *src);
+
+// Implementation used for hashing
+SHA256_IMPL sha256_impl(void);
+// Force implementation (for tests and benchmarks), SHA256_AUTO chooses best again.
+// Returns false if CPU doesn't support it. Result of all implementations is same
+bool sha256_set_impl(SHA256_IMPL impl);
+
 // One-shot API
 void sha256_hash(const void *data, size_t size, uint8_t out_hash[SHA256_HASH_SIZE]);
 void sha256_hash_hex(const void *data, size_t size, char out_hex[SHA256_HEX_SIZE]);
 
+// Multi-buffer API. Independent messages of any lengths are hashed together in SIMD lanes
+// (4 with SSE2, 8 with AVX2, 16 with AVX-512). With SHA extensions messages are hashed one by
+// one, except batches of short messages (up to 16 KiB), which use AVX-512 lanes if CPU has them
+void sha256_hash_many(const void *const *inputs, const size_t *lengths, size_t count,
+                      uint8_t (*out_hashes)[SHA256_HASH_SIZE]);
+
+// File API. Memory used doesn't depend on size of file. Whole file is hashed, position of reader
+// isn't changed (except pipes, which are read to end)
+easy_error sha256_file(const char *filename, uint8_t out_hash[SHA256_HASH_SIZE]);
+easy_error sha256_freader(freader *reader, uint8_t out_hash[SHA256_HASH_SIZE]);
+// Continue hash with bytes of file after first buff->data_size bytes (for files which grow at end)
+easy_error sha256_update_freader(sha256_buff *buff, freader *reader);
+
 #endif // HASH_H
@@ -0,0 +1,118 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "estd/eerror.h"
+#include "estd/estring.h"
+
+/*
+Table of interned strings (atoms). Every distinct byte sequence is stored once and gets stable
+integer handle, so comparing two interned strings is comparing two integers.
+Bytes are stored in arena of big blocks, so pointers returned by table are valid until it's freed
+*/
+
+/// atom is handle of interned string. Equal strings of one table always have equal atoms
+typedef uint32_t atom;
+
+/// Handle which is never returned for interned string
+#define ATOM_NONE ((atom)0)
+
+/// Default size of one block of intern_table arena (16 KiB)
+#define INTERN_BLOCK_SIZE ((size_t)16 * 1024)
+
+typedef struct intern_block intern_block;
+typedef struct intern_entry intern_entry;
+typedef struct intern_slot intern_slot;
+
+/// intern_table is hash-indexed store of interned strings
+typedef struct intern_table {
+  intern_block *blocks;  // Arena with bytes of strings
+  intern_entry *entries; // entries[atom - 1] describes string of atom
+  intern_slot *slots;    // Open addressing hash index
+  size_t count;          // Count of interned strings
+  size_t entries_capacity;
+  size_t slots_capacity; // Always power of two
+
+} intern_table;
+
+#define intern_count(table) (table)->count
+
+/// @brief Compare two atoms of one table
+#define atom_equal(a, b) ((a) == (b))
+
+/// @defgroup Intern Functions relative to intern_table type
+/// @{
+
+/**
+ * @brief Create empty intern_table
+ * @note table should be freed after using
+ *
+ * @param initial_capacity Count of strings that can be interned without rehashing
+ * @return Initialized intern_table object or NULL if allocation failed
+ */
+intern_table *intern_table_init(size_t initial_capacity);
+
+/// @brief Freed intern_table object. All atoms and views of table become invalid
+void intern_table_free_(intern_table *table);
+
+#define intern_table_free(table)                                                                   \
+  intern_table_free_(table);                                                                       \
+  (table) = NULL
+
+/**
+ * @brief Intern length bytes of data
+ * @note data doesn't have to be null-terminated and can contain '\0'
+ *
+ * @param table Pointer to intern_table object
+ * @param data Pointer to chars
+ * @param length Count of chars
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Atom of data or ATOM_NONE on error
+ */
+atom intern_add_n(intern_table *table, const char *data, size_t length, easy_error *err);
+
+/// @brief Intern Cstring. See intern_add_n
+atom intern_add(intern_table *table, const char *cstr, easy_error *err);
+
+/// @brief Intern content of string. See intern_add_n
+atom intern_add_string(intern_table *table, const string *str, easy_error *err);
+
+/**
+ * @brief Intern many strings at once. Table grows only once for all of them
+ *
+ * @param table Pointer to intern_table object
+ * @param views Array of views to intern
+ * @param count Count of views
+ * @param out Array of count atoms, where atoms of views are stored
+ * @return 0 on success or easy_error
+ */
+easy_error intern_add_many(intern_table *table, const string_view *views, size_t count, atom *out);
+
+/**
+ * @brief Find atom of data without interning it
+ *
+ * @param table Pointer to intern_table object
+ * @param data Pointer to chars
+ * @param length Count of chars
+ * @return Atom of data or ATOM_NONE if data was not interned
+ */
+atom intern_find(const intern_table *table, const char *data, size_t length);
+
+/**
+ * @brief Returns interned string of atom
+ * @note View is null-terminated and valid until table is freed
+ *
+ * @param table Pointer to intern_table object
+ * @param a Atom
+ * @return View of string or empty view with data = NULL if atom is invalid
+ */
+string_view intern_view(const intern_table *table, atom a);
+
+/// @brief Returns interned string of atom as Cstring or NULL if atom is invalid
+const char *intern_cstr(const intern_table *table, atom a);
+
+///@}
+
+#endif // INTERN_H
@@ -0,0 +1,148 @@
+#ifndef MERKLE_H
+#define MERKLE_H
+
+#if __STDC_VERSION__ < 202311L // <C23
+#include <stdbool.h>
+#endif
+#include <stddef.h>
+#include <stdint.h>
+
+#include "estd/eerror.h"
+#include "estd/efile.h"
+#include "estd/hash.h"
+
+/*
+Tree hash over SHA-256. Data is split into leaves of leaf_size bytes (last one can be shorter),
+leaves are hashed in parallel by several threads and combined into binary tree:
+
+  leaf = SHA256(0x00 || leaf data)
+  node = SHA256(0x01 || left || right)
+
+Tree is built level by level, last node of level with odd count of nodes is moved to next level
+unchanged (same tree as RFC 6962). Empty data is one empty leaf. Root depends on leaf_size, so
+trees are comparable only if they have same leaf_size and size.
+Tree keeps hashes of all nodes, so changed ranges can be re-verified or re-hashed without hashing
+whole data again
+*/
+
+/// Leaf size used if 0 is passed (1 MiB)
+#define MERKLE_DEFAULT_LEAF_SIZE ((size_t)1024 * 1024)
+/// Smallest leaf size (1 KiB). Leaf size must be power of two
+#define MERKLE_MIN_LEAF_SIZE ((size_t)1024)
+
+typedef struct merkle_tree {
+  uint64_t size;                      // Size of hashed data
+  size_t leaf_size;                   // Size of every leaf except last one
+  size_t leaf_count;                  // Count of leaves, at least 1
+  size_t levels;                      // Count of levels. Level 0 is leaves, last level is root
+  size_t *level_start;                // Index of first node of levels in nodes, levels + 1 items
+  uint8_t (*nodes)[SHA256_HASH_SIZE]; // Hashes of all nodes, level by level
+
+} merkle_tree;
+
+/// @defgroup Merkle Functions for tree hashing
+/// @{
+
+/**
+ * @brief Build tree of data in memory
+ * @note tree should be freed after using
+ *
+ * @param data Data to hash
+ * @param size Size of data
+ * @param leaf_size Power of two not less than MERKLE_MIN_LEAF_SIZE or 0 for default
+ * @param nthreads Count of threads, 0 means count of CPUs
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Initialized merkle_tree or NULL
+ */
+merkle_tree *merkle_build(const void *data, size_t size, size_t leaf_size, size_t nthreads,
+                          easy_error *err);
+
+/**
+ * @brief Build tree of whole file
+ * @note Leaves are read by pread, so position of reader isn't changed. Pipes aren't supported
+ *
+ * @param reader Pointer to opened file
+ * @param leaf_size Power of two not less than MERKLE_MIN_LEAF_SIZE or 0 for default
+ * @param nthreads Count of threads, 0 means count of CPUs
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Initialized merkle_tree or NULL
+ */
+merkle_tree *merkle_build_freader(freader *reader, size_t leaf_size, size_t nthreads,
+                                  easy_error *err);
+
+/// @brief Open file by filename and build its tree (see merkle_build_freader)
+merkle_tree *merkle_build_file(const char *filename, size_t leaf_size, size_t nthreads,
+                               easy_error *err);
+
+/// @brief Freed merkle_tree
+void merkle_free_(merkle_tree *tree);
+
+#define merkle_free(tree)                                                                          \
+  merkle_free_(tree);                                                                              \
+  (tree) = NULL
+
+/// @brief Copy root hash into out_hash
+void merkle_root(const merkle_tree *tree, uint8_t out_hash[SHA256_HASH_SIZE]);
+
+/// @brief Returns count of nodes of level or 0 if there is no such level
+size_t merkle_level_size(const merkle_tree *tree, size_t level);
+
+/// @brief Returns hash of node of level or NULL if there is no such node
+const uint8_t *merkle_node(const merkle_tree *tree, size_t level, size_t index);
+
+/**
+ * @brief Re-hash leaves which contain bytes [offset, offset + length) and update their parents
+ * @note Size of data must be same as tree->size, otherwise tree must be built again
+ *
+ * @param tree Pointer to merkle_tree object
+ * @param data Whole changed data
+ * @param offset Position of first changed byte
+ * @param length Count of changed bytes
+ * @param nthreads Count of threads, 0 means count of CPUs
+ * @return 0 on success or easy_error
+ */
+easy_error merkle_update(merkle_tree *tree, const void *data, uint64_t offset, uint64_t length,
+                         size_t nthreads);
+
+/// @brief Same as merkle_update, but changed leaves are read from file
+easy_error merkle_update_freader(merkle_tree *tree, freader *reader, uint64_t offset,
+                                 uint64_t length, size_t nthreads);
+
+/**
+ * @brief Hash leaves which contain bytes [offset, offset + length) and compare them with tree
+ *
+ * @param tree Pointer to merkle_tree object
+ * @param data Whole data, must have tree->size bytes
+ * @param offset Position of first byte to check
+ * @param length Count of bytes to check
+ * @param nthreads Count of threads, 0 means count of CPUs
+ * @param bad_leaves Array for indexes of leaves which don't match. Can be NULL
+ * @param max_bad Size of bad_leaves
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of leaves which don't match (can be bigger than max_bad)
+ */
+size_t merkle_verify(const merkle_tree *tree, const void *data, uint64_t offset, uint64_t length,
+                     size_t nthreads, size_t *bad_leaves, size_t max_bad, easy_error *err);
+
+/// @brief Same as merkle_verify, but leaves are read from file
+size_t merkle_verify_freader(const merkle_tree *tree, freader *reader, uint64_t offset,
+                             uint64_t length, size_t nthreads, size_t *bad_leaves, size_t max_bad,
+                             easy_error *err);
+
+/**
+ * @brief Find leaves which differ in two trees of same layout
+ * @note Only subtrees with different hashes are visited
+ *
+ * @param a Pointer to merkle_tree object
+ * @param b Pointer to merkle_tree object with same size and leaf_size
+ * @param leaves Array for indexes of different leaves in increasing order. Can be NULL
+ * @param max_leaves Size of leaves
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of different leaves (can be bigger than max_leaves)
+ */
+size_t merkle_diff(const merkle_tree *a, const merkle_tree *b, size_t *leaves, size_t max_leaves,
+                   easy_error *err);
+
+///@}
+
+#endif // MERKLE_H
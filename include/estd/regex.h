@@ -0,0 +1,127 @@
+#ifndef REGEX_H
+#define REGEX_H
+
+#if __STDC_VERSION__ < 202311L // <C23
+#include <stdbool.h>
+#endif
+#include <stddef.h>
+
+#include "estd/eerror.h"
+#include "estd/efile.h"
+#include "estd/estring.h"
+
+/*
+Regular expressions matched by lazily built DFA, so time of matching is linear in size of text
+(there is no backtracking). Supported syntax:
+  literals, .  [abc] [^a-z] \d \w \s \D \W \S  \n \r \t \f \v \xHH  \ before other punctuation
+  (group) (?:group) a|b  * + ? {n} {n,} {n,m} and their lazy versions *? +? ?? {n,m}?
+  ^ $ - start and end of text
+Matching works with bytes, so . and classes match one byte of UTF-8 text.
+Among matches starting at leftmost position the one preferred by Perl rules is returned
+(alternatives are tried from left, greedy repetition prefers more). Like in RE2, repetition of
+group, which matched empty string, isn't stopped, so groups can differ from backtracking engines.
+regex caches DFA states inside, so one regex object shouldn't be used from several threads at once
+*/
+
+/// Position of group which didn't take part in match
+#define REGEX_NO_POS ((size_t)-1)
+
+typedef struct regex regex;
+
+/// regex_match is position of match or group in text: [start, end)
+typedef struct regex_match {
+  size_t start;
+  size_t end;
+
+} regex_match;
+
+/// Function called by regex_grep for each matched line. Return false to stop reading
+typedef bool (*regex_line_fn)(string_view line, size_t line_number, void *ctx);
+
+/// @defgroup Regex Functions for regular expressions
+/// @{
+
+/**
+ * @brief Compile regular expression
+ * @note re should be freed after using
+ *
+ * @param pattern Cstring with regular expression
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Compiled regex or NULL. REGEX_INVALID is set if pattern has invalid syntax
+ */
+regex *regex_compile(const char *pattern, easy_error *err);
+
+/// @brief Compile regular expression of length chars. See regex_compile
+regex *regex_compile_n(const char *pattern, size_t length, easy_error *err);
+
+/// @brief Freed regex object
+void regex_free_(regex *re);
+
+#define regex_free(re)                                                                             \
+  regex_free_(re);                                                                                 \
+  (re) = NULL
+
+/// @brief Returns count of groups in re, whole match is group 0. If re is NULL returns 0
+size_t regex_groups(const regex *re);
+
+/**
+ * @brief Checks that text contains match of re
+ * @note It's faster than regex_find, because search stops on first found match
+ *
+ * @param re Pointer to regex object
+ * @param text View of text
+ * @return true if text contains match. If one of parameters is bad return false
+ */
+bool regex_is_match(regex *re, string_view text);
+
+/// @brief Checks that str contains match of re. See regex_is_match
+bool regex_is_match_string(regex *re, const string *str);
+
+/**
+ * @brief Find first match of re, which starts at position from or later
+ *
+ * @param re Pointer to regex object
+ * @param text View of text
+ * @param from Position to start search
+ * @param groups Array, where positions of groups are stored. Can be NULL if groups_count is 0
+ * @param groups_count Size of groups. Groups are found only if groups_count > 1
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return true if match was found
+ */
+bool regex_find(regex *re, string_view text, size_t from, regex_match *groups,
+                size_t groups_count, easy_error *err);
+
+/**
+ * @brief Find all non-overlapping matches of re in text
+ * @note Pass out = NULL to only count matches
+ *
+ * @param re Pointer to regex object
+ * @param text View of text
+ * @param out Array for positions of matches
+ * @param out_size Size of out
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of all matches (can be bigger than out_size)
+ */
+size_t regex_find_all(regex *re, string_view text, regex_match *out, size_t out_size,
+                      easy_error *err);
+
+/// @brief Find all matches of re in str. See regex_find_all
+size_t regex_find_all_string(regex *re, const string *str, regex_match *out, size_t out_size,
+                             easy_error *err);
+
+/**
+ * @brief Read file line by line and find lines containing match of re
+ * @note Lines are passed to fn without '\n'. Reading starts from current position of reader
+ *
+ * @param re Pointer to regex object
+ * @param reader Pointer to opened file
+ * @param fn Function called for each matched line. Can be NULL to only count lines
+ * @param ctx Pointer passed to fn
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of matched lines
+ */
+size_t regex_grep(regex *re, freader *reader, regex_line_fn fn, void *ctx, easy_error *err);
+
+///@}
+
+#endif // REGEX_H
@@ -0,0 +1,160 @@
+#ifndef ROPE_H
+#define ROPE_H
+
+#if __STDC_VERSION__ < 202311L // <C23
+#include <stdbool.h>
+#endif
+#include <stddef.h>
+#include <stdint.h>
+
+#include "estd/eerror.h"
+#include "estd/estring.h"
+
+/*
+rope is string for editing big texts. It's piece table: text is list of pieces, each piece
+refers to part of original text or to part of buffer with inserted text. Pieces are kept in
+balanced tree (treap), so insert and erase cost O(log k) for k pieces and never move text
+*/
+
+typedef struct rope_node rope_node;
+
+/// rope is struct for fast inserting and erasing in big texts
+typedef struct rope {
+  rope_node *root;
+  string *owned;         // Original text if it's owned by rope
+  const char *original;  // Original text
+  char *added;           // Buffer with all inserted text
+  size_t added_length;   // Size of used part of added
+  size_t added_capacity; // Size of allocated added
+  uint64_t seed;         // State of generator of priorities of tree nodes
+
+} rope;
+
+/// rope_iter is iterator over pieces of rope
+typedef struct rope_iter {
+  const rope *r;
+  size_t pos; // Position of next char
+
+} rope_iter;
+
+/// @defgroup Rope Functions relative to rope type
+/// @{
+
+/**
+ * @brief Create empty rope
+ * @note r should be freed after using
+ *
+ * @return Initialized rope object or NULL if allocation failed
+ */
+rope *rope_init_empty(void);
+
+/**
+ * @brief Create rope from text. Text is not copied
+ * @warning Text should be valid and unchanged until rope is freed
+ *
+ * @param text View of text
+ * @return Initialized rope object or NULL
+ */
+rope *rope_from_view(string_view text);
+
+/**
+ * @brief Create rope from string and take ownership of it. Text is not copied
+ * @note str is freed with rope, so it shouldn't be used or freed after call
+ *
+ * @param str Pointer to string object, e.g. result of read_file
+ * @return Initialized rope object or NULL. On error str is not freed
+ */
+rope *rope_from_string(string *str);
+
+/// @brief Freed rope object
+void rope_free_(rope *r);
+
+#define rope_free(r)                                                                               \
+  rope_free_(r);                                                                                   \
+  (r) = NULL
+
+/// @brief Returns count of chars in rope or 0 if r is NULL
+size_t rope_length(const rope *r);
+
+/**
+ * @brief Insert n bytes of data at given position
+ *
+ * @param r Pointer to rope object
+ * @param pos Position to insert
+ * @param data Pointer to chars
+ * @param n Count of chars
+ * @return 0 on success or easy_error
+ */
+easy_error rope_insert_n(rope *r, size_t pos, const char *data, size_t n);
+
+/// @brief Insert Cstring at given position. See rope_insert_n
+easy_error rope_insert(rope *r, size_t pos, const char *cstr);
+
+/// @brief Add n bytes of data to end of rope. See rope_insert_n
+easy_error rope_append_n(rope *r, const char *data, size_t n);
+
+/**
+ * @brief Erase count chars starting from given position
+ * @note If pos + count is out of rope, chars are erased until end
+ *
+ * @param r Pointer to rope object
+ * @param pos Position of first char
+ * @param count Count of chars
+ * @return 0 on success or easy_error
+ */
+easy_error rope_erase(rope *r, size_t pos, size_t count);
+
+/**
+ * @brief Get char by index
+ *
+ * @param r Pointer to rope object
+ * @param index Index of char
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Char by index or '\0'
+ */
+char rope_at(const rope *r, size_t index, easy_error *err);
+
+/**
+ * @brief Copy count chars starting from given position into new string
+ * @note Returned string should be freed after using
+ *
+ * @param r Pointer to rope object
+ * @param pos Position of first char
+ * @param count Count of chars. If pos + count is out of rope, chars are copied until end
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Initialized string object or NULL
+ */
+string *rope_substring(const rope *r, size_t pos, size_t count, easy_error *err);
+
+/**
+ * @brief Copy whole rope into new string
+ * @note Returned string should be freed after using
+ *
+ * @param r Pointer to rope object
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Initialized string object or NULL
+ */
+string *rope_flatten(const rope *r, easy_error *err);
+
+/**
+ * @brief Create iterator, which starts from given position
+ * @note Iterator is invalid after changing rope
+ *
+ * @param r Pointer to rope object
+ * @param pos Position of first char
+ * @return Iterator
+ */
+rope_iter rope_iter_init(const rope *r, size_t pos);
+
+/**
+ * @brief Get next piece of text
+ *
+ * @param it Pointer to iterator
+ * @param chunk View of piece is stored here
+ * @return false if there are no more pieces
+ */
+bool rope_iter_next(rope_iter *it, string_view *chunk);
+
+///@}
+
+#endif // ROPE_H
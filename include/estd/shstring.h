@@ -0,0 +1,109 @@
+#ifndef SHSTRING_H
+#define SHSTRING_H
+
+#include <stddef.h>
+
+#include "estd/eerror.h"
+#include "estd/estring.h"
+
+/*
+shared_string is reference-counted string with copy-on-write. Copying only increments counter,
+so one big string can be passed to many owners for free. Before changing, string is copied if
+it has other owners, so changes are never visible to them.
+Counter is atomic, so copies of one shared_string can be used and freed from different threads.
+One shared_string pointer variable shouldn't be changed from several threads at once
+*/
+
+typedef struct shared_string shared_string;
+
+/// @defgroup SharedString Functions relative to shared_string type
+/// @{
+
+/**
+ * @brief Create shared_string from length bytes of data
+ * @note str should be freed after using
+ *
+ * @param data Pointer to chars
+ * @param length Count of chars
+ * @return Initialized shared_string object or NULL
+ */
+shared_string *shared_string_from_n(const char *data, size_t length);
+
+/// @brief Create shared_string from Cstring. See shared_string_from_n
+shared_string *shared_string_from_cstr(const char *cstr);
+
+/// @brief Create shared_string from content of str. See shared_string_from_n
+shared_string *shared_string_from_string(const string *str);
+
+/**
+ * @brief Make new owner of str. Content isn't copied
+ * @note Returned pointer should be freed after using as well as str
+ *
+ * @param str Pointer to shared_string object
+ * @return str or NULL if str is NULL
+ */
+shared_string *shared_string_copy(shared_string *str);
+
+/// @brief Release str. Memory is freed when last owner releases it
+void shared_string_free_(shared_string *str);
+
+#define shared_string_free(str)                                                                    \
+  shared_string_free_(str);                                                                        \
+  (str) = NULL
+
+/// @brief Returns count of owners of str or 0 if str is NULL
+size_t shared_string_refs(const shared_string *str);
+
+/// @brief Returns length of str or 0 if str is NULL
+size_t shared_string_length(const shared_string *str);
+
+/// @brief Returns content of str as Cstring or NULL if str is NULL
+const char *shared_string_cstr(const shared_string *str);
+
+/// @brief Returns view of str or empty view with data = NULL if str is NULL
+string_view shared_string_view(const shared_string *str);
+
+/**
+ * @brief Make sure *str has no other owners, copying its content if needed
+ *
+ * @param str Pointer to shared_string pointer. It's changed if content is copied
+ * @return 0 on success or easy_error
+ */
+easy_error shared_string_make_unique(shared_string **str);
+
+/**
+ * @brief Returns pointer for changing content of *str. See shared_string_make_unique
+ * @note Pointer is valid until *str is changed or freed
+ *
+ * @param str Pointer to shared_string pointer
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Pointer to length chars of *str or NULL
+ */
+char *shared_string_data_mut(shared_string **str, easy_error *err);
+
+/**
+ * @brief Add n bytes of data to end of *str
+ *
+ * @param str Pointer to shared_string pointer
+ * @param data Pointer to chars
+ * @param n Count of chars
+ * @return 0 on success or easy_error
+ */
+easy_error shared_string_append_n(shared_string **str, const char *data, size_t n);
+
+/// @brief Add Cstring to end of *str. See shared_string_append_n
+easy_error shared_string_append(shared_string **str, const char *cstr);
+
+/**
+ * @brief Create plain string with copy of content of str
+ * @note Returned string should be freed after using
+ *
+ * @param str Pointer to shared_string object
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Initialized string object or NULL
+ */
+string *shared_string_to_string(const shared_string *str, easy_error *err);
+
+///@}
+
+#endif // SHSTRING_H
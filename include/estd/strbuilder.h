@@ -0,0 +1,113 @@
+#ifndef STRBUILDER_H
+#define STRBUILDER_H
+
+#include <stddef.h>
+
+#include "estd/eerror.h"
+#include "estd/efile.h"
+#include "estd/estring.h"
+
+/// Default size of one chunk of string_builder (64 KiB)
+#define STRING_BUILDER_CHUNK_SIZE ((size_t)64 * 1024)
+
+typedef struct sb_chunk sb_chunk;
+
+/// string_builder is struct for building big strings from many pieces
+/// @note Pieces are stored in list of chunks, so appending never moves already written bytes
+typedef struct string_builder {
+  sb_chunk *head;
+  sb_chunk *tail;
+  size_t length;     // Total size of appended data
+  size_t chunk_size; // Size of each new chunk
+
+} string_builder;
+
+#define string_builder_length(sb) (sb)->length
+
+/// @defgroup StringBuilder Functions relative to string_builder type
+/// @{
+
+/**
+ * @brief Create empty string_builder
+ * @note sb should be freed after using
+ *
+ * @param chunk_size Size of one chunk. Pass 0 to use STRING_BUILDER_CHUNK_SIZE
+ * @return Initialized string_builder object or NULL if alocation failed
+ */
+string_builder *string_builder_init(size_t chunk_size);
+
+/// @brief Freed string_builder object
+void string_builder_free_(string_builder *sb);
+
+#define string_builder_free(sb)                                                                    \
+  string_builder_free_(sb);                                                                        \
+  (sb) = NULL
+
+/**
+ * @brief Add n bytes of data to end of sb
+ *
+ * @param sb Pointer to string_builder object
+ * @param data Pointer to data
+ * @param n Count of bytes
+ * @return 0 on success or easy_error
+ */
+easy_error string_builder_append_n(string_builder *sb, const char *data, size_t n);
+
+/**
+ * @brief Add Cstring to end of sb
+ *
+ * @param sb Pointer to string_builder object
+ * @param cstr Cstring
+ * @return 0 on success or easy_error
+ */
+easy_error string_builder_append(string_builder *sb, const char *cstr);
+
+/**
+ * @brief Add char to end of sb
+ *
+ * @param sb Pointer to string_builder object
+ * @param ch Character
+ * @return 0 on success or easy_error
+ */
+easy_error string_builder_appendc(string_builder *sb, const char ch);
+
+/**
+ * @brief Add content of view to end of sb
+ *
+ * @param sb Pointer to string_builder object
+ * @param view View of chars
+ * @return 0 on success or easy_error
+ */
+easy_error string_builder_append_view(string_builder *sb, string_view view);
+
+/**
+ * @brief Erases all appended data. First chunk is kept for reusing
+ *
+ * @param sb Pointer to string_builder object
+ * @return 0 on success or easy_error
+ */
+easy_error string_builder_clear(string_builder *sb);
+
+/**
+ * @brief Build string from all appended data using single allocation
+ * @note str should be freed after using
+ *
+ * @param sb Pointer to string_builder object
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Initialized string object or NULL
+ */
+string *string_builder_build(const string_builder *sb, easy_error *err);
+
+/**
+ * @brief Write all appended data into opened file without building string
+ *
+ * @param sb Pointer to string_builder object
+ * @param writer Pointer to opened file
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of bytes written successfully
+ */
+size_t string_builder_write(const string_builder *sb, fwriter *writer, easy_error *err);
+
+///@}
+
+#endif // STRBUILDER_H
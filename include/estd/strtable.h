@@ -0,0 +1,141 @@
+#ifndef STRTABLE_H
+#define STRTABLE_H
+
+#include <stddef.h>
+
+#include "estd/eerror.h"
+#include "estd/efile.h"
+#include "estd/estring.h"
+
+/// string_table is container for big collections of strings
+/// @note All strings are stored in one buffer one after another (each ends with '\0'), and
+/// offsets[i] is position of i-th string in buffer. So table of N strings uses only two allocations
+typedef struct string_table {
+  char *data;
+  size_t *offsets;         // count + 1 elements, offsets[count] == data_length
+  size_t count;            // Count of strings
+  size_t data_length;      // Size of used part of data
+  size_t data_capacity;    // Size of allocated data
+  size_t offsets_capacity; // Count of allocated offsets
+
+} string_table;
+
+#define string_table_count(table) (table)->count
+#define string_table_bytes(table) (table)->data_length
+
+/// @defgroup StringTable Functions relative to string_table type
+/// @{
+
+/**
+ * @brief Create empty string_table
+ * @note table should be freed after using
+ *
+ * @param count_hint Expected count of strings
+ * @param bytes_hint Expected total size of strings
+ * @return Initialized string_table object or NULL if allocation failed
+ */
+string_table *string_table_init(size_t count_hint, size_t bytes_hint);
+
+/// @brief Freed string_table object
+void string_table_free_(string_table *table);
+
+#define string_table_free(table)                                                                   \
+  string_table_free_(table);                                                                       \
+  (table) = NULL
+
+/**
+ * @brief Make room for count more strings with total size bytes
+ *
+ * @param table Pointer to string_table object
+ * @param count Count of strings
+ * @param bytes Total size of strings
+ * @return 0 on success or easy_error
+ */
+easy_error string_table_reserve(string_table *table, size_t count, size_t bytes);
+
+/**
+ * @brief Add length bytes of data to end of table as new string
+ * @note data doesn't have to be null-terminated
+ *
+ * @param table Pointer to string_table object
+ * @param data Pointer to chars
+ * @param length Count of chars
+ * @return 0 on success or easy_error
+ */
+easy_error string_table_push_n(string_table *table, const char *data, size_t length);
+
+/// @brief Add Cstring to end of table. See string_table_push_n
+easy_error string_table_push(string_table *table, const char *cstr);
+
+/// @brief Add content of view to end of table. See string_table_push_n
+easy_error string_table_push_view(string_table *table, string_view view);
+
+/**
+ * @brief Returns string by given index
+ * @note View is null-terminated. It's valid until table is changed
+ *
+ * @param table Pointer to string_table object
+ * @param index Index of string
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return View of string or empty view with data = NULL
+ */
+string_view string_table_get(const string_table *table, size_t index, easy_error *err);
+
+/**
+ * @brief Returns string by given index as Cstring
+ * @note Cstring is valid until table is changed
+ *
+ * @param table Pointer to string_table object
+ * @param index Index of string
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Cstring or NULL
+ */
+const char *string_table_cstr(const string_table *table, size_t index, easy_error *err);
+
+/**
+ * @brief Removes all strings. Allocated memory is kept
+ *
+ * @param table Pointer to string_table object
+ * @return 0 on success or easy_error
+ */
+easy_error string_table_clear(string_table *table);
+
+/**
+ * @brief Sorts strings in byte order. Buffer is rebuilt, so strings are contiguous after sorting
+ *
+ * @param table Pointer to string_table object
+ * @return 0 on success or easy_error
+ */
+easy_error string_table_sort(string_table *table);
+
+/**
+ * @brief Removes consecutive equal strings
+ * @note Call string_table_sort before to remove all duplicates
+ *
+ * @param table Pointer to string_table object
+ * @return 0 on success or easy_error
+ */
+easy_error string_table_dedup(string_table *table);
+
+/**
+ * @brief Write table into opened file in binary form
+ *
+ * @param table Pointer to string_table object
+ * @param writer Pointer to opened file
+ * @return 0 on success or easy_error
+ */
+easy_error string_table_write(const string_table *table, fwriter *writer);
+
+/**
+ * @brief Read table written by string_table_write from opened file
+ * @note table should be freed after using
+ *
+ * @param reader Pointer to opened file
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Initialized string_table object or NULL
+ */
+string_table *string_table_read(freader *reader, easy_error *err);
+
+///@}
+
+#endif // STRTABLE_H
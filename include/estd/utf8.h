@@ -0,0 +1,139 @@
+#ifndef UTF8_H
+#define UTF8_H
+
+#if __STDC_VERSION__ < 202311L // <C23
+#include <stdbool.h>
+#endif
+#include <stddef.h>
+#include <stdint.h>
+
+#include "estd/eerror.h"
+#include "estd/estring.h"
+
+/*
+Functions for working with UTF-8 text. Validation and counting use SSSE3/AVX2 on x86 if CPU
+supports them (checked at runtime), otherwise scalar code is used.
+Validation is based on algorithm from paper "Validating UTF-8 In Less Than One Instruction Per
+Byte" by John Keiser and Daniel Lemire
+*/
+
+/// @defgroup UTF8 Functions for UTF-8 text
+/// @{
+
+/**
+ * @brief Checks that data is valid UTF-8
+ * @note Overlong forms, surrogates and code points above U+10FFFF are invalid
+ *
+ * @param data Pointer to chars
+ * @param length Count of chars
+ * @return true if data is valid UTF-8
+ */
+bool utf8_validate(const char *data, size_t length);
+
+/**
+ * @brief Count code points in valid UTF-8 data
+ * @warning For invalid data result is unspecified
+ *
+ * @param data Pointer to chars
+ * @param length Count of chars
+ * @return Count of code points
+ */
+size_t utf8_count(const char *data, size_t length);
+
+/**
+ * @brief Decode code point starting at *pos and move *pos to the next one
+ * @note On invalid sequence *pos is moved by one byte, so iteration can continue
+ *
+ * @param data Pointer to chars
+ * @param length Count of chars
+ * @param pos Pointer to current position
+ * @param cp Decoded code point is stored here
+ * @return 0 on success, INVALID_INDEX at end of data, INVALID_ENCODING or other easy_error
+ */
+easy_error utf8_next(const char *data, size_t length, size_t *pos, uint32_t *cp);
+
+/**
+ * @brief Convert UTF-8 into UTF-16
+ * @note Pass out = NULL to get required size of out
+ *
+ * @param data Pointer to chars
+ * @param length Count of chars
+ * @param out Buffer for UTF-16 code units
+ * @param out_size Size of out
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of code units written into out (or required)
+ */
+size_t utf8_to_utf16(const char *data, size_t length, uint16_t *out, size_t out_size,
+                     easy_error *err);
+
+/**
+ * @brief Convert UTF-8 into UTF-32
+ * @note Pass out = NULL to get required size of out
+ *
+ * @param data Pointer to chars
+ * @param length Count of chars
+ * @param out Buffer for code points
+ * @param out_size Size of out
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of code points written into out (or required)
+ */
+size_t utf8_to_utf32(const char *data, size_t length, uint32_t *out, size_t out_size,
+                     easy_error *err);
+
+/**
+ * @brief Convert UTF-16 into UTF-8
+ * @note Pass out = NULL to get required size of out. Unpaired surrogates are invalid
+ *
+ * @param data Pointer to code units
+ * @param length Count of code units
+ * @param out Buffer for chars
+ * @param out_size Size of out
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of chars written into out (or required)
+ */
+size_t utf16_to_utf8(const uint16_t *data, size_t length, char *out, size_t out_size,
+                     easy_error *err);
+
+/**
+ * @brief Convert UTF-32 into UTF-8
+ * @note Pass out = NULL to get required size of out
+ *
+ * @param data Pointer to code points
+ * @param length Count of code points
+ * @param out Buffer for chars
+ * @param out_size Size of out
+ * @param err Pointer to easy_error object. Pass NULL if you sure in other parameters
+ * @return Count of chars written into out (or required)
+ */
+size_t utf32_to_utf8(const uint32_t *data, size_t length, char *out, size_t out_size,
+                     easy_error *err);
+
+/// @brief Checks that content of str is valid UTF-8. If str is bad, return false
+bool string_is_utf8(const string *str);
+
+/// @brief Count code points in str. If str is bad, return 0
+size_t string_utf8_count(const string *str);
+
+/**
+ * @brief Add UTF-16 text to end of str as UTF-8
+ *
+ * @param str Pointer to string object
+ * @param data Pointer to code units
+ * @param length Count of code units
+ * @return 0 on success or easy_error
+ */
+easy_error string_append_utf16(string *str, const uint16_t *data, size_t length);
+
+/**
+ * @brief Add UTF-32 text to end of str as UTF-8
+ *
+ * @param str Pointer to string object
+ * @param data Pointer to code points
+ * @param length Count of code points
+ * @return 0 on success or easy_error
+ */
+easy_error string_append_utf32(string *str, const uint32_t *data, size_t length);
+
+///@}
+
+#endif // UTF8_H
@@ -0,0 +1,684 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // fileno, pread, pwrite, syscall
+#endif
+
+#include "estd/aio.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#include <unistd.h>
+#define AIO_POSIX 1
+#endif
+
+#if defined(AIO_POSIX) && defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+// IORING_OP_READ/WRITE appeared in the same kernel (5.6) as IORING_FEAT_RW_CUR_POS
+#if defined(__NR_io_uring_setup) && defined(IORING_FEAT_RW_CUR_POS)
+#define AIO_URING 1
+#endif
+#endif
+#endif
+
+#define AIO_MAX_THREADS 16 // Threads of fallback backend, more don't help one device
+#define AIO_MAX_DEPTH 4096
+
+#ifdef AIO_POSIX
+
+typedef struct aio_buffer {
+  char *data;
+  size_t size;
+} aio_buffer;
+
+struct aio_context {
+  bool uring;
+  unsigned depth;
+  size_t pending; // Submitted and not collected requests
+
+  aio_buffer *buffers; // Registered buffers
+  size_t buffers_count;
+  bool fixed; // Buffers are registered in kernel
+
+  // Completed requests, which aren't passed to user yet
+  aio_request *done_head;
+  aio_request *done_tail;
+
+#ifdef AIO_URING
+  int ring_fd;
+  void *sq_ring;
+  void *cq_ring;
+  size_t sq_ring_size;
+  size_t cq_ring_size;
+  struct io_uring_sqe *sqes;
+  size_t sqes_size;
+  unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+  unsigned *cq_head, *cq_tail, *cq_mask;
+  struct io_uring_cqe *cqes;
+  size_t in_flight;     // Requests in rings
+  unsigned unsubmitted; // Entries of sq which aren't passed to io_uring_enter
+#endif
+
+  // Thread backend, done list is protected by lock too
+  pthread_t *threads;
+  size_t threads_count;
+  pthread_mutex_t lock;
+  pthread_cond_t work_cond;
+  pthread_cond_t done_cond;
+  aio_request *queue_head;
+  aio_request *queue_tail;
+  bool stop;
+};
+
+static inline easy_error op_error(const aio_request *req) {
+  return (req->op == AIO_READ) ? FILE_READ_FAILED : FILE_WRITE_FAILED;
+}
+
+static inline void done_push(aio_context *ctx, aio_request *req) {
+  req->next_ = NULL;
+  if (ctx->done_tail)
+    ctx->done_tail->next_ = req;
+  else
+    ctx->done_head = req;
+  ctx->done_tail = req;
+}
+
+/// Passes completed requests to user. Callback can submit new requests into same ctx
+static size_t deliver(aio_context *ctx, aio_request *list) {
+  size_t count = 0;
+  while (list) {
+    aio_request *req = list;
+    list = list->next_;
+    req->next_ = NULL;
+    req->done = true;
+    ctx->pending--;
+    count++;
+    if (req->callback)
+      req->callback(req, req->ctx);
+  }
+
+  return count;
+}
+
+/// Registered buffer must contain whole request (io_uring checks it too)
+static bool buffer_contains(const aio_context *ctx, const aio_request *req) {
+  if (req->buffer_index == AIO_NO_BUFFER)
+    return true;
+  if (req->buffer_index < 0 || (size_t)req->buffer_index >= ctx->buffers_count)
+    return false;
+
+  const aio_buffer *buf = &ctx->buffers[req->buffer_index];
+  const char *data = (const char *)req->buffer;
+  return data >= buf->data && data <= buf->data + buf->size &&
+         req->length <= (size_t)(buf->data + buf->size - data);
+}
+
+/* Thread backend */
+
+/// Runs request like pread/pwrite, but doesn't stop on short transfers
+static void perform(aio_request *req) {
+  char *data = (char *)req->buffer;
+  while (req->result < req->length) {
+    size_t left = req->length - req->result;
+    off_t offset = (off_t)(req->offset + req->result);
+    ssize_t n = (req->op == AIO_READ) ? pread(req->fd, data + req->result, left, offset)
+                                      : pwrite(req->fd, data + req->result, left, offset);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0 || (n == 0 && req->op == AIO_WRITE)) {
+      req->error = op_error(req);
+      return;
+    }
+    if (n == 0) // End of file
+      return;
+
+    req->result += (size_t)n;
+  }
+}
+
+static void *worker(void *arg) {
+  aio_context *ctx = (aio_context *)arg;
+
+  pthread_mutex_lock(&ctx->lock);
+  for (;;) {
+    while (!ctx->queue_head && !ctx->stop)
+      pthread_cond_wait(&ctx->work_cond, &ctx->lock);
+    if (!ctx->queue_head)
+      break;
+
+    aio_request *req = ctx->queue_head;
+    ctx->queue_head = req->next_;
+    if (!ctx->queue_head)
+      ctx->queue_tail = NULL;
+    pthread_mutex_unlock(&ctx->lock);
+
+    perform(req);
+
+    pthread_mutex_lock(&ctx->lock);
+    done_push(ctx, req);
+    pthread_cond_signal(&ctx->done_cond);
+  }
+  pthread_mutex_unlock(&ctx->lock);
+
+  return NULL;
+}
+
+static easy_error threads_init(aio_context *ctx) {
+  pthread_mutex_init(&ctx->lock, NULL);
+  pthread_cond_init(&ctx->work_cond, NULL);
+  pthread_cond_init(&ctx->done_cond, NULL);
+
+  size_t count = (ctx->depth < AIO_MAX_THREADS) ? ctx->depth : AIO_MAX_THREADS;
+  ctx->threads = (pthread_t *)malloc(count * sizeof(pthread_t));
+  CHECK_ALLOCATION(ctx->threads);
+
+  for (; ctx->threads_count < count; ctx->threads_count++) {
+    if (pthread_create(&ctx->threads[ctx->threads_count], NULL, worker, ctx) != 0)
+      return ALLOCATION_FAILED;
+  }
+
+  return OK;
+}
+
+static void threads_free(aio_context *ctx) {
+  pthread_mutex_lock(&ctx->lock);
+  ctx->stop = true;
+  pthread_cond_broadcast(&ctx->work_cond);
+  pthread_mutex_unlock(&ctx->lock);
+
+  for (size_t i = 0; i < ctx->threads_count; i++)
+    pthread_join(ctx->threads[i], NULL);
+
+  pthread_cond_destroy(&ctx->done_cond);
+  pthread_cond_destroy(&ctx->work_cond);
+  pthread_mutex_destroy(&ctx->lock);
+  free(ctx->threads);
+}
+
+static void threads_submit(aio_context *ctx, aio_request *requests, size_t count) {
+  pthread_mutex_lock(&ctx->lock);
+  for (size_t i = 0; i < count; i++) {
+    requests[i].next_ = NULL;
+    if (ctx->queue_tail)
+      ctx->queue_tail->next_ = &requests[i];
+    else
+      ctx->queue_head = &requests[i];
+    ctx->queue_tail = &requests[i];
+  }
+  pthread_cond_broadcast(&ctx->work_cond);
+  pthread_mutex_unlock(&ctx->lock);
+}
+
+/// Takes completed requests, waits for them if block is true
+static aio_request *threads_take(aio_context *ctx, bool block) {
+  pthread_mutex_lock(&ctx->lock);
+  while (block && !ctx->done_head)
+    pthread_cond_wait(&ctx->done_cond, &ctx->lock);
+
+  aio_request *list = ctx->done_head;
+  ctx->done_head = ctx->done_tail = NULL;
+  pthread_mutex_unlock(&ctx->lock);
+
+  return list;
+}
+
+/* io_uring backend */
+
+#ifdef AIO_URING
+
+// Ring indices are shared with kernel
+#define ring_load(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define ring_store(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+
+static void uring_free(aio_context *ctx) {
+  if (ctx->sqes)
+    munmap(ctx->sqes, ctx->sqes_size);
+  if (ctx->cq_ring && ctx->cq_ring != ctx->sq_ring)
+    munmap(ctx->cq_ring, ctx->cq_ring_size);
+  if (ctx->sq_ring)
+    munmap(ctx->sq_ring, ctx->sq_ring_size);
+  close(ctx->ring_fd);
+}
+
+static bool uring_init(aio_context *ctx) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+
+  // Depth of cq is twice bigger, so it can't overflow while at most depth requests are in flight
+  int fd = (int)syscall(__NR_io_uring_setup, ctx->depth, &params);
+  if (fd < 0)
+    return false;
+  ctx->ring_fd = fd;
+  if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+    close(fd);
+    return false;
+  }
+
+  ctx->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ctx->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single) {
+    if (ctx->cq_ring_size > ctx->sq_ring_size)
+      ctx->sq_ring_size = ctx->cq_ring_size;
+    ctx->cq_ring_size = ctx->sq_ring_size;
+  }
+
+  ctx->sq_ring = mmap(NULL, ctx->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      fd, IORING_OFF_SQ_RING);
+  if (ctx->sq_ring == MAP_FAILED) {
+    ctx->sq_ring = NULL;
+    uring_free(ctx);
+    return false;
+  }
+
+  if (single)
+    ctx->cq_ring = ctx->sq_ring;
+  else {
+    ctx->cq_ring = mmap(NULL, ctx->cq_ring_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (ctx->cq_ring == MAP_FAILED) {
+      ctx->cq_ring = NULL;
+      uring_free(ctx);
+      return false;
+    }
+  }
+
+  ctx->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  ctx->sqes = (struct io_uring_sqe *)mmap(NULL, ctx->sqes_size, PROT_READ | PROT_WRITE,
+                                          MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (ctx->sqes == MAP_FAILED) {
+    ctx->sqes = NULL;
+    uring_free(ctx);
+    return false;
+  }
+
+  char *sq = (char *)ctx->sq_ring;
+  char *cq = (char *)ctx->cq_ring;
+  ctx->sq_head = (unsigned *)(sq + params.sq_off.head);
+  ctx->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+  ctx->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+  ctx->sq_array = (unsigned *)(sq + params.sq_off.array);
+  ctx->cq_head = (unsigned *)(cq + params.cq_off.head);
+  ctx->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+  ctx->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+  ctx->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+  // Kernel can round depth up
+  ctx->depth = params.sq_entries;
+  return true;
+}
+
+/// Puts rest of request into sq. Caller keeps in_flight not bigger than depth, so sq has space
+static void uring_push(aio_context *ctx, aio_request *req) {
+  unsigned tail = *ctx->sq_tail;
+  unsigned index = tail & *ctx->sq_mask;
+  struct io_uring_sqe *sqe = &ctx->sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+
+  bool fixed = ctx->fixed && req->buffer_index != AIO_NO_BUFFER;
+  if (req->op == AIO_READ)
+    sqe->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+  else
+    sqe->opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+  sqe->fd = req->fd;
+  sqe->off = req->offset + req->result;
+  sqe->addr = (uint64_t)(uintptr_t)((char *)req->buffer + req->result);
+  sqe->len = (uint32_t)(req->length - req->result);
+  sqe->buf_index = fixed ? (uint16_t)req->buffer_index : 0;
+  sqe->user_data = (uint64_t)(uintptr_t)req;
+
+  ctx->sq_array[index] = index;
+  ring_store(ctx->sq_tail, tail + 1);
+  ctx->in_flight++;
+  ctx->unsubmitted++;
+}
+
+/// Passes new entries to kernel and waits for min_complete completions
+static easy_error uring_enter(aio_context *ctx, unsigned min_complete) {
+  while (ctx->unsubmitted > 0 || min_complete > 0) {
+    unsigned flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+    long n = syscall(__NR_io_uring_enter, ctx->ring_fd, ctx->unsubmitted, min_complete, flags,
+                     NULL, 0);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return SYSTEM_CALL_FAILED; // Ring failed, not one read or write
+    }
+
+    ctx->unsubmitted -= (unsigned)n;
+    if (ctx->unsubmitted == 0)
+      break;
+  }
+
+  return OK;
+}
+
+/// Moves completions from cq into done list. Short transfers are submitted again
+static void uring_reap(aio_context *ctx) {
+  unsigned head = *ctx->cq_head;
+  unsigned tail = ring_load(ctx->cq_tail);
+
+  for (; head != tail; head++) {
+    struct io_uring_cqe *cqe = &ctx->cqes[head & *ctx->cq_mask];
+    aio_request *req = (aio_request *)(uintptr_t)cqe->user_data;
+    int res = cqe->res;
+    ctx->in_flight--;
+
+    if (res == -EAGAIN || res == -EINTR) {
+      uring_push(ctx, req);
+      continue;
+    }
+
+    if (res < 0 || (res == 0 && req->op == AIO_WRITE))
+      req->error = op_error(req);
+    else if (res > 0) {
+      req->result += (size_t)res;
+      if (req->result < req->length) {
+        uring_push(ctx, req);
+        continue;
+      }
+    }
+    done_push(ctx, req);
+  }
+
+  ring_store(ctx->cq_head, head);
+}
+
+#endif // AIO_URING
+
+/// Takes completed requests, waits for at least one if block is true
+static aio_request *take_completed(aio_context *ctx, bool block, easy_error *err) {
+#ifdef AIO_URING
+  if (ctx->uring) {
+    easy_error code = uring_enter(ctx, (block && !ctx->done_head) ? 1 : 0);
+    if (code != OK) {
+      SET_CODE_ERROR(err, code);
+      return NULL;
+    }
+    uring_reap(ctx);
+
+    aio_request *list = ctx->done_head;
+    ctx->done_head = ctx->done_tail = NULL;
+    return list;
+  }
+#endif
+  (void)err;
+  return threads_take(ctx, block);
+}
+
+aio_context *aio_init(unsigned queue_depth, int flags, easy_error *err) {
+  if (queue_depth == 0 || queue_depth > AIO_MAX_DEPTH) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return NULL;
+  }
+
+  aio_context *ctx = (aio_context *)calloc(1, sizeof(aio_context));
+  if (!ctx) {
+    SET_CODE_ERROR(err, ALLOCATION_FAILED);
+    return NULL;
+  }
+  ctx->depth = queue_depth;
+
+#ifdef AIO_URING
+  if (!(flags & AIO_FORCE_THREADS) && uring_init(ctx)) {
+    ctx->uring = true;
+    return ctx;
+  }
+#else
+  (void)flags;
+#endif
+
+  easy_error code = threads_init(ctx);
+  if (code != OK) {
+    threads_free(ctx);
+    free(ctx);
+    SET_CODE_ERROR(err, code);
+    return NULL;
+  }
+
+  return ctx;
+}
+
+void aio_free_(aio_context *ctx) {
+  if (!ctx)
+    return;
+
+#ifdef AIO_URING
+  if (ctx->uring) {
+    while (ctx->in_flight > 0) {
+      if (uring_enter(ctx, 1) != OK)
+        break;
+      uring_reap(ctx);
+    }
+    uring_free(ctx);
+  } else
+#endif
+    threads_free(ctx);
+
+  free(ctx->buffers);
+  free(ctx);
+}
+
+bool aio_uses_io_uring(const aio_context *ctx) { return ctx && ctx->uring; }
+
+size_t aio_pending(const aio_context *ctx) { return ctx ? ctx->pending : 0; }
+
+easy_error aio_register_buffers(aio_context *ctx, void *const *buffers, const size_t *sizes,
+                                size_t count) {
+  CHECK_NULL_PTR(ctx);
+  CHECK_NULL_PTR(buffers);
+  CHECK_NULL_PTR(sizes);
+  if (count == 0 || ctx->buffers || count > UINT16_MAX)
+    return INVALID_ARGUMENT;
+
+  ctx->buffers = (aio_buffer *)malloc(count * sizeof(aio_buffer));
+  CHECK_ALLOCATION(ctx->buffers);
+  for (size_t i = 0; i < count; i++) {
+    if (!buffers[i]) {
+      free(ctx->buffers);
+      ctx->buffers = NULL;
+      return NULL_POINTER;
+    }
+    ctx->buffers[i].data = (char *)buffers[i];
+    ctx->buffers[i].size = sizes[i];
+  }
+  ctx->buffers_count = count;
+
+#ifdef AIO_URING
+  if (ctx->uring) {
+    struct iovec *iov = (struct iovec *)malloc(count * sizeof(struct iovec));
+    if (iov) {
+      for (size_t i = 0; i < count; i++) {
+        iov[i].iov_base = buffers[i];
+        iov[i].iov_len = sizes[i];
+      }
+      // Registration can fail because of RLIMIT_MEMLOCK, then buffers are used as usual ones
+      ctx->fixed = syscall(__NR_io_uring_register, ctx->ring_fd, IORING_REGISTER_BUFFERS, iov,
+                           (unsigned)count) == 0;
+      free(iov);
+    }
+  }
+#endif
+
+  return OK;
+}
+
+static void prep(aio_request *req, AIO_OP op, FILE *fp, void *buffer, size_t length,
+                 uint64_t offset) {
+  memset(req, 0, sizeof(*req));
+  req->op = op;
+  req->fd = fp ? fileno(fp) : -1;
+  req->buffer = buffer;
+  req->length = length;
+  req->offset = offset;
+  req->buffer_index = AIO_NO_BUFFER;
+}
+
+void aio_prep_read(aio_request *req, freader *reader, void *buffer, size_t length,
+                   uint64_t offset) {
+  if (req)
+    prep(req, AIO_READ, reader ? reader->fp : NULL, buffer, length, offset);
+}
+
+void aio_prep_write(aio_request *req, fwriter *writer, const void *data, size_t length,
+                    uint64_t offset) {
+  if (req)
+    prep(req, AIO_WRITE, writer ? writer->fp : NULL, (void *)data, length, offset);
+}
+
+easy_error aio_submit(aio_context *ctx, aio_request *requests, size_t count) {
+  CHECK_NULL_PTR(ctx);
+  if (count == 0)
+    return OK;
+  CHECK_NULL_PTR(requests);
+
+  // Nothing is submitted if one of requests is invalid
+  for (size_t i = 0; i < count; i++) {
+    aio_request *req = &requests[i];
+    if (req->fd < 0 || (req->op != AIO_READ && req->op != AIO_WRITE))
+      return INVALID_ARGUMENT;
+    if (!req->buffer && req->length > 0)
+      return NULL_POINTER;
+    if (req->length > INT32_MAX || !buffer_contains(ctx, req))
+      return INVALID_ARGUMENT;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    requests[i].result = 0;
+    requests[i].error = OK;
+    requests[i].done = false;
+  }
+
+#ifdef AIO_URING
+  if (ctx->uring) {
+    // Request is pending once it is in ring, entries not passed to kernel yet are passed later
+    for (size_t i = 0; i < count; i++) {
+      while (ctx->in_flight >= ctx->depth) {
+        easy_error code = uring_enter(ctx, 1);
+        if (code != OK)
+          return code;
+        uring_reap(ctx);
+      }
+      uring_push(ctx, &requests[i]);
+      ctx->pending++;
+    }
+
+    return uring_enter(ctx, 0);
+  }
+#endif
+
+  ctx->pending += count;
+  threads_submit(ctx, requests, count);
+  return OK;
+}
+
+size_t aio_poll(aio_context *ctx) {
+  if (!ctx || ctx->pending == 0)
+    return 0;
+
+  return deliver(ctx, take_completed(ctx, false, NULL));
+}
+
+size_t aio_wait(aio_context *ctx, size_t min_count, easy_error *err) {
+  if (!ctx) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  if (min_count > ctx->pending)
+    min_count = ctx->pending;
+
+  size_t collected = 0;
+  do {
+    easy_error code = OK;
+    aio_request *list = take_completed(ctx, collected < min_count, &code);
+    if (code != OK) {
+      SET_CODE_ERROR(err, code);
+      break;
+    }
+    collected += deliver(ctx, list);
+  } while (collected < min_count);
+
+  return collected;
+}
+
+#else // !AIO_POSIX
+
+// Without POSIX threads and positioned I/O asynchronous operations aren't supported
+
+aio_context *aio_init(unsigned queue_depth, int flags, easy_error *err) {
+  (void)queue_depth;
+  (void)flags;
+  SET_CODE_ERROR(err, INVALID_ARGUMENT);
+  return NULL;
+}
+
+void aio_free_(aio_context *ctx) { (void)ctx; }
+
+bool aio_uses_io_uring(const aio_context *ctx) {
+  (void)ctx;
+  return false;
+}
+
+size_t aio_pending(const aio_context *ctx) {
+  (void)ctx;
+  return 0;
+}
+
+easy_error aio_register_buffers(aio_context *ctx, void *const *buffers, const size_t *sizes,
+                                size_t count) {
+  (void)buffers;
+  (void)sizes;
+  (void)count;
+  CHECK_NULL_PTR(ctx);
+  return INVALID_ARGUMENT;
+}
+
+void aio_prep_read(aio_request *req, freader *reader, void *buffer, size_t length,
+                   uint64_t offset) {
+  (void)reader;
+  if (!req)
+    return;
+  memset(req, 0, sizeof(*req));
+  req->op = AIO_READ;
+  req->fd = -1;
+  req->buffer = buffer;
+  req->length = length;
+  req->offset = offset;
+  req->buffer_index = AIO_NO_BUFFER;
+}
+
+void aio_prep_write(aio_request *req, fwriter *writer, const void *data, size_t length,
+                    uint64_t offset) {
+  (void)writer;
+  if (!req)
+    return;
+  aio_prep_read(req, NULL, (void *)data, length, offset);
+  req->op = AIO_WRITE;
+}
+
+easy_error aio_submit(aio_context *ctx, aio_request *requests, size_t count) {
+  (void)requests;
+  (void)count;
+  CHECK_NULL_PTR(ctx);
+  return INVALID_ARGUMENT;
+}
+
+size_t aio_poll(aio_context *ctx) {
+  (void)ctx;
+  return 0;
+}
+
+size_t aio_wait(aio_context *ctx, size_t min_count, easy_error *err) {
+  (void)min_count;
+  SET_CODE_ERROR(err, ctx ? INVALID_ARGUMENT : NULL_POINTER);
+  return 0;
+}
+
+#endif // AIO_POSIX
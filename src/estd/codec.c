@@ -0,0 +1,912 @@
+#include <string.h>
+
+#include "estd/codec.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define CODEC_X86_DISPATCH 1
+#endif
+
+static const char hex_chars[] = "0123456789abcdef";
+
+static const char base64_standard_chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const char base64_url_chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+static inline const char *base64_chars(BASE64_ALPHABET alphabet) {
+  return (alphabet == BASE64_URL) ? base64_url_chars : base64_standard_chars;
+}
+
+/// Returns value of hex digit or -1
+static inline int hex_value(uint8_t c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+
+  c |= 0x20; // Lower case
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+
+  return -1;
+}
+
+/// Returns value of base64 char or -1
+static inline int base64_value(uint8_t c, const char *chars) {
+  if (c >= 'A' && c <= 'Z')
+    return c - 'A';
+  if (c >= 'a' && c <= 'z')
+    return c - 'a' + 26;
+  if (c >= '0' && c <= '9')
+    return c - '0' + 52;
+  if (c == (uint8_t)chars[62])
+    return 62;
+  if (c == (uint8_t)chars[63])
+    return 63;
+
+  return -1;
+}
+
+#ifdef CODEC_X86_DISPATCH
+
+/*
+SIMD kernels process whole blocks and return count of processed input. Decoders stop before block
+with invalid char, so scalar code after them finds exact position of error.
+Base64 kernels are based on works of Wojciech Mula and Daniel Lemire ("Faster Base64 Encoding and
+Decoding Using AVX2 Instructions")
+*/
+
+__attribute__((target("ssse3"))) static size_t hex_encode_ssse3(const uint8_t *in, size_t length,
+                                                                 char *out) {
+  const __m128i lut = _mm_loadu_si128((const __m128i *)hex_chars);
+  const __m128i mask = _mm_set1_epi8(0x0F);
+
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    __m128i input = _mm_loadu_si128((const __m128i *)(in + i));
+    __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(input, 4), mask));
+    __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(input, mask));
+    _mm_storeu_si128((__m128i *)(out + i * 2), _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128((__m128i *)(out + i * 2 + 16), _mm_unpackhi_epi8(hi, lo));
+  }
+
+  return i;
+}
+
+__attribute__((target("avx2"))) static size_t hex_encode_avx2(const uint8_t *in, size_t length,
+                                                              char *out) {
+  const __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)hex_chars));
+  const __m256i mask = _mm256_set1_epi8(0x0F);
+
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i input = _mm256_loadu_si256((const __m256i *)(in + i));
+    __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(input, 4), mask));
+    __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(input, mask));
+    // Unpack works inside 128-bit lanes, so lanes are reordered after it
+    __m256i a = _mm256_unpacklo_epi8(hi, lo), b = _mm256_unpackhi_epi8(hi, lo);
+    _mm256_storeu_si256((__m256i *)(out + i * 2), _mm256_permute2x128_si256(a, b, 0x20));
+    _mm256_storeu_si256((__m256i *)(out + i * 2 + 32), _mm256_permute2x128_si256(a, b, 0x31));
+  }
+
+  return i;
+}
+
+/// Convert 16 hex digits into their values. valid gets 0xFF for each valid digit
+__attribute__((target("ssse3"))) static inline __m128i hex_values_ssse3(__m128i input,
+                                                                        __m128i *valid) {
+  __m128i digit = _mm_sub_epi8(input, _mm_set1_epi8('0'));
+  __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+  __m128i letter = _mm_sub_epi8(_mm_or_si128(input, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+  __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+
+  *valid = _mm_or_si128(is_digit, is_letter);
+  return _mm_or_si128(_mm_and_si128(is_digit, digit),
+                      _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+
+__attribute__((target("ssse3"))) static size_t hex_decode_ssse3(const uint8_t *in, size_t length,
+                                                                 uint8_t *out) {
+  const __m128i weights = _mm_set1_epi16(0x0110); // High digit * 16 + low digit
+
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m128i valid0, valid1;
+    __m128i v0 = hex_values_ssse3(_mm_loadu_si128((const __m128i *)(in + i)), &valid0);
+    __m128i v1 = hex_values_ssse3(_mm_loadu_si128((const __m128i *)(in + i + 16)), &valid1);
+    if (_mm_movemask_epi8(_mm_and_si128(valid0, valid1)) != 0xFFFF)
+      break;
+
+    __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(v0, weights),
+                                     _mm_maddubs_epi16(v1, weights));
+    _mm_storeu_si128((__m128i *)(out + i / 2), bytes);
+  }
+
+  return i;
+}
+
+__attribute__((target("avx2"))) static inline __m256i hex_values_avx2(__m256i input,
+                                                                      __m256i *valid) {
+  __m256i digit = _mm256_sub_epi8(input, _mm256_set1_epi8('0'));
+  __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+  __m256i letter =
+      _mm256_sub_epi8(_mm256_or_si256(input, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+  __m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+
+  *valid = _mm256_or_si256(is_digit, is_letter);
+  __m256i letter_value = _mm256_add_epi8(letter, _mm256_set1_epi8(10));
+  return _mm256_or_si256(_mm256_and_si256(is_digit, digit),
+                         _mm256_and_si256(is_letter, letter_value));
+}
+
+__attribute__((target("avx2"))) static size_t hex_decode_avx2(const uint8_t *in, size_t length,
+                                                              uint8_t *out) {
+  const __m256i weights = _mm256_set1_epi16(0x0110);
+
+  size_t i = 0;
+  for (; i + 64 <= length; i += 64) {
+    __m256i valid0, valid1;
+    __m256i v0 = hex_values_avx2(_mm256_loadu_si256((const __m256i *)(in + i)), &valid0);
+    __m256i v1 = hex_values_avx2(_mm256_loadu_si256((const __m256i *)(in + i + 32)), &valid1);
+    if (_mm256_movemask_epi8(_mm256_and_si256(valid0, valid1)) != -1)
+      break;
+
+    __m256i bytes = _mm256_packus_epi16(_mm256_maddubs_epi16(v0, weights),
+                                        _mm256_maddubs_epi16(v1, weights));
+    bytes = _mm256_permute4x64_epi64(bytes, _MM_SHUFFLE(3, 1, 2, 0));
+    _mm256_storeu_si256((__m256i *)(out + i / 2), bytes);
+  }
+
+  return i;
+}
+
+/// Split 12 bytes (in 16-byte register) into 16 indexes of 6 bits
+__attribute__((target("ssse3"))) static inline __m128i base64_split_ssse3(__m128i input) {
+  input = _mm_shuffle_epi8(input, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+  __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(input, _mm_set1_epi32(0x0FC0FC00)),
+                               _mm_set1_epi32(0x04000040));
+  __m128i t1 = _mm_mullo_epi16(_mm_and_si128(input, _mm_set1_epi32(0x003F03F0)),
+                               _mm_set1_epi32(0x01000010));
+  return _mm_or_si128(t0, t1);
+}
+
+/// Convert 16 indexes into chars: each range of alphabet gets own offset
+__attribute__((target("ssse3"))) static inline __m128i base64_chars_ssse3(__m128i indexes,
+                                                                          __m128i offsets) {
+  __m128i range = _mm_subs_epu8(indexes, _mm_set1_epi8(51));
+  __m128i is_upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indexes);
+  range = _mm_or_si128(range, _mm_and_si128(is_upper, _mm_set1_epi8(13)));
+  return _mm_add_epi8(indexes, _mm_shuffle_epi8(offsets, range));
+}
+
+__attribute__((target("ssse3"))) static inline __m128i base64_offsets_ssse3(const char *chars) {
+  const char d = '0' - 52;
+  return _mm_setr_epi8('a' - 26, d, d, d, d, d, d, d, d, d, d, (char)(chars[62] - 62),
+                       (char)(chars[63] - 63), 'A', 0, 0);
+}
+
+__attribute__((target("ssse3"))) static size_t base64_encode_ssse3(const uint8_t *in, size_t length,
+                                                                    char *out, const char *chars) {
+  const __m128i offsets = base64_offsets_ssse3(chars);
+
+  size_t i = 0, o = 0;
+  for (; i + 16 <= length; i += 12, o += 16) { // 16 bytes are loaded, but only 12 are used
+    __m128i indexes = base64_split_ssse3(_mm_loadu_si128((const __m128i *)(in + i)));
+    _mm_storeu_si128((__m128i *)(out + o), base64_chars_ssse3(indexes, offsets));
+  }
+
+  return i;
+}
+
+__attribute__((target("avx2"))) static size_t base64_encode_avx2(const uint8_t *in, size_t length,
+                                                                 char *out, const char *chars) {
+  const char d = '0' - 52;
+  const __m256i offsets =
+      _mm256_setr_epi8('a' - 26, d, d, d, d, d, d, d, d, d, d, (char)(chars[62] - 62),
+                       (char)(chars[63] - 63), 'A', 0, 0, 'a' - 26, d, d, d, d, d, d, d, d, d, d,
+                       (char)(chars[62] - 62), (char)(chars[63] - 63), 'A', 0, 0);
+  const __m256i shuffle =
+      _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2, 1, 4, 3, 5, 4, 7,
+                       6, 8, 7, 10, 9, 11, 10);
+
+  size_t i = 0, o = 0;
+  for (; i + 28 <= length; i += 24, o += 32) { // Each lane gets own 12 bytes
+    __m256i input = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(in + i))),
+        _mm_loadu_si128((const __m128i *)(in + i + 12)), 1);
+    input = _mm256_shuffle_epi8(input, shuffle);
+    __m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(input, _mm256_set1_epi32(0x0FC0FC00)),
+                                    _mm256_set1_epi32(0x04000040));
+    __m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(input, _mm256_set1_epi32(0x003F03F0)),
+                                    _mm256_set1_epi32(0x01000010));
+    __m256i indexes = _mm256_or_si256(t0, t1);
+
+    __m256i range = _mm256_subs_epu8(indexes, _mm256_set1_epi8(51));
+    __m256i is_upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indexes);
+    range = _mm256_or_si256(range, _mm256_and_si256(is_upper, _mm256_set1_epi8(13)));
+    __m256i result = _mm256_add_epi8(indexes, _mm256_shuffle_epi8(offsets, range));
+    _mm256_storeu_si256((__m256i *)(out + o), result);
+  }
+
+  return i;
+}
+
+/// Range of chars [first, last], which is mapped by adding offset
+#define BASE64_IN_RANGE_SSE(input, first, last)                                                    \
+  _mm_and_si128(_mm_cmpgt_epi8(input, _mm_set1_epi8((first) - 1)),                                 \
+                _mm_cmpgt_epi8(_mm_set1_epi8((last) + 1), input))
+
+/// Convert 16 chars into values of 6 bits. valid gets 0xFF for each valid char
+__attribute__((target("ssse3"))) static inline __m128i base64_values_ssse3(__m128i input,
+                                                                           const char *chars,
+                                                                           __m128i *valid) {
+  // Chars >= 0x80 are negative, so they aren't in any range
+  __m128i upper = BASE64_IN_RANGE_SSE(input, 'A', 'Z');
+  __m128i lower = BASE64_IN_RANGE_SSE(input, 'a', 'z');
+  __m128i digit = BASE64_IN_RANGE_SSE(input, '0', '9');
+  __m128i c62 = _mm_cmpeq_epi8(input, _mm_set1_epi8(chars[62]));
+  __m128i c63 = _mm_cmpeq_epi8(input, _mm_set1_epi8(chars[63]));
+
+  *valid = _mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, c62)), c63);
+
+  __m128i offset = _mm_or_si128(
+      _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-'A')),
+                   _mm_and_si128(lower, _mm_set1_epi8(26 - 'a'))),
+      _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(52 - '0')),
+                   _mm_or_si128(_mm_and_si128(c62, _mm_set1_epi8((char)(62 - chars[62]))),
+                                _mm_and_si128(c63, _mm_set1_epi8((char)(63 - chars[63]))))));
+  return _mm_add_epi8(input, offset);
+}
+
+/// Join 16 values of 6 bits into 12 bytes (at start of register)
+__attribute__((target("ssse3"))) static inline __m128i base64_join_ssse3(__m128i values) {
+  __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+  __m128i words = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+  return _mm_shuffle_epi8(words,
+                          _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+}
+
+__attribute__((target("ssse3"))) static size_t base64_decode_ssse3(const uint8_t *in, size_t length,
+                                                                    uint8_t *out, size_t out_size,
+                                                                    const char *chars) {
+  size_t i = 0, o = 0;
+  for (; i + 16 <= length && o + 16 <= out_size; i += 16, o += 12) {
+    __m128i valid;
+    __m128i values = base64_values_ssse3(_mm_loadu_si128((const __m128i *)(in + i)), chars, &valid);
+    if (_mm_movemask_epi8(valid) != 0xFFFF)
+      break;
+
+    _mm_storeu_si128((__m128i *)(out + o), base64_join_ssse3(values));
+  }
+
+  return i;
+}
+
+#define BASE64_IN_RANGE_AVX(input, first, last)                                                    \
+  _mm256_and_si256(_mm256_cmpgt_epi8(input, _mm256_set1_epi8((first) - 1)),                        \
+                   _mm256_cmpgt_epi8(_mm256_set1_epi8((last) + 1), input))
+
+__attribute__((target("avx2"))) static size_t base64_decode_avx2(const uint8_t *in, size_t length,
+                                                                 uint8_t *out, size_t out_size,
+                                                                 const char *chars) {
+  const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                           2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+  const __m256i pack = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+
+  size_t i = 0, o = 0;
+  for (; i + 32 <= length && o + 32 <= out_size; i += 32, o += 24) {
+    __m256i input = _mm256_loadu_si256((const __m256i *)(in + i));
+    __m256i upper = BASE64_IN_RANGE_AVX(input, 'A', 'Z');
+    __m256i lower = BASE64_IN_RANGE_AVX(input, 'a', 'z');
+    __m256i digit = BASE64_IN_RANGE_AVX(input, '0', '9');
+    __m256i c62 = _mm256_cmpeq_epi8(input, _mm256_set1_epi8(chars[62]));
+    __m256i c63 = _mm256_cmpeq_epi8(input, _mm256_set1_epi8(chars[63]));
+
+    __m256i valid = _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(upper, lower), digit),
+                                    _mm256_or_si256(c62, c63));
+    if (_mm256_movemask_epi8(valid) != -1)
+      break;
+
+    __m256i offset = _mm256_or_si256(
+        _mm256_or_si256(_mm256_and_si256(upper, _mm256_set1_epi8(-'A')),
+                        _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a'))),
+        _mm256_or_si256(
+            _mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')),
+            _mm256_or_si256(_mm256_and_si256(c62, _mm256_set1_epi8((char)(62 - chars[62]))),
+                            _mm256_and_si256(c63, _mm256_set1_epi8((char)(63 - chars[63]))))));
+    __m256i values = _mm256_add_epi8(input, offset);
+
+    __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+    __m256i words = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+    __m256i bytes = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(words, shuffle), pack);
+    _mm256_storeu_si256((__m256i *)(out + o), bytes); // Last 8 bytes are rewritten later
+  }
+
+  return i;
+}
+
+#endif
+
+static void hex_encode_block(const uint8_t *in, size_t length, char *out) {
+  size_t i = 0;
+#ifdef CODEC_X86_DISPATCH
+  if (length >= 32 && __builtin_cpu_supports("avx2"))
+    i = hex_encode_avx2(in, length, out);
+  else if (length >= 16 && __builtin_cpu_supports("ssse3"))
+    i = hex_encode_ssse3(in, length, out);
+#endif
+
+  for (; i < length; i++) {
+    out[i * 2] = hex_chars[in[i] >> 4];
+    out[i * 2 + 1] = hex_chars[in[i] & 15];
+  }
+}
+
+/// Decode length (even) chars. Returns count of decoded chars, it's less than length on error
+static size_t hex_decode_block(const uint8_t *in, size_t length, uint8_t *out) {
+  size_t i = 0;
+#ifdef CODEC_X86_DISPATCH
+  if (length >= 64 && __builtin_cpu_supports("avx2"))
+    i = hex_decode_avx2(in, length, out);
+  else if (length >= 32 && __builtin_cpu_supports("ssse3"))
+    i = hex_decode_ssse3(in, length, out);
+#endif
+
+  for (; i < length; i += 2) {
+    int hi = hex_value(in[i]), lo = hex_value(in[i + 1]);
+    if (hi < 0 || lo < 0)
+      break;
+    out[i / 2] = (uint8_t)(hi << 4 | lo);
+  }
+
+  return i;
+}
+
+/// Encode length (multiple of 3) bytes
+static void base64_encode_block(const uint8_t *in, size_t length, char *out, const char *chars) {
+  size_t i = 0;
+#ifdef CODEC_X86_DISPATCH
+  if (length >= 28 && __builtin_cpu_supports("avx2"))
+    i = base64_encode_avx2(in, length, out, chars);
+  if (length - i >= 16 && __builtin_cpu_supports("ssse3"))
+    i += base64_encode_ssse3(in + i, length - i, out + i / 3 * 4, chars);
+#endif
+
+  for (; i < length; i += 3) {
+    uint32_t v = (uint32_t)in[i] << 16 | (uint32_t)in[i + 1] << 8 | in[i + 2];
+    char *o = out + i / 3 * 4;
+    o[0] = chars[v >> 18];
+    o[1] = chars[(v >> 12) & 63];
+    o[2] = chars[(v >> 6) & 63];
+    o[3] = chars[v & 63];
+  }
+}
+
+/// Encode last 1 or 2 bytes. Returns count of written chars
+static size_t base64_encode_tail(const uint8_t *in, size_t length, char *out, const char *chars,
+                                 bool padding) {
+  uint32_t v = (uint32_t)in[0] << 16 | ((length > 1) ? (uint32_t)in[1] << 8 : 0);
+  out[0] = chars[v >> 18];
+  out[1] = chars[(v >> 12) & 63];
+  if (length > 1)
+    out[2] = chars[(v >> 6) & 63];
+
+  size_t n = length + 1;
+  if (padding)
+    for (; n < 4; n++)
+      out[n] = '=';
+
+  return n;
+}
+
+/// Decode group of 4 chars without padding
+static inline bool base64_decode_quad(const uint8_t *in, uint8_t *out, const char *chars) {
+  int a = base64_value(in[0], chars), b = base64_value(in[1], chars);
+  int c = base64_value(in[2], chars), d = base64_value(in[3], chars);
+  if ((a | b | c | d) < 0)
+    return false;
+
+  uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6 | (uint32_t)d;
+  out[0] = (uint8_t)(v >> 16);
+  out[1] = (uint8_t)(v >> 8);
+  out[2] = (uint8_t)v;
+  return true;
+}
+
+/// Decode length (multiple of 4) chars. Returns count of decoded chars, it's less than length on
+/// error. out_size lets SIMD code write behind decoded bytes
+static size_t base64_decode_block(const uint8_t *in, size_t length, uint8_t *out, size_t out_size,
+                                  const char *chars) {
+  size_t i = 0;
+#ifdef CODEC_X86_DISPATCH
+  if (length >= 32 && __builtin_cpu_supports("avx2"))
+    i = base64_decode_avx2(in, length, out, out_size, chars);
+  if (length - i >= 16 && __builtin_cpu_supports("ssse3"))
+    i += base64_decode_ssse3(in + i, length - i, out + i / 4 * 3, out_size - i / 4 * 3, chars);
+#else
+  (void)out_size;
+#endif
+
+  for (; i < length; i += 4)
+    if (!base64_decode_quad(in + i, out + i / 4 * 3, chars))
+      break;
+
+  return i;
+}
+
+/// Decode last group of 2 or 3 chars (without padding)
+static bool base64_decode_tail(const uint8_t *in, size_t length, uint8_t *out, const char *chars) {
+  int a = base64_value(in[0], chars), b = base64_value(in[1], chars);
+  int c = (length > 2) ? base64_value(in[2], chars) : 0;
+  if ((a | b | c) < 0)
+    return false;
+
+  uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6;
+  out[0] = (uint8_t)(v >> 16);
+  if (length > 2)
+    out[1] = (uint8_t)(v >> 8);
+
+  return true;
+}
+
+/// Removes padding of complete group. Returns count of chars without padding
+static size_t base64_strip_padding(const char *data, size_t length) {
+  if (length == 0 || length % 4 != 0)
+    return length;
+
+  if (data[length - 1] == '=')
+    length--;
+  if (data[length - 1] == '=')
+    length--;
+
+  return length;
+}
+
+size_t hex_encode(const void *data, size_t length, char *out, size_t out_size, easy_error *err) {
+  if (!data && length > 0) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  if (!out) {
+    SET_CODE_ERROR(err, OK);
+    return HEX_ENCODED_SIZE(length);
+  }
+
+  if (out_size / 2 < length) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return 0;
+  }
+
+  if (length > 0)
+    hex_encode_block((const uint8_t *)data, length, out);
+
+  SET_CODE_ERROR(err, OK);
+  return HEX_ENCODED_SIZE(length);
+}
+
+size_t hex_decode(const char *data, size_t length, void *out, size_t out_size, easy_error *err) {
+  if (!data && length > 0) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  if (length % 2 != 0) {
+    SET_CODE_ERROR(err, INVALID_ENCODING);
+    return 0;
+  }
+
+  if (!out) {
+    SET_CODE_ERROR(err, OK);
+    return HEX_DECODED_SIZE(length);
+  }
+
+  if (out_size < HEX_DECODED_SIZE(length)) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return 0;
+  }
+
+  size_t done = (length > 0) ? hex_decode_block((const uint8_t *)data, length, out) : 0;
+  SET_CODE_ERROR(err, (done == length) ? OK : INVALID_ENCODING);
+  return HEX_DECODED_SIZE(done);
+}
+
+size_t base64_encode(const void *data, size_t length, char *out, size_t out_size,
+                     BASE64_ALPHABET alphabet, easy_error *err) {
+  if (!data && length > 0) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  bool padding = alphabet != BASE64_URL;
+  size_t needed = (padding || length % 3 == 0) ? BASE64_ENCODED_SIZE(length)
+                                                : length / 3 * 4 + length % 3 + 1;
+  if (!out) {
+    SET_CODE_ERROR(err, OK);
+    return needed;
+  }
+
+  if (out_size < needed || length / 3 > SIZE_MAX / 4) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return 0;
+  }
+
+  const char *chars = base64_chars(alphabet);
+  const uint8_t *in = (const uint8_t *)data;
+  size_t full = length / 3 * 3;
+  base64_encode_block(in, full, out, chars);
+  if (full < length)
+    base64_encode_tail(in + full, length - full, out + full / 3 * 4, chars, padding);
+
+  SET_CODE_ERROR(err, OK);
+  return needed;
+}
+
+size_t base64_decode(const char *data, size_t length, void *out, size_t out_size,
+                     BASE64_ALPHABET alphabet, easy_error *err) {
+  if (!data && length > 0) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  size_t body = base64_strip_padding(data, length);
+  if (body % 4 == 1) {
+    SET_CODE_ERROR(err, INVALID_ENCODING);
+    return 0;
+  }
+
+  size_t full = body / 4 * 4, needed = full / 4 * 3 + ((body > full) ? body - full - 1 : 0);
+  if (!out) {
+    SET_CODE_ERROR(err, OK);
+    return needed;
+  }
+
+  if (out_size < needed) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return 0;
+  }
+
+  const char *chars = base64_chars(alphabet);
+  const uint8_t *in = (const uint8_t *)data;
+  size_t done = base64_decode_block(in, full, out, out_size, chars);
+  if (done < full) {
+    SET_CODE_ERROR(err, INVALID_ENCODING);
+    return done / 4 * 3;
+  }
+
+  if (body > full && !base64_decode_tail(in + full, body - full, (uint8_t *)out + done / 4 * 3,
+                                         chars)) {
+    SET_CODE_ERROR(err, INVALID_ENCODING);
+    return done / 4 * 3;
+  }
+
+  SET_CODE_ERROR(err, OK);
+  return needed;
+}
+
+/// Make place for n more chars in str
+static easy_error string_reserve_more(string *str, size_t n) {
+  if (str->length + n + 1 > str->capacity)
+    return string_reserve(str, (str->length + n + 1) * 2);
+
+  return OK;
+}
+
+easy_error string_append_hex_encoded(string *str, const void *data, size_t length) {
+  CHECK_NULL_PTR((str && str->data));
+
+  easy_error err = OK;
+  size_t needed = hex_encode(data, length, NULL, 0, &err);
+  if (err != OK || (err = string_reserve_more(str, needed)) != OK)
+    return err;
+
+  hex_encode(data, length, str->data + str->length, needed, NULL);
+  str->length += needed;
+  str->data[str->length] = '\0';
+  string_invalidate_hash(str);
+
+  return OK;
+}
+
+easy_error string_append_hex_decoded(string *str, const char *data, size_t length) {
+  CHECK_NULL_PTR((str && str->data));
+
+  easy_error err = OK;
+  size_t needed = hex_decode(data, length, NULL, 0, &err);
+  if (err != OK || (err = string_reserve_more(str, needed)) != OK)
+    return err;
+
+  hex_decode(data, length, str->data + str->length, needed, &err);
+  if (err != OK) {
+    str->data[str->length] = '\0';
+    return err;
+  }
+
+  str->length += needed;
+  str->data[str->length] = '\0';
+  string_invalidate_hash(str);
+
+  return OK;
+}
+
+easy_error string_append_base64_encoded(string *str, const void *data, size_t length,
+                                        BASE64_ALPHABET alphabet) {
+  CHECK_NULL_PTR((str && str->data));
+
+  easy_error err = OK;
+  size_t needed = base64_encode(data, length, NULL, 0, alphabet, &err);
+  if (err != OK || (err = string_reserve_more(str, needed)) != OK)
+    return err;
+
+  base64_encode(data, length, str->data + str->length, needed, alphabet, NULL);
+  str->length += needed;
+  str->data[str->length] = '\0';
+  string_invalidate_hash(str);
+
+  return OK;
+}
+
+easy_error string_append_base64_decoded(string *str, const char *data, size_t length,
+                                        BASE64_ALPHABET alphabet) {
+  CHECK_NULL_PTR((str && str->data));
+
+  easy_error err = OK;
+  size_t needed = base64_decode(data, length, NULL, 0, alphabet, &err);
+  if (err != OK || (err = string_reserve_more(str, needed)) != OK)
+    return err;
+
+  // Whole free space is passed, so SIMD code can write behind decoded bytes
+  base64_decode(data, length, str->data + str->length, str->capacity - str->length, alphabet,
+                &err);
+  if (err != OK) {
+    str->data[str->length] = '\0';
+    return err;
+  }
+
+  str->length += needed;
+  str->data[str->length] = '\0';
+  string_invalidate_hash(str);
+
+  return OK;
+}
+
+void hex_decoder_init(hex_decoder *dec) {
+  if (!dec)
+    return;
+
+  dec->pending = 0;
+  dec->has_pending = false;
+}
+
+size_t hex_decoder_update(hex_decoder *dec, const char *data, size_t length, void *out,
+                          size_t out_size, easy_error *err) {
+  if (!dec || (!data && length > 0)) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  if (length == 0) {
+    SET_CODE_ERROR(err, OK);
+    return 0;
+  }
+
+  size_t needed = ((size_t)dec->has_pending + length) / 2;
+  if (out_size < needed || (!out && needed > 0)) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return 0;
+  }
+
+  uint8_t *o = (uint8_t *)out;
+  size_t n = 0;
+  if (dec->has_pending) {
+    int hi = hex_value((uint8_t)dec->pending), lo = hex_value((uint8_t)data[0]);
+    if (hi < 0 || lo < 0) {
+      SET_CODE_ERROR(err, INVALID_ENCODING);
+      return 0;
+    }
+
+    o[n++] = (uint8_t)(hi << 4 | lo);
+    dec->has_pending = false;
+    data++;
+    length--;
+  }
+
+  size_t full = length / 2 * 2;
+  size_t done = hex_decode_block((const uint8_t *)data, full, o + n);
+  n += done / 2;
+  if (done < full) {
+    SET_CODE_ERROR(err, INVALID_ENCODING);
+    return n;
+  }
+
+  if (full < length) {
+    dec->pending = data[full];
+    dec->has_pending = true;
+  }
+
+  SET_CODE_ERROR(err, OK);
+  return n;
+}
+
+easy_error hex_decoder_final(hex_decoder *dec) {
+  CHECK_NULL_PTR(dec);
+
+  bool odd = dec->has_pending;
+  dec->has_pending = false;
+
+  return odd ? INVALID_ENCODING : OK;
+}
+
+void base64_encoder_init(base64_encoder *enc, BASE64_ALPHABET alphabet) {
+  if (!enc)
+    return;
+
+  enc->alphabet = alphabet;
+  enc->pending_length = 0;
+}
+
+size_t base64_encoder_update(base64_encoder *enc, const void *data, size_t length, char *out,
+                             size_t out_size, easy_error *err) {
+  if (!enc || (!data && length > 0)) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  size_t needed = (enc->pending_length + length) / 3 * 4;
+  if (out_size < needed || (!out && needed > 0)) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return 0;
+  }
+
+  const char *chars = base64_chars(enc->alphabet);
+  const uint8_t *in = (const uint8_t *)data;
+  size_t n = 0;
+
+  if (enc->pending_length > 0) {
+    while (enc->pending_length < 3 && length > 0) {
+      enc->pending[enc->pending_length++] = *in++;
+      length--;
+    }
+
+    if (enc->pending_length < 3) {
+      SET_CODE_ERROR(err, OK);
+      return 0;
+    }
+
+    base64_encode_block(enc->pending, 3, out, chars);
+    enc->pending_length = 0;
+    n = 4;
+  }
+
+  size_t full = length / 3 * 3;
+  base64_encode_block(in, full, out + n, chars);
+  n += full / 3 * 4;
+
+  memcpy(enc->pending, in + full, length - full);
+  enc->pending_length = length - full;
+
+  SET_CODE_ERROR(err, OK);
+  return n;
+}
+
+size_t base64_encoder_final(base64_encoder *enc, char *out, size_t out_size, easy_error *err) {
+  if (!enc) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  if (enc->pending_length == 0) {
+    SET_CODE_ERROR(err, OK);
+    return 0;
+  }
+
+  bool padding = enc->alphabet != BASE64_URL;
+  if (!out || out_size < (padding ? 4 : enc->pending_length + 1)) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return 0;
+  }
+
+  size_t n = base64_encode_tail(enc->pending, enc->pending_length, out,
+                                base64_chars(enc->alphabet), padding);
+  enc->pending_length = 0;
+
+  SET_CODE_ERROR(err, OK);
+  return n;
+}
+
+void base64_decoder_init(base64_decoder *dec, BASE64_ALPHABET alphabet) {
+  if (!dec)
+    return;
+
+  dec->alphabet = alphabet;
+  dec->pending_length = 0;
+}
+
+size_t base64_decoder_update(base64_decoder *dec, const char *data, size_t length, void *out,
+                             size_t out_size, easy_error *err) {
+  if (!dec || (!data && length > 0)) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  size_t needed = (dec->pending_length + length) / 4 * 3;
+  if (out_size < needed || (!out && needed > 0)) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return 0;
+  }
+
+  // Last group of data is always kept, because it can be padded end of stream
+  const char *chars = base64_chars(dec->alphabet);
+  const uint8_t *in = (const uint8_t *)data;
+  uint8_t *o = (uint8_t *)out;
+  size_t n = 0;
+
+  while (length > 0) {
+    if (dec->pending_length == 4) {
+      if (!base64_decode_quad((const uint8_t *)dec->pending, o + n, chars)) {
+        SET_CODE_ERROR(err, INVALID_ENCODING);
+        return n;
+      }
+
+      n += 3;
+      dec->pending_length = 0;
+    }
+
+    if (dec->pending_length == 0 && length > 4) {
+      size_t full = (length - 1) / 4 * 4;
+      size_t done = base64_decode_block(in, full, o + n, out_size - n, chars);
+      n += done / 4 * 3;
+      if (done < full) {
+        SET_CODE_ERROR(err, INVALID_ENCODING);
+        return n;
+      }
+
+      in += full;
+      length -= full;
+    }
+
+    while (dec->pending_length < 4 && length > 0) {
+      dec->pending[dec->pending_length++] = (char)*in++;
+      length--;
+    }
+  }
+
+  SET_CODE_ERROR(err, OK);
+  return n;
+}
+
+size_t base64_decoder_final(base64_decoder *dec, void *out, size_t out_size, easy_error *err) {
+  if (!dec) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  size_t length = dec->pending_length;
+  dec->pending_length = 0;
+  if (length == 0) {
+    SET_CODE_ERROR(err, OK);
+    return 0;
+  }
+
+  size_t body = base64_strip_padding(dec->pending, length);
+  if (body < 2) {
+    SET_CODE_ERROR(err, INVALID_ENCODING);
+    return 0;
+  }
+
+  size_t needed = body - 1;
+  if (!out || out_size < needed) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return 0;
+  }
+
+  const char *chars = base64_chars(dec->alphabet);
+  bool ok = (body == 4) ? base64_decode_quad((const uint8_t *)dec->pending, out, chars)
+                        : base64_decode_tail((const uint8_t *)dec->pending, body, out, chars);
+  if (!ok) {
+    SET_CODE_ERROR(err, INVALID_ENCODING);
+    return 0;
+  }
+
+  SET_CODE_ERROR(err, OK);
+  return needed;
+}
@@ -32,6 +32,16 @@ const char *easy_error_message(easy_error err) {
     return "Expected parametr after argument";
   case PARSER_NO_PASSED_PARAMETRS:
     return "Expected at least one paramentr after argument";
+  case NUMBER_INVALID:
+    return "Text doesn't start with number";
+  case NUMBER_OUT_OF_RANGE:
+    return "Number is out of range of type";
+  case INVALID_ENCODING:
+    return "Text has invalid encoding";
+  case REGEX_INVALID:
+    return "Invalid syntax of regular expression";
+  case SYSTEM_CALL_FAILED:
+    return "System call failed";
 
   default:
     return "Unknown error";
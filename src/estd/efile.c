@@ -1,23 +1,74 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // fileno, madvise, writev, fdatasync, pread, O_DIRECT, splice
+#endif
+
 #include "estd/efile.h"
+#include "workers.h"
 #include <errno.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#define EFILE_MMAP 1
+#define EFILE_POSIX 1
+#endif
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#endif
+
+#define EFILE_MAX_IOV 64     // Count of pieces passed to one writev call
+#define EFILE_COPY_STEP ((size_t)1 << 30) // Max count of bytes passed to one copy call
 
 #define is_mode_reader(mode) (mode == READ || mode == READ_BIN)
 #define is_mode_writer(mode)                                                                       \
   (mode == WRITE || mode == WRITE_BIN || mode == APPEND || mode == APPEND_BIN ||                   \
    mode == READ_UPDATE || mode == READ_UPDATE_BIN || mode == WRITE_UPDATE ||                       \
    mode == WRITE_UPDATE_BIN || mode == APPEND_UPDATE || mode == APPEND_UPDATE_BIN)
+#define is_mode_append(mode)                                                                       \
+  (mode == APPEND || mode == APPEND_BIN || mode == APPEND_UPDATE || mode == APPEND_UPDATE_BIN)
+
+// Pipes have no position, their position isn't changed
 
 static inline easy_error update_position_r(freader *reader) {
-  reader->pos = get_position(reader);
-  return (reader->pos < 0) ? FILE_TELL_ERROR : OK;
+  int64_t pos = ftell(reader->fp);
+  if (pos < 0)
+    return (errno == ESPIPE) ? OK : FILE_TELL_ERROR;
+
+  reader->pos = pos;
+  return OK;
 }
 
 static inline easy_error update_position_w(fwriter *writer) {
-  writer->pos = get_position(writer);
-  return (writer->pos < 0) ? FILE_TELL_ERROR : OK;
+  int64_t pos = ftell(writer->fp);
+  if (pos < 0)
+    return (errno == ESPIPE) ? OK : FILE_TELL_ERROR;
+
+  writer->pos = pos;
+  return OK;
+}
+
+// Positions are moved by count of bytes, OS is asked only when it can't be known (short read,
+// scanf, seek)
+
+static inline void advance_position_r(freader *reader, size_t n) { reader->pos += (int64_t)n; }
+
+/// In append modes bytes are always written at end of file, wherever position is
+static inline void advance_position_w(fwriter *writer, size_t n) {
+  if (is_mode_append(writer->mode)) {
+    writer->file_size += n;
+    writer->pos = (int64_t)writer->file_size;
+  } else
+    writer->pos += (int64_t)n;
 }
 
 static const char *mode_to_string(FILE_MODE mode) {
@@ -72,6 +123,9 @@ freader *openr(const char *filename, FILE_MODE mode, easy_error *err) {
   }
 
   reader->mode = mode;
+  reader->pos = 0;
+  reader->map = NULL;
+  reader->map_size = 0;
   reader->fp = fopen(filename, mode_str);
 
   // Check if file is open
@@ -114,12 +168,16 @@ fwriter *openw(const char *filename, FILE_MODE mode, easy_error *err) {
   }
 
   writer->mode = mode;
+  writer->pos = 0;
+  writer->path = NULL;
+  writer->buffer = NULL;
+  writer->buffer_size = writer->buffered = writer->records = 0;
   writer->fp = fopen(filename, mode_str);
 
   // Check if file is open
   if (!IS_VALID_FILE(writer)) {
     SET_CODE_ERROR(err, FILE_OPEN_ERROR);
-    closew(writer);
+    free(writer);
     return NULL;
   }
 
@@ -131,13 +189,34 @@ fwriter *openw(const char *filename, FILE_MODE mode, easy_error *err) {
     return NULL;
   }
 
+  writer->file_size = 0;
+  struct stat st;
+  if (is_mode_append(mode) && fstat(fileno(writer->fp), &st) == 0)
+    writer->file_size = (size_t)st.st_size;
+
   SET_CODE_ERROR(err, OK);
   return writer;
 }
 
+/// Release content of file mapped by map_file
+static void unmap_file(freader *reader) {
+  if (!reader->map)
+    return;
+
+#ifdef EFILE_MMAP
+  munmap(reader->map, reader->map_size);
+#else
+  free(reader->map);
+#endif
+
+  reader->map = NULL;
+  reader->map_size = 0;
+}
+
 easy_error closer(freader *reader) {
   CHECK_NULL_PTR((reader && reader->fp));
 
+  unmap_file(reader);
   fclose(reader->fp);
   reader->fp = NULL;
 
@@ -149,14 +228,284 @@ easy_error closer(freader *reader) {
 easy_error closew(fwriter *writer) {
   CHECK_NULL_PTR((writer && writer->fp));
 
+  easy_error e = fwriter_flush(writer);
+  free(writer->buffer);
+
   fclose(writer->fp);
   writer->fp = NULL;
 
   free(writer);
 
+  return e;
+}
+
+static uint64_t time_ms(void) {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+/// Write all pieces into file, bypassing stdio. Pieces are changed while writing
+static easy_error write_pieces(fwriter *writer, string_view *pieces, size_t count) {
+#ifdef EFILE_POSIX
+  int fd = fileno(writer->fp);
+  while (count > 0) {
+    struct iovec iov[EFILE_MAX_IOV];
+    size_t n = (count < EFILE_MAX_IOV) ? count : EFILE_MAX_IOV;
+    for (size_t i = 0; i < n; i++) {
+      iov[i].iov_base = (void *)pieces[i].data;
+      iov[i].iov_len = pieces[i].length;
+    }
+
+    ssize_t written = writev(fd, iov, (int)n);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      return FILE_WRITE_FAILED;
+    }
+
+    // Skip written pieces, the last one can be written partially. Written pieces become empty,
+    // so caller knows what is left after error
+    size_t left = (size_t)written;
+    while (count > 0 && left >= pieces->length) {
+      left -= pieces->length;
+      pieces->data += pieces->length;
+      pieces->length = 0;
+      pieces++;
+      count--;
+    }
+    if (count > 0) {
+      pieces->data += left;
+      pieces->length -= left;
+    }
+  }
+#else
+  for (size_t i = 0; i < count; i++) {
+    size_t written = fwrite(pieces[i].data, 1, pieces[i].length, writer->fp);
+    pieces[i].data += written;
+    pieces[i].length -= written;
+    if (pieces[i].length > 0)
+      return FILE_WRITE_FAILED;
+  }
+  if (fflush(writer->fp) != 0)
+    return FILE_WRITE_FAILED;
+#endif
+
+  return OK;
+}
+
+/// Keep unwritten tail of buffer after failed write, so next flush writes it again
+static void keep_tail(fwriter *writer, const string_view *tail) {
+  memmove(writer->buffer, tail->data, tail->length);
+  writer->buffered = tail->length;
+}
+
+/// Write content of buffer, it's cleared only when it's written
+static easy_error write_buffer(fwriter *writer) {
+  if (writer->buffered == 0)
+    return OK;
+
+  string_view piece = {writer->buffer, writer->buffered};
+  easy_error e = write_pieces(writer, &piece, 1);
+  if (e != OK) {
+    keep_tail(writer, &piece);
+    return e;
+  }
+
+  writer->buffered = 0;
+  return OK;
+}
+
+easy_error fwriter_set_buffer(fwriter *writer, size_t buffer_size, const fwriter_policy *policy) {
+  CHECK_NULL_PTR((writer && writer->fp));
+
+  // Data from stdio buffer and old buffer must be written before new data
+  easy_error e = fwriter_flush(writer);
+  if (e != OK)
+    return e;
+  if (fflush(writer->fp) != 0)
+    return FILE_WRITE_FAILED;
+
+  if (buffer_size == 0)
+    buffer_size = FWRITER_BUFFER_SIZE;
+
+  char *buffer = (char *)realloc(writer->buffer, buffer_size);
+  CHECK_ALLOCATION(buffer);
+
+  writer->buffer = buffer;
+  writer->buffer_size = buffer_size;
+  writer->buffered = 0;
+  writer->records = 0;
+  writer->last_flush = time_ms();
+  if (policy)
+    writer->policy = *policy;
+  else
+    memset(&writer->policy, 0, sizeof(writer->policy));
+
+  return OK;
+}
+
+easy_error fwriter_flush(fwriter *writer) {
+  CHECK_NULL_PTR((writer && writer->fp));
+
+  if (!writer->buffer)
+    return (fflush(writer->fp) == 0) ? OK : FILE_WRITE_FAILED;
+
+  writer->records = 0;
+  writer->last_flush = writer->policy.flush_interval ? time_ms() : 0;
+  if (writer->buffered == 0)
+    return OK;
+
+  easy_error e = write_buffer(writer);
+  if (e != OK)
+    return e;
+
+  return writer->policy.sync ? fwriter_sync(writer) : OK;
+}
+
+easy_error fwriter_sync(fwriter *writer) {
+  CHECK_NULL_PTR((writer && writer->fp));
+
+  if (writer->buffer && writer->buffered > 0) {
+    easy_error e = write_buffer(writer);
+    if (e != OK)
+      return e;
+  } else if (!writer->buffer && fflush(writer->fp) != 0)
+    return FILE_WRITE_FAILED;
+
+#if defined(EFILE_POSIX) && !defined(__APPLE__)
+  if (fdatasync(fileno(writer->fp)) != 0)
+    return FILE_WRITE_FAILED;
+#elif defined(EFILE_POSIX)
+  if (fsync(fileno(writer->fp)) != 0)
+    return FILE_WRITE_FAILED;
+#endif
+
+  return OK;
+}
+
+/// Called after each writing call of buffered writer
+static easy_error apply_policy(fwriter *writer) {
+  const fwriter_policy *policy = &writer->policy;
+  writer->records++;
+
+  if ((policy->flush_bytes && writer->buffered >= policy->flush_bytes) ||
+      (policy->flush_records && writer->records >= policy->flush_records) ||
+      (policy->flush_interval && time_ms() - writer->last_flush >= policy->flush_interval))
+    return fwriter_flush(writer);
+
   return OK;
 }
 
+/// Position after failed write: bytes kept in buffer are still ahead of file
+static void resync_position(fwriter *writer) {
+  if (file_sync_position(writer) >= 0)
+    writer->pos += (int64_t)writer->buffered;
+}
+
+/// Add pieces to buffer of writer. If they don't fit, buffer and pieces are written together.
+/// Bytes of pieces which are buffered or written into file are added to written, even on error
+static easy_error buffered_write(fwriter *writer, const string_view *parts, size_t count,
+                                 size_t total, size_t *written) {
+  *written = 0;
+  if (total <= writer->buffer_size - writer->buffered) {
+    for (size_t i = 0; i < count; i++) {
+      memcpy(writer->buffer + writer->buffered, parts[i].data, parts[i].length);
+      writer->buffered += parts[i].length;
+    }
+    *written = total;
+    return apply_policy(writer);
+  }
+
+  // Small pieces are buffered after flush, big ones go to file straight
+  if (total < writer->buffer_size / 2 && count == 1) {
+    easy_error e = fwriter_flush(writer);
+    if (e != OK)
+      return e;
+
+    memcpy(writer->buffer, parts[0].data, total);
+    writer->buffered = total;
+    *written = total;
+    return apply_policy(writer);
+  }
+
+  // Buffer is the first piece of first batch. If writing fails, its unwritten tail is kept
+  string_view local[EFILE_MAX_IOV];
+  size_t n = 0;
+  bool has_buffer = writer->buffered > 0;
+  if (has_buffer)
+    local[n++] = (string_view){writer->buffer, writer->buffered};
+
+  for (size_t i = 0; i <= count; i++) {
+    if (n == EFILE_MAX_IOV || (i == count && n > 0)) {
+      easy_error e = write_pieces(writer, local, n);
+      if (e != OK) {
+        if (has_buffer)
+          keep_tail(writer, &local[0]);
+        // Piece j of batch is parts[i - n + j], what is left of it wasn't written
+        for (size_t j = has_buffer ? 1 : 0; j < n; j++)
+          *written += parts[i - n + j].length - local[j].length;
+        return e;
+      }
+      for (size_t j = has_buffer ? 1 : 0; j < n; j++)
+        *written += parts[i - n + j].length;
+      if (has_buffer)
+        writer->buffered = 0;
+      has_buffer = false;
+      n = 0;
+    }
+    if (i < count)
+      local[n++] = parts[i];
+  }
+
+  writer->records = 0;
+  writer->last_flush = writer->policy.flush_interval ? time_ms() : 0;
+  return writer->policy.sync ? fwriter_sync(writer) : OK;
+}
+
+size_t write_bytesv(fwriter *writer, const string_view *parts, size_t count, easy_error *err) {
+  if (!writer || !writer->fp) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  if (!parts && count > 0) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return 0;
+  }
+
+  size_t total = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (!parts[i].data && parts[i].length > 0) {
+      SET_CODE_ERROR(err, INVALID_ARGUMENT);
+      return 0;
+    }
+    total += parts[i].length;
+  }
+
+  if (!writer->buffer) { // stdio buffers pieces itself
+    size_t written = 0;
+    for (size_t i = 0; i < count; i++)
+      written += fwrite(parts[i].data, 1, parts[i].length, writer->fp);
+
+    advance_position_w(writer, written);
+    SET_CODE_ERROR(err, (written == total) ? OK : FILE_WRITE_FAILED);
+    return written;
+  }
+
+  size_t written = 0;
+  easy_error e = buffered_write(writer, parts, count, total, &written);
+  if (e != OK) {
+    resync_position(writer);
+    SET_CODE_ERROR(err, e);
+    return written;
+  }
+
+  advance_position_w(writer, total);
+  SET_CODE_ERROR(err, OK);
+  return total;
+}
+
 size_t write_bytes(fwriter *writer, const void *data, size_t size, size_t count, easy_error *err) {
   if (!writer || !writer->fp) {
     SET_CODE_ERROR(err, NULL_POINTER);
@@ -168,6 +517,21 @@ size_t write_bytes(fwriter *writer, const void *data, size_t size, size_t count,
     return 0;
   }
 
+  if (writer->buffer) {
+    if (size != 0 && count > SIZE_MAX / size) {
+      SET_CODE_ERROR(err, INVALID_ARGUMENT);
+      return 0;
+    }
+
+    string_view piece = {(const char *)data, size * count};
+    easy_error e = OK;
+    size_t written = write_bytesv(writer, &piece, 1, &e);
+    SET_CODE_ERROR(err, e);
+    if (size == 0)
+      return (e == OK) ? count : 0;
+    return written / size; // Only whole elements, same as fwrite
+  }
+
   size_t written = fwrite(data, size, count, writer->fp);
 
   /* NOTE: Probably shouldn't be a error
@@ -176,32 +540,72 @@ size_t write_bytes(fwriter *writer, const void *data, size_t size, size_t count,
     return FILE_WRITE_FAILED;
 */
 
-  easy_error e = update_position_w(writer);
-  if (e != OK) {
-    SET_CODE_ERROR(err, e);
-    return 0;
+  if (written == count)
+    advance_position_w(writer, written * size);
+  else { // Part of element could be written
+    easy_error e = update_position_w(writer);
+    if (e != OK) {
+      SET_CODE_ERROR(err, e);
+      return 0;
+    }
   }
 
   SET_CODE_ERROR(err, OK);
   return written;
 }
 
+/// Format text straight into buffer of writer
+static int buffered_printf(fwriter *writer, const char *format, va_list args) {
+  va_list copy;
+  va_copy(copy, args);
+  size_t space = writer->buffer_size - writer->buffered;
+  int length = vsnprintf(writer->buffer + writer->buffered, space, format, copy);
+  va_end(copy);
+
+  if (length < 0)
+    return FILE_WRITE_FAILED;
+
+  if ((size_t)length < space) {
+    writer->buffered += (size_t)length;
+    easy_error e = apply_policy(writer);
+    return (e == OK) ? length : e;
+  }
+
+  // Text didn't fit, so it is formatted again
+  char *text = (char *)malloc((size_t)length + 1);
+  if (!text)
+    return ALLOCATION_FAILED;
+
+  vsnprintf(text, (size_t)length + 1, format, args);
+  string_view piece = {text, (size_t)length};
+  size_t written = 0;
+  easy_error e = buffered_write(writer, &piece, 1, (size_t)length, &written);
+  free(text);
+
+  return (e == OK) ? length : e;
+}
+
 int writef(fwriter *writer, const char *format, ...) {
   CHECK_NULL_PTR((writer && writer->fp && format));
 
   // Parse arguments
   va_list args;
   va_start(args, format);
-  int result = vfprintf(writer->fp, format, args);
+  int result;
+  if (writer->buffer)
+    result = buffered_printf(writer, format, args);
+  else
+    result = vfprintf(writer->fp, format, args);
   va_end(args);
 
   // If vfprintf return error
-  if (result < 0)
+  if (result < 0) {
+    if (writer->buffer)
+      resync_position(writer);
     return FILE_WRITE_FAILED;
+  }
 
-  easy_error e = update_position_w(writer);
-  if (e != OK)
-    return e;
+  advance_position_w(writer, (size_t)result);
 
   return result;
 }
@@ -227,14 +631,65 @@ size_t read_bytes(freader *reader, void *buffer, size_t size, size_t count, easy
   }
   */
 
-  easy_error e = update_position_r(reader);
-  if (e != OK)
-    return e;
+  if (read_size == count)
+    advance_position_r(reader, read_size * size);
+  else { // Part of element could be read at end of file
+    easy_error e = update_position_r(reader);
+    if (e != OK) {
+      SET_CODE_ERROR(err, e);
+      return 0;
+    }
+  }
 
   SET_CODE_ERROR(err, OK);
   return read_size;
 }
 
+size_t read_bytes_at(freader *reader, uint64_t offset, void *buffer, size_t length,
+                     easy_error *err) {
+  if (!reader || !reader->fp) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  if (!buffer || offset > INT64_MAX) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return 0;
+  }
+
+  size_t total = 0;
+#ifdef EFILE_POSIX
+  int fd = fileno(reader->fp);
+  while (total < length) {
+    ssize_t n = pread(fd, (char *)buffer + total, length - total, (off_t)(offset + total));
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0) {
+      SET_CODE_ERROR(err, FILE_READ_FAILED);
+      return total;
+    }
+    if (n == 0) // End of file
+      break;
+
+    total += (size_t)n;
+  }
+#else
+  if (fseek(reader->fp, (long)offset, SEEK_SET) != 0) {
+    SET_CODE_ERROR(err, FILE_SEEK_ERROR);
+    return 0;
+  }
+  total = fread(buffer, 1, length, reader->fp);
+  bool failed = ferror(reader->fp);
+  if (fseek(reader->fp, reader->pos, SEEK_SET) != 0 || failed) {
+    SET_CODE_ERROR(err, failed ? FILE_READ_FAILED : FILE_SEEK_ERROR);
+    return total;
+  }
+#endif
+
+  SET_CODE_ERROR(err, OK);
+  return total;
+}
+
 int readf(freader *reader, const char *format, ...) {
   if (!reader || !reader->fp)
     return NULL_POINTER;
@@ -252,6 +707,7 @@ int readf(freader *reader, const char *format, ...) {
   if (result < 0)
     return FILE_READ_FAILED;
 
+  // scanf doesn't tell count of consumed chars
   easy_error e = update_position_r(reader);
   if (e != OK)
     return e;
@@ -288,11 +744,7 @@ string *read_line(freader *reader, easy_error *err) {
     return NULL;
   }
 
-  easy_error e = update_position_r(reader);
-  if (e != OK) {
-    SET_CODE_ERROR(err, e);
-    return NULL;
-  }
+  advance_position_r(reader, line->length + (ch == '\n'));
 
   SET_CODE_ERROR(err, OK);
   return line;
@@ -315,10 +767,13 @@ string *read_file(freader *reader, easy_error *err) {
     return NULL;
   }
 
+  errno = 0; // rewind reports errors only by errno
   file_rewind(reader);
 
-  if (errno != 0)
+  if (errno != 0) {
+    SET_CODE_ERROR(err, FILE_SEEK_ERROR);
     return NULL;
+  }
 
   string *text = (string *)malloc(sizeof(string));
   if (!text) {
@@ -336,16 +791,694 @@ string *read_file(freader *reader, easy_error *err) {
   size_t readsize = fread(text->data, 1, filesize, reader->fp);
   text->data[readsize] = '\0';
   text->length = readsize;
+  string_invalidate_hash(text);
   text->capacity = readsize + 1;
+  reader->pos = (int64_t)readsize; // Reading started from beginning
 
-  easy_error e = update_position_r(reader);
-  if (e != OK) {
-    free(text->data);
+  SET_CODE_ERROR(err, OK);
+  return text;
+}
+
+#ifdef EFILE_POSIX
+typedef struct parallel_read {
+  int fd;
+  int buffered_fd; // Descriptor without O_DIRECT or -1
+  bool direct;
+  char *data;
+  size_t size; // Size of file
+  size_t chunks;
+  size_t next_chunk;
+  easy_error error;
+  pthread_mutex_t lock;
+
+} parallel_read;
+
+/// Read want bytes of range, length is bigger only for O_DIRECT, which reads whole blocks
+static easy_error read_range(parallel_read *pr, size_t offset, size_t length, size_t want) {
+  int fd = pr->fd;
+  size_t done = 0;
+  while (done < length) {
+    ssize_t n = pread(fd, pr->data + offset + done, length - done, (off_t)(offset + done));
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0 && errno == EINVAL && fd != pr->buffered_fd) {
+      fd = pr->buffered_fd; // Unaligned tail or file system refused direct read
+      continue;
+    }
+    if (n < 0)
+      return FILE_READ_FAILED;
+    if (n == 0)
+      break;
+
+    done += (size_t)n;
+  }
+
+  return (done >= want) ? OK : FILE_READ_FAILED; // File was truncated while reading
+}
+
+static void *parallel_worker(void *arg) {
+  parallel_read *pr = (parallel_read *)arg;
+
+  for (;;) {
+    pthread_mutex_lock(&pr->lock);
+    size_t chunk = pr->next_chunk++;
+    bool stop = pr->error != OK || chunk >= pr->chunks;
+    pthread_mutex_unlock(&pr->lock);
+    if (stop)
+      break;
+
+    size_t offset = chunk * FILE_PARALLEL_CHUNK;
+    size_t want = pr->size - offset;
+    if (want > FILE_PARALLEL_CHUNK)
+      want = FILE_PARALLEL_CHUNK;
+    size_t length =
+        pr->direct ? (want + FILE_DIRECT_ALIGN - 1) / FILE_DIRECT_ALIGN * FILE_DIRECT_ALIGN : want;
+
+    easy_error e = read_range(pr, offset, length, want);
+    if (e != OK) {
+      pthread_mutex_lock(&pr->lock);
+      pr->error = e;
+      pthread_mutex_unlock(&pr->lock);
+    }
+  }
+
+  return NULL;
+}
+#endif
+
+string *read_file_parallel(const char *filename, size_t nthreads, int flags, easy_error *err) {
+  if (!filename) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return NULL;
+  }
+
+#ifndef EFILE_POSIX
+  (void)nthreads;
+  (void)flags;
+  freader *reader = openr(filename, READ_BIN, err);
+  if (!reader)
+    return NULL;
+
+  string *result = read_file(reader, err);
+  closer(reader);
+  return result;
+#else
+  parallel_read pr = {.fd = -1, .buffered_fd = -1, .error = OK};
+  pr.fd = open(filename, O_RDONLY | O_CLOEXEC);
+  if (pr.fd < 0) {
+    SET_CODE_ERROR(err, FILE_OPEN_ERROR);
+    return NULL;
+  }
+  pr.buffered_fd = pr.fd;
+
+  struct stat st;
+  if (fstat(pr.fd, &st) != 0 || (uint64_t)st.st_size > SIZE_MAX - FILE_DIRECT_ALIGN) {
+    close(pr.fd);
+    SET_CODE_ERROR(err, FILE_READ_FAILED);
+    return NULL;
+  }
+  pr.size = (size_t)st.st_size;
+  pr.chunks = (pr.size + FILE_PARALLEL_CHUNK - 1) / FILE_PARALLEL_CHUNK;
+
+#ifdef O_DIRECT
+  if ((flags & FILE_READ_DIRECT) && pr.size > 0) {
+    int fd = open(filename, O_RDONLY | O_CLOEXEC | O_DIRECT);
+    if (fd >= 0) { // Some file systems (tmpfs) refuse O_DIRECT, then page cache is used
+      pr.fd = fd;
+      pr.direct = true;
+    }
+  }
+#else
+  (void)flags;
+#endif
+
+  // Direct reads need aligned buffer and whole blocks, there is also place for '\0'
+  size_t capacity = pr.size + 1;
+  if (pr.direct) {
+    capacity = (pr.size + FILE_DIRECT_ALIGN) / FILE_DIRECT_ALIGN * FILE_DIRECT_ALIGN;
+    void *data = NULL;
+    if (posix_memalign(&data, FILE_DIRECT_ALIGN, capacity) == 0)
+      pr.data = (char *)data;
+  } else
+    pr.data = (char *)malloc(capacity);
+
+  string *text = (string *)malloc(sizeof(string));
+  if (!text || !pr.data) {
     free(text);
-    SET_CODE_ERROR(err, e);
+    free(pr.data);
+    if (pr.direct)
+      close(pr.fd);
+    close(pr.buffered_fd);
+    SET_CODE_ERROR(err, ALLOCATION_FAILED);
     return NULL;
   }
 
+  pthread_mutex_init(&pr.lock, NULL);
+  run_workers(parallel_worker, &pr, nthreads, pr.chunks);
+  pthread_mutex_destroy(&pr.lock);
+
+  if (pr.direct)
+    close(pr.fd);
+  close(pr.buffered_fd);
+
+  if (pr.error != OK) {
+    free(text);
+    free(pr.data);
+    SET_CODE_ERROR(err, pr.error);
+    return NULL;
+  }
+
+  pr.data[pr.size] = '\0';
+  text->data = pr.data;
+  text->length = pr.size;
+  text->capacity = capacity;
+  string_invalidate_hash(text);
+
   SET_CODE_ERROR(err, OK);
   return text;
+#endif
+}
+
+#ifdef EFILE_POSIX
+typedef struct copy_job {
+  int in;
+  int out;
+  bool in_pipe;
+  bool out_pipe;
+  bool move_out; // Position of out can be changed, so sendfile can be used
+  bool kernel;   // Copy by kernel is allowed
+  uint64_t in_offset;
+  uint64_t out_offset;
+  uint64_t left; // FILE_COPY_ALL is so big, that it is never copied whole
+  uint64_t copied;
+
+} copy_job;
+
+static inline size_t copy_step(const copy_job *job) {
+  return (job->left < EFILE_COPY_STEP) ? (size_t)job->left : EFILE_COPY_STEP;
+}
+
+static inline void copy_advance(copy_job *job, size_t n) {
+  job->copied += n;
+  job->in_offset += n;
+  job->out_offset += n;
+  job->left -= n;
+}
+
+/// Files of /proc and /sys have zero size and some kernels copy nothing from them
+static inline bool kernel_copy_allowed(const struct stat *in) {
+  return !S_ISREG(in->st_mode) || in->st_size > 0;
+}
+
+/// Errors after which other way of copying can succeed
+static inline bool copy_unsupported(int error) {
+  return error == EINVAL || error == ENOSYS || error == EXDEV || error == EOPNOTSUPP;
+}
+
+#ifdef __linux__
+// Kernel copies return false, if they can't copy these files, then next way is tried
+
+static bool splice_copy(copy_job *job, easy_error *err) {
+  while (job->left > 0) {
+    loff_t in_offset = (loff_t)job->in_offset, out_offset = (loff_t)job->out_offset;
+    ssize_t n = splice(job->in, job->in_pipe ? NULL : &in_offset, job->out,
+                       job->out_pipe ? NULL : &out_offset, copy_step(job), SPLICE_F_MOVE);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0) {
+      if (copy_unsupported(errno))
+        return false;
+      *err = FILE_WRITE_FAILED;
+      return true;
+    }
+    if (n == 0)
+      break;
+
+    copy_advance(job, (size_t)n);
+  }
+
+  return true;
+}
+
+#ifdef __NR_copy_file_range
+static bool range_copy(copy_job *job, easy_error *err) {
+  while (job->left > 0) {
+    loff_t in_offset = (loff_t)job->in_offset, out_offset = (loff_t)job->out_offset;
+    long n = syscall(__NR_copy_file_range, job->in, &in_offset, job->out, &out_offset,
+                     copy_step(job), 0);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0) {
+      if (copy_unsupported(errno) || errno == EBADF) // EBADF also for O_APPEND
+        return false;
+      *err = FILE_WRITE_FAILED;
+      return true;
+    }
+    if (n == 0)
+      break;
+
+    copy_advance(job, (size_t)n);
+  }
+
+  return true;
+}
+#endif
+
+static bool sendfile_copy(copy_job *job, easy_error *err) {
+  if (!job->move_out || job->in_pipe ||
+      lseek(job->out, (off_t)job->out_offset, SEEK_SET) != (off_t)job->out_offset)
+    return false;
+
+  while (job->left > 0) {
+    off_t in_offset = (off_t)job->in_offset;
+    ssize_t n = sendfile(job->out, job->in, &in_offset, copy_step(job));
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0) {
+      if (copy_unsupported(errno))
+        return false;
+      *err = FILE_WRITE_FAILED;
+      return true;
+    }
+    if (n == 0)
+      break;
+
+    copy_advance(job, (size_t)n);
+  }
+
+  return true;
+}
+#endif // __linux__
+
+/// Copy through buffer in user space, pipes are read and written without offsets
+static easy_error buffered_copy(copy_job *job) {
+  char *buffer = (char *)malloc(FILE_COPY_BUFFER_SIZE);
+  CHECK_ALLOCATION(buffer);
+
+  easy_error e = OK;
+  while (job->left > 0 && e == OK) {
+    size_t step = (job->left < FILE_COPY_BUFFER_SIZE) ? (size_t)job->left : FILE_COPY_BUFFER_SIZE;
+    ssize_t n = job->in_pipe ? read(job->in, buffer, step)
+                             : pread(job->in, buffer, step, (off_t)job->in_offset);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0) {
+      e = FILE_READ_FAILED;
+      break;
+    }
+    if (n == 0)
+      break;
+
+    for (size_t written = 0; written < (size_t)n;) {
+      ssize_t w = job->out_pipe ? write(job->out, buffer + written, (size_t)n - written)
+                                : pwrite(job->out, buffer + written, (size_t)n - written,
+                                         (off_t)(job->out_offset + written));
+      if (w < 0 && errno == EINTR)
+        continue;
+      if (w <= 0) {
+        e = FILE_WRITE_FAILED;
+        break;
+      }
+      written += (size_t)w;
+    }
+    if (e == OK)
+      copy_advance(job, (size_t)n);
+  }
+
+  free(buffer);
+  return e;
+}
+
+static easy_error copy_fds(copy_job *job) {
+#ifdef __linux__
+  easy_error e = OK;
+  bool pipes = job->in_pipe || job->out_pipe;
+  if (job->kernel && pipes && splice_copy(job, &e))
+    return e;
+#ifdef __NR_copy_file_range
+  if (job->kernel && !pipes && range_copy(job, &e))
+    return e;
+#endif
+  if (job->kernel && !pipes && sendfile_copy(job, &e))
+    return e;
+#endif
+
+  return buffered_copy(job);
+}
+#endif // EFILE_POSIX
+
+easy_error file_copy(const char *src, const char *dst) {
+  CHECK_NULL_PTR(src);
+  CHECK_NULL_PTR(dst);
+
+#ifdef EFILE_POSIX
+  int in = open(src, O_RDONLY | O_CLOEXEC);
+  if (in < 0)
+    return FILE_OPEN_ERROR;
+
+  struct stat in_st, out_st;
+  if (fstat(in, &in_st) != 0) {
+    close(in);
+    return FILE_READ_FAILED;
+  }
+
+  // File isn't truncated on open, because it can be src
+  int out = open(dst, O_WRONLY | O_CREAT | O_CLOEXEC, in_st.st_mode & 0777);
+  if (out < 0) {
+    close(in);
+    return FILE_OPEN_ERROR;
+  }
+
+  easy_error e = OK;
+  if (fstat(out, &out_st) != 0)
+    e = FILE_WRITE_FAILED;
+  else if (in_st.st_dev == out_st.st_dev && in_st.st_ino == out_st.st_ino)
+    e = INVALID_ARGUMENT;
+  else if (S_ISREG(out_st.st_mode) && ftruncate(out, 0) != 0)
+    e = FILE_WRITE_FAILED;
+
+  if (e == OK) {
+    copy_job job = {.in = in,
+                    .out = out,
+                    .in_pipe = S_ISFIFO(in_st.st_mode),
+                    .out_pipe = S_ISFIFO(out_st.st_mode),
+                    .move_out = true,
+                    .kernel = kernel_copy_allowed(&in_st),
+                    .left = FILE_COPY_ALL};
+    e = copy_fds(&job);
+  }
+
+  close(in);
+  if (close(out) != 0 && e == OK)
+    e = FILE_WRITE_FAILED;
+
+  return e;
+#else
+  freader *reader = openr(src, READ_BIN, NULL);
+  if (!reader)
+    return FILE_OPEN_ERROR;
+
+  fwriter *writer = openw(dst, WRITE_BIN, NULL);
+  if (!writer) {
+    closer(reader);
+    return FILE_OPEN_ERROR;
+  }
+
+  easy_error e = OK;
+  file_copy_range(reader, 0, writer, 0, FILE_COPY_ALL, &e);
+  closer(reader);
+  easy_error close_error = closew(writer);
+
+  return (e != OK) ? e : close_error;
+#endif
+}
+
+uint64_t file_copy_range(freader *reader, uint64_t in_offset, fwriter *writer,
+                         uint64_t out_offset, uint64_t length, easy_error *err) {
+  if (!reader || !reader->fp || !writer || !writer->fp) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  if (is_mode_append(writer->mode)) {
+    SET_CODE_ERROR(err, FILE_INVALID_MODE);
+    return 0;
+  }
+
+  if (in_offset > INT64_MAX || out_offset > INT64_MAX) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return 0;
+  }
+
+  easy_error e = fwriter_flush(writer);
+  if (e != OK) {
+    SET_CODE_ERROR(err, e);
+    return 0;
+  }
+
+#ifdef EFILE_POSIX
+  struct stat in_st, out_st;
+  if (fstat(fileno(reader->fp), &in_st) != 0 || fstat(fileno(writer->fp), &out_st) != 0) {
+    SET_CODE_ERROR(err, FILE_READ_FAILED);
+    return 0;
+  }
+
+  copy_job job = {.in = fileno(reader->fp),
+                  .out = fileno(writer->fp),
+                  .in_pipe = S_ISFIFO(in_st.st_mode),
+                  .out_pipe = S_ISFIFO(out_st.st_mode),
+                  .kernel = kernel_copy_allowed(&in_st),
+                  .in_offset = in_offset,
+                  .out_offset = out_offset,
+                  .left = length};
+  e = copy_fds(&job);
+
+  SET_CODE_ERROR(err, e);
+  return job.copied;
+#else
+  char *buffer = (char *)malloc(FILE_COPY_BUFFER_SIZE);
+  if (!buffer) {
+    SET_CODE_ERROR(err, ALLOCATION_FAILED);
+    return 0;
+  }
+
+  uint64_t copied = 0;
+  while (copied < length && e == OK) {
+    size_t step = (length - copied < FILE_COPY_BUFFER_SIZE) ? (size_t)(length - copied)
+                                                            : FILE_COPY_BUFFER_SIZE;
+    size_t n = read_bytes_at(reader, in_offset + copied, buffer, step, &e);
+    if (n == 0 || e != OK)
+      break;
+
+    if (fseek(writer->fp, (long)(out_offset + copied), SEEK_SET) != 0)
+      e = FILE_SEEK_ERROR;
+    else if (fwrite(buffer, 1, n, writer->fp) != n)
+      e = FILE_WRITE_FAILED;
+    else
+      copied += n;
+  }
+  free(buffer);
+
+  if (fseek(writer->fp, writer->pos, SEEK_SET) != 0 && e == OK)
+    e = FILE_SEEK_ERROR;
+
+  SET_CODE_ERROR(err, e);
+  return copied;
+#endif
+}
+
+#ifdef EFILE_MMAP
+static void advise_map(void *map, size_t size, int advice) {
+  if (advice & FILE_MAP_SEQUENTIAL)
+    madvise(map, size, MADV_SEQUENTIAL);
+  if (advice & FILE_MAP_WILLNEED)
+    madvise(map, size, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+  if (advice & FILE_MAP_HUGEPAGE)
+    madvise(map, size, MADV_HUGEPAGE);
+#endif
+}
+#endif
+
+/// Map whole file into reader->map. Hints are only advice, so their errors are ignored
+static easy_error map_file(freader *reader, int advice) {
+  struct stat st;
+  if (fstat(fileno(reader->fp), &st) != 0)
+    return FILE_READ_FAILED;
+
+  // Pipes and devices have no size, their content can be got only by read_file
+  if (!S_ISREG(st.st_mode))
+    return INVALID_ARGUMENT;
+  if ((uint64_t)st.st_size > SIZE_MAX)
+    return ALLOCATION_FAILED;
+
+  size_t size = (size_t)st.st_size;
+  if (size == 0) { // Empty file can't be mapped
+#ifdef EFILE_POSIX
+    // Pseudo-files (like in /proc) have zero size, but aren't empty
+    char probe;
+    ssize_t n = pread(fileno(reader->fp), &probe, 1, 0);
+    if (n < 0)
+      return FILE_READ_FAILED;
+    if (n > 0)
+      return INVALID_ARGUMENT;
+#endif
+    return OK;
+  }
+
+#ifdef EFILE_MMAP
+  void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(reader->fp), 0);
+  if (map == MAP_FAILED)
+    return FILE_READ_FAILED;
+
+  advise_map(map, size, advice);
+#else
+  (void)advice;
+  void *map = malloc(size);
+  CHECK_ALLOCATION(map);
+
+  int64_t pos = reader->pos;
+  if (fseek(reader->fp, 0, SEEK_SET) != 0 || fread(map, 1, size, reader->fp) != size) {
+    free(map);
+    return FILE_READ_FAILED;
+  }
+  fseek(reader->fp, pos, SEEK_SET);
+#endif
+
+  reader->map = map;
+  reader->map_size = size;
+
+  return OK;
+}
+
+freader *freader_mmap(const char *filename, int advice, easy_error *err) {
+  freader *reader = openr(filename, READ_BIN, err);
+  if (!reader)
+    return NULL;
+
+  easy_error e = map_file(reader, advice);
+  if (e != OK) {
+    SET_CODE_ERROR(err, e);
+    closer(reader);
+    return NULL;
+  }
+
+  SET_CODE_ERROR(err, OK);
+  return reader;
+}
+
+string_view read_file_mapped(freader *reader, easy_error *err) {
+  string_view view = {"", 0};
+  if (!reader || !reader->fp) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return view;
+  }
+
+  if (!reader->map) {
+    easy_error e = map_file(reader, FILE_MAP_SEQUENTIAL);
+    if (e != OK) {
+      SET_CODE_ERROR(err, e);
+      return view;
+    }
+  }
+
+  if (reader->map) {
+    view.data = (const char *)reader->map;
+    view.length = reader->map_size;
+  }
+
+  SET_CODE_ERROR(err, OK);
+  return view;
+}
+
+line_reader *line_reader_init(freader *reader, size_t buffer_size, bool strip_cr,
+                              easy_error *err) {
+  if (!reader || !reader->fp) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return NULL;
+  }
+
+  line_reader *lr = (line_reader *)malloc(sizeof(line_reader));
+  if (!lr) {
+    SET_CODE_ERROR(err, ALLOCATION_FAILED);
+    return NULL;
+  }
+
+  lr->capacity = (buffer_size > 0) ? buffer_size : LINE_READER_BUFFER_SIZE;
+  lr->buffer = (char *)malloc(lr->capacity);
+  if (!lr->buffer) {
+    free(lr);
+    SET_CODE_ERROR(err, ALLOCATION_FAILED);
+    return NULL;
+  }
+
+  lr->reader = reader;
+  lr->start = lr->end = 0;
+  lr->line_number = 0;
+  lr->strip_cr = strip_cr;
+  lr->eof = false;
+
+  SET_CODE_ERROR(err, OK);
+  return lr;
+}
+
+void line_reader_free_(line_reader *lr) {
+  if (!lr)
+    return;
+
+  free(lr->buffer);
+  free(lr);
+}
+
+/// Read next block of file behind unread data. Unread data is moved to start of buffer
+static easy_error line_reader_fill(line_reader *lr) {
+  size_t used = lr->end - lr->start;
+  if (lr->start > 0) {
+    memmove(lr->buffer, lr->buffer + lr->start, used);
+    lr->start = 0;
+    lr->end = used;
+  } else if (lr->end == lr->capacity) { // Line is longer than buffer
+    char *bigger = (char *)realloc(lr->buffer, lr->capacity * 2);
+    CHECK_ALLOCATION(bigger);
+
+    lr->buffer = bigger;
+    lr->capacity *= 2;
+  }
+
+  size_t n = fread(lr->buffer + lr->end, 1, lr->capacity - lr->end, lr->reader->fp);
+  if (n == 0) {
+    if (ferror(lr->reader->fp))
+      return FILE_READ_FAILED;
+    lr->eof = true;
+  }
+
+  lr->end += n;
+  lr->reader->pos += (int64_t)n;
+
+  return OK;
+}
+
+bool line_reader_next(line_reader *lr, string_view *line, easy_error *err) {
+  if (!lr || !line) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return false;
+  }
+
+  size_t scanned = lr->start; // Data before it doesn't contain '\n'
+  size_t line_end;
+  for (;;) {
+    const char *nl = (const char *)memchr(lr->buffer + scanned, '\n', lr->end - scanned);
+    if (nl) {
+      line_end = (size_t)(nl - lr->buffer);
+      break;
+    }
+
+    if (lr->eof) {
+      if (lr->start == lr->end) {
+        SET_CODE_ERROR(err, OK);
+        return false;
+      }
+      line_end = lr->end; // Last line without '\n'
+      break;
+    }
+
+    scanned = lr->end - lr->start;
+    easy_error e = line_reader_fill(lr);
+    if (e != OK) {
+      SET_CODE_ERROR(err, e);
+      return false;
+    }
+  }
+
+  size_t length = line_end - lr->start;
+  if (lr->strip_cr && length > 0 && lr->buffer[line_end - 1] == '\r')
+    length--;
+
+  line->data = lr->buffer + lr->start;
+  line->length = length;
+  lr->start = (line_end < lr->end) ? line_end + 1 : line_end;
+  lr->line_number++;
+
+  SET_CODE_ERROR(err, OK);
+  return true;
 }
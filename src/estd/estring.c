@@ -1,9 +1,14 @@
+#include <float.h>
+#include <locale.h>
+#include <math.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "estd/estring.h"
 #include "estd/global.h"
+#include "pow5_table.h"
 
 static int *bad_char_table(const char *F) {
   if (!F)
@@ -52,6 +57,106 @@ int boyer_moore_search(const char *T, const char *F) {
   return pos;
 }
 
+ptrdiff_t boyer_moore_search_n(const char *T, size_t n, const char *F, size_t m) {
+  if (!T || !F)
+    return NULL_POINTER;
+
+  if (m == 0)
+    return 0;
+  if (m > n)
+    return -1;
+  if (m == 1) {
+    const char *hit = (const char *)memchr(T, F[0], n);
+    return hit ? hit - T : -1;
+  }
+
+  // Horspool variant of bad character rule: shift by distance of last occurrence from the end
+  size_t shift[256];
+  for (size_t i = 0; i < 256; i++)
+    shift[i] = m;
+  for (size_t i = 0; i < m - 1; i++)
+    shift[(unsigned char)F[i]] = m - 1 - i;
+
+  const unsigned char last = (unsigned char)F[m - 1];
+  size_t s = 0;
+  while (s <= n - m) {
+    unsigned char ch = (unsigned char)T[s + m - 1];
+    if (ch == last && memcmp(T + s, F, m - 1) == 0)
+      return (ptrdiff_t)s;
+    s += shift[ch];
+  }
+
+  return -1;
+}
+
+/// Same as boyer_moore_search_n, but scans from the end of T and returns last position
+static ptrdiff_t boyer_moore_rsearch_n(const char *T, size_t n, const char *F, size_t m) {
+  if (m == 0)
+    return (ptrdiff_t)n;
+  if (m > n)
+    return -1;
+
+  size_t shift[256];
+  for (size_t i = 0; i < 256; i++)
+    shift[i] = m;
+  for (size_t i = m - 1; i > 0; i--)
+    shift[(unsigned char)F[i]] = i;
+
+  const unsigned char first = (unsigned char)F[0];
+  size_t s = n - m;
+  for (;;) {
+    unsigned char ch = (unsigned char)T[s];
+    if (ch == first && memcmp(T + s + 1, F + 1, m - 1) == 0)
+      return (ptrdiff_t)s;
+    if (s < shift[ch])
+      break;
+    s -= shift[ch];
+  }
+
+  return -1;
+}
+
+uint64_t hash_bytes(const char *data, size_t length) {
+  uint64_t h = 0x9E3779B97F4A7C15ULL ^ length;
+
+  // Two independent lanes, so multiplications of neighbour words overlap
+  uint64_t h2 = 0xC2B2AE3D27D4EB4FULL;
+  while (length >= 16) {
+    uint64_t w1, w2;
+    memcpy(&w1, data, 8);
+    memcpy(&w2, data + 8, 8);
+    h = (h ^ w1) * 0xBF58476D1CE4E5B9ULL;
+    h2 = (h2 ^ w2) * 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    h2 ^= h2 >> 29;
+    data += 16;
+    length -= 16;
+  }
+
+  if (length >= 8) {
+    uint64_t w;
+    memcpy(&w, data, 8);
+    h = (h ^ w) * 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 31;
+    data += 8;
+    length -= 8;
+  }
+
+  if (length > 0) {
+    uint64_t w = 0;
+    memcpy(&w, data, length);
+    h = (h ^ w) * 0xBF58476D1CE4E5B9ULL;
+  }
+
+  h ^= h2 + (h >> 32);
+  h *= 0x94D049BB133111EBULL;
+  h ^= h >> 29;
+  h *= 0xBF58476D1CE4E5B9ULL;
+  h ^= h >> 32;
+
+  return h ? h : 1;
+}
+
 string *string_init_empty() {
   string *str = (string *)malloc(sizeof(string));
   if (!str)
@@ -59,6 +164,7 @@ string *string_init_empty() {
 
   str->capacity = 16;
   str->length = 0;
+  string_invalidate_hash(str);
   str->data = (char *)malloc(str->capacity);
   if (!str->data) {
     free(str);
@@ -81,6 +187,7 @@ string *string_from_cstr(const char *cstr) {
   size_t len = strlen(cstr);
   str->length = len;
   str->capacity = len + 1;
+  string_invalidate_hash(str);
   str->data = (char *)malloc(str->capacity);
   if (!str->data) {
     free(str);
@@ -142,8 +249,16 @@ easy_error string_append(string *str, const char *cstr) {
   if (!cstr)
     return INVALID_ARGUMENT;
 
-  size_t cstr_len = strlen(cstr);
-  size_t new_length = str->length + cstr_len;
+  return string_append_n(str, cstr, strlen(cstr));
+}
+
+easy_error string_append_n(string *str, const char *data, size_t n) {
+  CHECK_NULL_PTR((str && str->data));
+
+  if (!data && n > 0)
+    return INVALID_ARGUMENT;
+
+  size_t new_length = str->length + n;
 
   if (new_length + 1 > str->capacity) {
     size_t new_capacity = (new_length + 1) * 2;
@@ -153,8 +268,11 @@ easy_error string_append(string *str, const char *cstr) {
       return err;
   }
 
-  memcpy(str->data + str->length, cstr, cstr_len + 1);
+  if (n > 0)
+    memcpy(str->data + str->length, data, n);
+  str->data[new_length] = '\0';
   str->length = new_length;
+  string_invalidate_hash(str);
 
   return OK;
 }
@@ -172,6 +290,794 @@ easy_error string_appendc(string *str, const char ch) {
   str->data[str->length] = ch;
   str->length++;
   str->data[str->length] = '\0';
+  string_invalidate_hash(str);
+
+  return OK;
+}
+
+easy_error string_appendf(string *str, const char *format, ...) {
+  CHECK_NULL_PTR((str && str->data));
+
+  if (!format)
+    return INVALID_ARGUMENT;
+
+  va_list args, args_copy;
+  va_start(args, format);
+  va_copy(args_copy, args);
+
+  // Try to format into free capacity first
+  size_t spare = str->capacity - str->length;
+  int result = vsnprintf(str->data + str->length, spare, format, args);
+  va_end(args);
+
+  if (result < 0) {
+    va_end(args_copy);
+    str->data[str->length] = '\0';
+    return INVALID_ARGUMENT;
+  }
+
+  if ((size_t)result >= spare) {
+    size_t new_length = str->length + (size_t)result;
+    easy_error err = string_reserve(str, (new_length + 1) * 2);
+    if (err != OK) {
+      va_end(args_copy);
+      str->data[str->length] = '\0';
+      return err;
+    }
+
+    vsnprintf(str->data + str->length, (size_t)result + 1, format, args_copy);
+  }
+  va_end(args_copy);
+
+  str->length += (size_t)result;
+  string_invalidate_hash(str);
+
+  return OK;
+}
+
+static const char digits_lut[200] = {
+    '0', '0', '0', '1', '0', '2', '0', '3', '0', '4', '0', '5', '0', '6', '0', '7', '0', '8', '0',
+    '9', '1', '0', '1', '1', '1', '2', '1', '3', '1', '4', '1', '5', '1', '6', '1', '7', '1', '8',
+    '1', '9', '2', '0', '2', '1', '2', '2', '2', '3', '2', '4', '2', '5', '2', '6', '2', '7', '2',
+    '8', '2', '9', '3', '0', '3', '1', '3', '2', '3', '3', '3', '4', '3', '5', '3', '6', '3', '7',
+    '3', '8', '3', '9', '4', '0', '4', '1', '4', '2', '4', '3', '4', '4', '4', '5', '4', '6', '4',
+    '7', '4', '8', '4', '9', '5', '0', '5', '1', '5', '2', '5', '3', '5', '4', '5', '5', '5', '6',
+    '5', '7', '5', '8', '5', '9', '6', '0', '6', '1', '6', '2', '6', '3', '6', '4', '6', '5', '6',
+    '6', '6', '7', '6', '8', '6', '9', '7', '0', '7', '1', '7', '2', '7', '3', '7', '4', '7', '5',
+    '7', '6', '7', '7', '7', '8', '7', '9', '8', '0', '8', '1', '8', '2', '8', '3', '8', '4', '8',
+    '5', '8', '6', '8', '7', '8', '8', '8', '9', '9', '0', '9', '1', '9', '2', '9', '3', '9', '4',
+    '9', '5', '9', '6', '9', '7', '9', '8', '9', '9'};
+
+/// Write decimal digits of value so the last digit is at end[-1]. Returns count of digits
+static size_t u64_to_digits(uint64_t value, char *end) {
+  char *p = end;
+  while (value >= 100) {
+    size_t i = (size_t)(value % 100) * 2;
+    value /= 100;
+    *--p = digits_lut[i + 1];
+    *--p = digits_lut[i];
+  }
+
+  if (value >= 10) {
+    size_t i = (size_t)value * 2;
+    *--p = digits_lut[i + 1];
+    *--p = digits_lut[i];
+  } else {
+    *--p = (char)('0' + value);
+  }
+
+  return (size_t)(end - p);
+}
+
+easy_error string_append_u64(string *str, uint64_t value) {
+  char buffer[20];
+  size_t len = u64_to_digits(value, buffer + sizeof(buffer));
+
+  return string_append_n(str, buffer + sizeof(buffer) - len, len);
+}
+
+easy_error string_append_i64(string *str, int64_t value) {
+  char buffer[21];
+  uint64_t abs_value = (value < 0) ? 0 - (uint64_t)value : (uint64_t)value;
+  size_t len = u64_to_digits(abs_value, buffer + sizeof(buffer));
+  if (value < 0)
+    buffer[sizeof(buffer) - ++len] = '-';
+
+  return string_append_n(str, buffer + sizeof(buffer) - len, len);
+}
+
+easy_error string_append_hex(string *str, uint64_t value) {
+  static const char *const lut = "0123456789abcdef";
+  char buffer[16];
+  char *p = buffer + sizeof(buffer);
+
+  do {
+    *--p = lut[value & 15];
+    value >>= 4;
+  } while (value);
+
+  return string_append_n(str, p, (size_t)(buffer + sizeof(buffer) - p));
+}
+
+/*
+Shortest round-trip formatting of doubles. It's the Ryu algorithm by Ulf Adams:
+https://github.com/ulfjack/ryu
+Multipliers are taken from pow5_table instead of own Ryu tables
+*/
+
+#define DOUBLE_MANTISSA_BITS 52
+#define DOUBLE_EXPONENT_BITS 11
+#define DOUBLE_BIAS 1023
+#define DOUBLE_POW5_INV_BITCOUNT 125
+#define DOUBLE_POW5_BITCOUNT 125
+
+/// 64x64->128 bit multiplication. Returns low part, high part is stored into *high
+static inline uint64_t umul128(uint64_t a, uint64_t b, uint64_t *high) {
+#ifdef __SIZEOF_INT128__
+  __extension__ unsigned __int128 r = (unsigned __int128)a * b;
+  *high = (uint64_t)(r >> 64);
+  return (uint64_t)r;
+#else
+  uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+  uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+  uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+  uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+  *high = hi_hi + (hi_lo >> 32) + (cross >> 32);
+  return (cross << 32) | (uint32_t)lo_lo;
+#endif
+}
+
+static inline uint32_t pow5bits(int32_t e) { return (uint32_t)(((uint32_t)e * 1217359) >> 19) + 1; }
+static inline uint32_t log10_pow2(int32_t e) { return ((uint32_t)e * 78913) >> 18; }
+static inline uint32_t log10_pow5(int32_t e) { return ((uint32_t)e * 732923) >> 20; }
+
+/// floor(5^i / 2^(pow5bits(i) - 125)) as {low, high}
+static inline void ryu_pow5(uint32_t i, uint64_t out[2]) {
+  const uint64_t *v = pow5_table[(int32_t)i - POW5_TABLE_MIN];
+  out[0] = (v[1] >> 3) | (v[0] << 61);
+  out[1] = v[0] >> 3;
+}
+
+/// floor(2^(pow5bits(q) - 1 + 125) / 5^q) + 1 as {low, high}
+static inline void ryu_pow5_inv(uint32_t q, uint64_t out[2]) {
+  if (q == 0) {
+    out[0] = 1;
+    out[1] = (uint64_t)1 << 61;
+    return;
+  }
+
+  const uint64_t *v = pow5_table[-(int32_t)q - POW5_TABLE_MIN];
+  uint64_t hi = v[0], lo = v[1];
+  if (q <= 27) { // Table keeps rounded up values for them
+    hi -= (lo == 0);
+    lo -= 1;
+  }
+
+  lo = (lo >> 3) | (hi << 61);
+  hi >>= 3;
+  lo += 1;
+  hi += (lo == 0);
+  out[0] = lo;
+  out[1] = hi;
+}
+
+static inline uint64_t mul_shift64(uint64_t m, const uint64_t mul[2], int32_t j) {
+  uint64_t high0, high1;
+  umul128(m, mul[0], &high0);
+  uint64_t low1 = umul128(m, mul[1], &high1);
+  uint64_t sum = high0 + low1;
+  if (sum < high0)
+    ++high1;
+
+  uint32_t dist = (uint32_t)(j - 64);
+  return (high1 << (64 - dist)) | (sum >> dist);
+}
+
+static inline uint32_t pow5_factor(uint64_t value) {
+  uint32_t count = 0;
+  while (value % 5 == 0) {
+    value /= 5;
+    ++count;
+  }
+
+  return count;
+}
+
+static inline bool multiple_of_pow5(uint64_t value, uint32_t p) { return pow5_factor(value) >= p; }
+static inline bool multiple_of_pow2(uint64_t value, uint32_t p) {
+  return (value & (((uint64_t)1 << p) - 1)) == 0;
+}
+
+static inline uint32_t decimal_length17(uint64_t v) {
+  uint32_t len = 1;
+  while (v >= 10) {
+    v /= 10;
+    len++;
+  }
+
+  return len;
+}
+
+/// Shortest decimal representation of finite positive double: *output * 10^*exponent
+static void ryu_d2d(uint64_t ieee_mantissa, uint32_t ieee_exponent, uint64_t *output,
+                    int32_t *exponent) {
+  int32_t e2;
+  uint64_t m2;
+  if (ieee_exponent == 0) {
+    e2 = 1 - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS - 2;
+    m2 = ieee_mantissa;
+  } else {
+    e2 = (int32_t)ieee_exponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS - 2;
+    m2 = ((uint64_t)1 << DOUBLE_MANTISSA_BITS) | ieee_mantissa;
+  }
+  const bool even = (m2 & 1) == 0;
+  const bool accept_bounds = even;
+
+  // Step 2: Determine the interval of valid decimal representations
+  const uint64_t mv = 4 * m2;
+  const uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+  // Step 3: Convert to a decimal power base using 128-bit arithmetic
+  uint64_t vr, vp, vm;
+  int32_t e10;
+  bool vm_is_trailing_zeros = false;
+  bool vr_is_trailing_zeros = false;
+  uint64_t mul[2];
+  if (e2 >= 0) {
+    const uint32_t q = log10_pow2(e2) - (e2 > 3);
+    e10 = (int32_t)q;
+    const int32_t k = DOUBLE_POW5_INV_BITCOUNT + (int32_t)pow5bits((int32_t)q) - 1;
+    const int32_t i = -e2 + (int32_t)q + k;
+    ryu_pow5_inv(q, mul);
+    vr = mul_shift64(4 * m2, mul, i);
+    vp = mul_shift64(4 * m2 + 2, mul, i);
+    vm = mul_shift64(4 * m2 - 1 - mm_shift, mul, i);
+    if (q <= 21) {
+      // Only one of mp, mv, and mm can be a multiple of 5, if any
+      const uint32_t mv_mod5 = (uint32_t)(mv % 5);
+      if (mv_mod5 == 0)
+        vr_is_trailing_zeros = multiple_of_pow5(mv, q);
+      else if (accept_bounds)
+        vm_is_trailing_zeros = multiple_of_pow5(mv - 1 - mm_shift, q);
+      else
+        vp -= multiple_of_pow5(mv + 2, q);
+    }
+  } else {
+    const uint32_t q = log10_pow5(-e2) - (-e2 > 1);
+    e10 = (int32_t)q + e2;
+    const int32_t i = -e2 - (int32_t)q;
+    const int32_t k = (int32_t)pow5bits(i) - DOUBLE_POW5_BITCOUNT;
+    const int32_t j = (int32_t)q - k;
+    ryu_pow5((uint32_t)i, mul);
+    vr = mul_shift64(4 * m2, mul, j);
+    vp = mul_shift64(4 * m2 + 2, mul, j);
+    vm = mul_shift64(4 * m2 - 1 - mm_shift, mul, j);
+    if (q <= 1) {
+      // {vr,vp,vm} is trailing zeros if {mv,mp,mm} has at least q trailing 0 bits
+      vr_is_trailing_zeros = true;
+      if (accept_bounds)
+        vm_is_trailing_zeros = mm_shift == 1;
+      else
+        --vp;
+    } else if (q < 63) {
+      vr_is_trailing_zeros = multiple_of_pow2(mv, q);
+    }
+  }
+
+  // Step 4: Find the shortest decimal representation in the interval of valid representations
+  int32_t removed = 0;
+  uint8_t last_removed_digit = 0;
+  uint64_t result;
+  if (vm_is_trailing_zeros || vr_is_trailing_zeros) {
+    // General case, which happens rarely (~0.7%)
+    while (vp / 10 > vm / 10) {
+      vm_is_trailing_zeros &= vm % 10 == 0;
+      vr_is_trailing_zeros &= last_removed_digit == 0;
+      last_removed_digit = (uint8_t)(vr % 10);
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+
+    if (vm_is_trailing_zeros) {
+      while (vm % 10 == 0) {
+        vr_is_trailing_zeros &= last_removed_digit == 0;
+        last_removed_digit = (uint8_t)(vr % 10);
+        vr /= 10;
+        vp /= 10;
+        vm /= 10;
+        ++removed;
+      }
+    }
+
+    if (vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0)
+      last_removed_digit = 4; // Round even if the exact number is .....50..0
+
+    result = vr + ((vr == vm && (!accept_bounds || !vm_is_trailing_zeros)) ||
+                   last_removed_digit >= 5);
+  } else {
+    // Specialized for the common case (~99.3%)
+    bool round_up = false;
+    while (vp / 10 > vm / 10) {
+      round_up = vr % 10 >= 5;
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+
+    result = vr + (vr == vm || round_up);
+  }
+
+  *output = result;
+  *exponent = e10 + removed;
+}
+
+/// Write shortest representation of value into out. Returns count of written chars
+static size_t f64_to_chars(double value, char *out) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(double));
+
+  const bool sign = (bits >> 63) != 0;
+  const uint64_t ieee_mantissa = bits & (((uint64_t)1 << DOUBLE_MANTISSA_BITS) - 1);
+  const uint32_t ieee_exponent =
+      (uint32_t)((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+
+  char *p = out;
+  if (ieee_exponent == (1u << DOUBLE_EXPONENT_BITS) - 1) {
+    if (ieee_mantissa) {
+      memcpy(p, "nan", 3);
+      return 3;
+    }
+    if (sign)
+      *p++ = '-';
+    memcpy(p, "inf", 3);
+    return (size_t)(p - out) + 3;
+  }
+
+  if (sign)
+    *p++ = '-';
+
+  if (ieee_exponent == 0 && ieee_mantissa == 0) {
+    *p++ = '0';
+    return (size_t)(p - out);
+  }
+
+  uint64_t output;
+  int32_t exponent;
+  ryu_d2d(ieee_mantissa, ieee_exponent, &output, &exponent);
+
+  char digits[20];
+  const int32_t olength = (int32_t)u64_to_digits(output, digits + sizeof(digits));
+  const char *d = digits + sizeof(digits) - olength;
+  const int32_t n = exponent + olength; // Position of decimal point
+
+  if (olength <= n && n <= 21) { // 1234500
+    memcpy(p, d, (size_t)olength);
+    p += olength;
+    memset(p, '0', (size_t)(n - olength));
+    p += n - olength;
+  } else if (0 < n && n <= 21) { // 123.45
+    memcpy(p, d, (size_t)n);
+    p += n;
+    *p++ = '.';
+    memcpy(p, d + n, (size_t)(olength - n));
+    p += olength - n;
+  } else if (-6 < n && n <= 0) { // 0.0012345
+    *p++ = '0';
+    *p++ = '.';
+    memset(p, '0', (size_t)-n);
+    p += -n;
+    memcpy(p, d, (size_t)olength);
+    p += olength;
+  } else { // 1.2345e+30
+    *p++ = d[0];
+    if (olength > 1) {
+      *p++ = '.';
+      memcpy(p, d + 1, (size_t)(olength - 1));
+      p += olength - 1;
+    }
+    *p++ = 'e';
+    *p++ = (n - 1 < 0) ? '-' : '+';
+    uint32_t e = (uint32_t)((n - 1 < 0) ? 1 - n : n - 1);
+    p += u64_to_digits(e, p + decimal_length17(e));
+  }
+
+  return (size_t)(p - out);
+}
+
+easy_error string_append_f64(string *str, double value) {
+  char buffer[32];
+  size_t len = f64_to_chars(value, buffer);
+
+  return string_append_n(str, buffer, len);
+}
+
+#define is_digit(ch) ((unsigned char)((ch) - '0') < 10)
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ ||                      \
+    defined(_M_X64) || defined(_M_IX86) || defined(_M_ARM64)
+#define SWAR_DIGITS 1
+#endif
+
+#ifdef SWAR_DIGITS
+/// Check that 8 bytes loaded in little endian order are all digits
+static inline bool is_eight_digits(uint64_t v) {
+  return ((v & 0xF0F0F0F0F0F0F0F0) | (((v + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+         0x3333333333333333;
+}
+
+/// Convert 8 digits to number with 3 multiplications instead of 8
+static inline uint32_t parse_eight_digits(uint64_t v) {
+  const uint64_t mask = 0x000000FF000000FF;
+  const uint64_t mul1 = 0x000F424000000064; // 100 + (1000000 << 32)
+  const uint64_t mul2 = 0x0000271000000001; // 1 + (10000 << 32)
+  v -= 0x3030303030303030;
+  v = (v * 10) + (v >> 8);
+  v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+
+  return (uint32_t)v;
+}
+#endif
+
+/// Parse digits from p until end into *value. Returns pointer to first not digit char
+static const char *parse_digits_u64(const char *p, const char *end, uint64_t *value,
+                                    bool *overflow) {
+  const char *start = p;
+  uint64_t v = 0;
+  *overflow = false;
+
+#ifdef SWAR_DIGITS
+  // Up to 19 digits always fit into uint64_t
+  while (end - p >= 8 && p - start <= 11) {
+    uint64_t chunk;
+    memcpy(&chunk, p, sizeof(chunk));
+    if (!is_eight_digits(chunk))
+      break;
+    v = v * 100000000 + parse_eight_digits(chunk);
+    p += 8;
+  }
+#endif
+
+  for (; p < end && is_digit(*p); p++) {
+    uint64_t d = (uint64_t)(*p - '0');
+    if (*overflow || v > (UINT64_MAX - d) / 10)
+      *overflow = true;
+    else
+      v = v * 10 + d;
+  }
+
+  *value = v;
+  return p;
+}
+
+easy_error string_to_u64(const char *data, size_t length, uint64_t *out, size_t *consumed) {
+  if ((!data && length > 0) || !out)
+    return INVALID_ARGUMENT;
+
+  const char *p = data, *end = data + length;
+  if (p < end && *p == '+')
+    p++;
+
+  if (p == end || !is_digit(*p)) {
+    if (consumed)
+      *consumed = 0;
+    return NUMBER_INVALID;
+  }
+
+  bool overflow;
+  p = parse_digits_u64(p, end, out, &overflow);
+  if (consumed)
+    *consumed = (size_t)(p - data);
+
+  if (overflow) {
+    *out = UINT64_MAX;
+    return NUMBER_OUT_OF_RANGE;
+  }
+
+  return OK;
+}
+
+easy_error string_to_i64(const char *data, size_t length, int64_t *out, size_t *consumed) {
+  if ((!data && length > 0) || !out)
+    return INVALID_ARGUMENT;
+
+  const char *p = data, *end = data + length;
+  bool negative = false;
+  if (p < end && (*p == '+' || *p == '-'))
+    negative = (*p++ == '-');
+
+  if (p == end || !is_digit(*p)) {
+    if (consumed)
+      *consumed = 0;
+    return NUMBER_INVALID;
+  }
+
+  uint64_t value;
+  bool overflow;
+  p = parse_digits_u64(p, end, &value, &overflow);
+  if (consumed)
+    *consumed = (size_t)(p - data);
+
+  const uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+  if (overflow || value > limit) {
+    *out = negative ? INT64_MIN : INT64_MAX;
+    return NUMBER_OUT_OF_RANGE;
+  }
+
+  *out = negative ? (int64_t)(0 - value) : (int64_t)value;
+  return OK;
+}
+
+/*
+Conversion of decimal w * 10^q into double. It's the Eisel-Lemire algorithm, the same as in
+fast_float library: https://github.com/fastfloat/fast_float
+*/
+
+#define MAX_MANTISSA_DIGITS 19
+#define MIN_EXPONENT_ROUND_TO_EVEN (-4)
+#define MAX_EXPONENT_ROUND_TO_EVEN 23
+
+static inline int clz64(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_clzll(v);
+#else
+  int n = 0;
+  while (!(v & ((uint64_t)1 << 63))) {
+    v <<= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+/// Convert w * 10^q into bits of positive double. Returns false if result may be not exact
+static bool eisel_lemire(uint64_t w, int64_t q, uint64_t *bits) {
+  if (w == 0 || q < POW5_TABLE_MIN) {
+    *bits = 0;
+    return true;
+  }
+  if (q > 308) {
+    *bits = (uint64_t)0x7FF << DOUBLE_MANTISSA_BITS; // inf
+    return true;
+  }
+
+  const int lz = clz64(w);
+  w <<= lz;
+
+  // Upper 64 bits of w * 5^q, low word is taken into account only if it can change them
+  const uint64_t *pow5 = pow5_table[q - POW5_TABLE_MIN];
+  const uint64_t precision_mask = UINT64_MAX >> (DOUBLE_MANTISSA_BITS + 3);
+  uint64_t high, low = umul128(w, pow5[0], &high);
+  if ((high & precision_mask) == precision_mask) {
+    uint64_t second_high;
+    umul128(w, pow5[1], &second_high);
+    low += second_high;
+    if (second_high > low)
+      high++;
+  }
+
+  // Lower bits of product are uncertain
+  const bool certain = !(low == UINT64_MAX && (q < -27 || q > 55));
+
+  const int upperbit = (int)(high >> 63);
+  const int shift = upperbit + 64 - DOUBLE_MANTISSA_BITS - 3;
+  uint64_t mantissa = high >> shift;
+  int32_t power2 =
+      (int32_t)(((152170 + 65536) * q) >> 16) + 63 + upperbit - lz - (1 - DOUBLE_BIAS - 1);
+
+  if (power2 <= 0) { // Subnormal
+    if (-power2 + 1 >= 64) {
+      *bits = 0;
+      return true;
+    }
+
+    mantissa >>= -power2 + 1;
+    mantissa += (mantissa & 1);
+    mantissa >>= 1;
+    power2 = (mantissa < ((uint64_t)1 << DOUBLE_MANTISSA_BITS)) ? 0 : 1;
+    *bits = mantissa | ((uint64_t)power2 << DOUBLE_MANTISSA_BITS);
+    return certain;
+  }
+
+  // Exact halfway case: round to even instead of up
+  if (low <= 1 && q >= MIN_EXPONENT_ROUND_TO_EVEN && q <= MAX_EXPONENT_ROUND_TO_EVEN &&
+      (mantissa & 3) == 1 && (mantissa << shift) == high)
+    mantissa &= ~(uint64_t)1;
+
+  mantissa += (mantissa & 1);
+  mantissa >>= 1;
+  if (mantissa >= ((uint64_t)2 << DOUBLE_MANTISSA_BITS)) {
+    mantissa = (uint64_t)1 << DOUBLE_MANTISSA_BITS;
+    power2++;
+  }
+  mantissa &= ~((uint64_t)1 << DOUBLE_MANTISSA_BITS);
+
+  if (power2 >= 0x7FF) {
+    *bits = (uint64_t)0x7FF << DOUBLE_MANTISSA_BITS;
+    return true;
+  }
+
+  *bits = mantissa | ((uint64_t)power2 << DOUBLE_MANTISSA_BITS);
+  return certain;
+}
+
+/// Slow path for rare ambiguous cases. Uses strtod with decimal point of current locale
+/// @note If there is no memory for copy of number, approx is returned
+static double parse_f64_fallback(const char *start, const char *end, double approx) {
+  char stack_buffer[128];
+  size_t len = (size_t)(end - start);
+  const char *point = localeconv()->decimal_point;
+  size_t point_len = strlen(point);
+
+  char *buffer = stack_buffer;
+  if (len + point_len + 1 > sizeof(stack_buffer)) {
+    buffer = (char *)malloc(len + point_len + 1);
+    if (!buffer)
+      return approx;
+  }
+
+  char *dst = buffer;
+  for (const char *p = start; p < end; p++) {
+    if (*p == '.') {
+      memcpy(dst, point, point_len);
+      dst += point_len;
+    } else {
+      *dst++ = *p;
+    }
+  }
+  *dst = '\0';
+
+  double value = strtod(buffer, NULL);
+  if (buffer != stack_buffer)
+    free(buffer);
+
+  return value;
+}
+
+static const char *match_word(const char *p, const char *end, const char *word) {
+  for (; *word; word++, p++) {
+    if (p == end || (*p | 0x20) != *word)
+      return NULL;
+  }
+
+  return p;
+}
+
+static const double exact_pow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                     1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                     1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+easy_error string_to_f64(const char *data, size_t length, double *out, size_t *consumed) {
+  if ((!data && length > 0) || !out)
+    return INVALID_ARGUMENT;
+
+  const char *p = data, *end = data + length;
+  bool negative = false;
+  if (p < end && (*p == '+' || *p == '-'))
+    negative = (*p++ == '-');
+
+  // Special values
+  if (p < end && !is_digit(*p) && *p != '.') {
+    const char *word_end = NULL;
+    double value = 0;
+    if ((word_end = match_word(p, end, "inf"))) {
+      const char *long_end = match_word(word_end, end, "inity");
+      word_end = long_end ? long_end : word_end;
+      value = HUGE_VAL;
+    } else if ((word_end = match_word(p, end, "nan"))) {
+      value = NAN;
+    }
+
+    if (!word_end) {
+      *out = 0;
+      if (consumed)
+        *consumed = 0;
+      return NUMBER_INVALID;
+    }
+
+    *out = negative ? -value : value;
+    if (consumed)
+      *consumed = (size_t)(word_end - data);
+    return OK;
+  }
+
+  // Mantissa keeps up to 19 significant digits, the rest only moves exponent
+  const char *digits_start = p;
+  uint64_t mantissa = 0;
+  int64_t exponent = 0;
+  int sig_digits = 0;
+  bool truncated = false, has_digits = false;
+
+  for (int fraction = 0; fraction < 2; fraction++) {
+#ifdef SWAR_DIGITS
+    while (end - p >= 8 && sig_digits <= MAX_MANTISSA_DIGITS - 8) {
+      uint64_t chunk;
+      memcpy(&chunk, p, sizeof(chunk));
+      if (!is_eight_digits(chunk))
+        break;
+
+      uint64_t prev = mantissa;
+      mantissa = mantissa * 100000000 + parse_eight_digits(chunk);
+      sig_digits = prev ? sig_digits + 8 : (mantissa ? (int)decimal_length17(mantissa) : 0);
+      exponent -= fraction * 8;
+      has_digits = true;
+      p += 8;
+    }
+#endif
+
+    for (; p < end && is_digit(*p); p++) {
+      has_digits = true;
+      if (sig_digits < MAX_MANTISSA_DIGITS) {
+        mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+        sig_digits += (mantissa != 0);
+        exponent -= fraction;
+      } else {
+        truncated |= (*p != '0');
+        exponent += !fraction;
+      }
+    }
+
+    if (fraction || p == end || *p != '.')
+      break;
+    p++; // Skip decimal point
+  }
+
+  if (!has_digits) {
+    *out = 0;
+    if (consumed)
+      *consumed = 0;
+    return NUMBER_INVALID;
+  }
+
+  // Exponent part is consumed only if it has digits
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    const char *e = p + 1;
+    bool exp_negative = false;
+    if (e < end && (*e == '+' || *e == '-'))
+      exp_negative = (*e++ == '-');
+
+    if (e < end && is_digit(*e)) {
+      int64_t exp_value = 0;
+      for (; e < end && is_digit(*e); e++) {
+        if (exp_value < 0x10000000)
+          exp_value = exp_value * 10 + (*e - '0');
+      }
+      exponent += exp_negative ? -exp_value : exp_value;
+      p = e;
+    }
+  }
+
+  if (consumed)
+    *consumed = (size_t)(p - data);
+
+  double value;
+  uint64_t bits;
+#if FLT_EVAL_METHOD == 0
+  // Both mantissa and power of ten are exact doubles, so single operation is correctly rounded
+  if (!truncated && mantissa <= ((uint64_t)1 << 53) && exponent >= -22 && exponent <= 22) {
+    value = (double)mantissa;
+    value = (exponent < 0) ? value / exact_pow10[-exponent] : value * exact_pow10[exponent];
+    *out = negative ? -value : value;
+    return OK;
+  }
+#endif
+
+  bool exact = eisel_lemire(mantissa, exponent, &bits);
+  if (exact && truncated) {
+    // Real mantissa is between mantissa and mantissa + 1
+    uint64_t upper_bits;
+    exact = eisel_lemire(mantissa + 1, exponent, &upper_bits) && upper_bits == bits;
+  }
+
+  memcpy(&value, &bits, sizeof(double));
+  if (!exact)
+    value = parse_f64_fallback(digits_start, p, value);
+
+  *out = negative ? -value : value;
+  if (value == HUGE_VAL)
+    return NUMBER_OUT_OF_RANGE;
 
   return OK;
 }
@@ -194,12 +1100,78 @@ char string_at(const string *str, size_t index, easy_error *err) {
 
 const char *string_cstr(const string *str) { return (str && str->data) ? str->data : NULL; }
 
-int string_find(const string *str, const char *fragment) {
+string_view string_as_view(const string *str) {
+  if (!str || !str->data)
+    return (string_view){NULL, 0};
+
+  return (string_view){str->data, str->length};
+}
+
+string_view string_view_from_cstr(const char *cstr) {
+  if (!cstr)
+    return (string_view){NULL, 0};
+
+  return (string_view){cstr, strlen(cstr)};
+}
+
+ptrdiff_t string_find(const string *str, const char *fragment) {
+  return string_find_from(str, 0, fragment);
+}
+
+ptrdiff_t string_find_from(const string *str, size_t from, const char *fragment) {
   CHECK_NULL_PTR((str && str->data));
   if (!fragment)
     return INVALID_ARGUMENT;
 
-  return boyer_moore_search(string_cstr(str), fragment);
+  if (from > str->length)
+    return -1;
+
+  ptrdiff_t pos =
+      boyer_moore_search_n(str->data + from, str->length - from, fragment, strlen(fragment));
+
+  return (pos < 0) ? pos : pos + (ptrdiff_t)from;
+}
+
+ptrdiff_t string_rfind(const string *str, const char *fragment) {
+  CHECK_NULL_PTR((str && str->data));
+  if (!fragment)
+    return INVALID_ARGUMENT;
+
+  return boyer_moore_rsearch_n(str->data, str->length, fragment, strlen(fragment));
+}
+
+size_t string_find_all(const string *str, const char *fragment, size_t *out, size_t out_size,
+                       easy_error *err) {
+  if (!str || !str->data) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  if (!fragment || !fragment[0] || (!out && out_size > 0)) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return 0;
+  }
+
+  size_t m = strlen(fragment);
+  size_t found = 0;
+  size_t from = 0;
+  while (from + m <= str->length) {
+    ptrdiff_t pos = boyer_moore_search_n(str->data + from, str->length - from, fragment, m);
+    if (pos < 0)
+      break;
+
+    if (found < out_size)
+      out[found] = from + (size_t)pos;
+    found++;
+    from += (size_t)pos + m; // Matches don't overlap
+  }
+
+  SET_CODE_ERROR(err, OK);
+  return found;
+}
+
+size_t string_count(const string *str, const char *fragment, easy_error *err) {
+  return string_find_all(str, fragment, NULL, 0, err);
 }
 
 int string_compare(const void *str1, const void *str2) {
@@ -223,7 +1195,36 @@ bool string_compare_bool(const string *str1, const string *str2, easy_error *err
 
   SET_CODE_ERROR(err, OK);
 
-  return strcmp(str1->data, str2->data) == 0;
+  return string_equal(str1, str2);
+}
+
+bool string_equal(const string *str1, const string *str2) {
+  if (!str1 || !str1->data || !str2 || !str2->data)
+    return false;
+
+  if (str1->length != str2->length)
+    return false;
+
+  uint64_t hash1 = string_hash_load(str1->hash), hash2 = string_hash_load(str2->hash);
+  if (hash1 && hash2 && hash1 != hash2)
+    return false;
+
+  return memcmp(str1->data, str2->data, str1->length) == 0;
+}
+
+uint64_t string_hash(const string *str) {
+  if (!str || !str->data)
+    return 0;
+
+  // Cache is not a part of string value, so it's updated even for const string. Threads racing
+  // here compute same value, relaxed atomics are enough
+  uint64_t hash = string_hash_load(str->hash);
+  if (!hash) {
+    hash = hash_bytes(str->data, str->length);
+    string_hash_store(((string *)str)->hash, hash);
+  }
+
+  return hash;
 }
 
 easy_error string_insert(string *str, size_t pos, const char *cstr) {
@@ -249,6 +1250,7 @@ easy_error string_insert(string *str, size_t pos, const char *cstr) {
   memmove(str->data + pos + cstr_len, str->data + pos, str->length - pos + 1);
   memcpy(str->data + pos, cstr, cstr_len);
   str->length = new_length;
+  string_invalidate_hash(str);
 
   return OK;
 }
@@ -263,6 +1265,7 @@ easy_error string_clear(string *str) {
   new_data[0] = '\0';
   str->length = 0;
   str->capacity = 1;
+  string_invalidate_hash(str);
   str->data = new_data;
 
   return OK;
@@ -0,0 +1,322 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "estd/global.h"
+#include "estd/intern.h"
+
+struct intern_block {
+  intern_block *next;
+  size_t used;
+  size_t capacity;
+  char data[];
+};
+
+struct intern_entry {
+  const char *data;
+  size_t length;
+};
+
+// Slot keeps hash of string, so most of mismatches are rejected without touching entries
+struct intern_slot {
+  atom a; // ATOM_NONE for empty slot
+  uint32_t hash;
+};
+
+#define INTERN_MIN_SLOTS 16
+#define INTERN_MAX_COUNT ((size_t)UINT32_MAX - 1)
+
+// Index needs only 32 bits, so both halves of 64-bit hash are folded into them
+static uint32_t intern_hash(const char *data, size_t length) {
+  uint64_t h = hash_bytes(data, length);
+
+  return (uint32_t)(h ^ (h >> 32));
+}
+
+static intern_block *intern_block_init(size_t capacity) {
+  intern_block *block = (intern_block *)malloc(sizeof(intern_block) + capacity);
+  if (!block)
+    return NULL;
+
+  block->next = NULL;
+  block->used = 0;
+  block->capacity = capacity;
+
+  return block;
+}
+
+// Copy data into arena as null-terminated string
+static const char *intern_store(intern_table *table, const char *data, size_t length) {
+  size_t need = length + 1;
+  intern_block *block = table->blocks;
+
+  if (!block || block->capacity - block->used < need) {
+    if (need > INTERN_BLOCK_SIZE / 4) {
+      // Big strings get own block, current block is kept for small ones
+      intern_block *big = intern_block_init(need);
+      if (!big)
+        return NULL;
+
+      if (block) {
+        big->next = block->next;
+        block->next = big;
+      } else
+        table->blocks = big;
+
+      block = big;
+    } else {
+      block = intern_block_init(INTERN_BLOCK_SIZE);
+      if (!block)
+        return NULL;
+
+      block->next = table->blocks;
+      table->blocks = block;
+    }
+  }
+
+  char *dst = block->data + block->used;
+  if (length > 0)
+    memcpy(dst, data, length);
+  dst[length] = '\0';
+  block->used += need;
+
+  return dst;
+}
+
+static size_t intern_slots_for(size_t count) {
+  size_t capacity = INTERN_MIN_SLOTS;
+  // Keep load factor below 1/2
+  while (capacity / 2 < count)
+    capacity *= 2;
+
+  return capacity;
+}
+
+static easy_error intern_rehash(intern_table *table, size_t new_capacity) {
+  intern_slot *slots = (intern_slot *)calloc(new_capacity, sizeof(intern_slot));
+  CHECK_ALLOCATION(slots);
+
+  size_t mask = new_capacity - 1;
+  for (size_t i = 0; i < table->slots_capacity; i++) {
+    intern_slot slot = table->slots[i];
+    if (slot.a == ATOM_NONE)
+      continue;
+
+    size_t index = slot.hash & mask;
+    while (slots[index].a != ATOM_NONE)
+      index = (index + 1) & mask;
+    slots[index] = slot;
+  }
+
+  free(table->slots);
+  table->slots = slots;
+  table->slots_capacity = new_capacity;
+
+  return OK;
+}
+
+// Make room for extra new strings
+static easy_error intern_reserve(intern_table *table, size_t extra) {
+  if (extra > INTERN_MAX_COUNT - table->count)
+    return INVALID_ARGUMENT;
+
+  size_t need = table->count + extra;
+
+  if (need > table->entries_capacity) {
+    size_t new_capacity = EMAX(need, table->entries_capacity * 2);
+    intern_entry *entries =
+        (intern_entry *)realloc(table->entries, new_capacity * sizeof(intern_entry));
+    CHECK_ALLOCATION(entries);
+
+    table->entries = entries;
+    table->entries_capacity = new_capacity;
+  }
+
+  if (need > table->slots_capacity / 2)
+    return intern_rehash(table, intern_slots_for(need));
+
+  return OK;
+}
+
+// Returns index of slot with data or index of empty slot where data should be placed
+static size_t intern_probe(const intern_table *table, const char *data, size_t length,
+                           uint32_t hash) {
+  size_t mask = table->slots_capacity - 1;
+  size_t index = hash & mask;
+
+  for (;;) {
+    intern_slot slot = table->slots[index];
+    if (slot.a == ATOM_NONE)
+      return index;
+
+    if (slot.hash == hash) {
+      const intern_entry *entry = &table->entries[slot.a - 1];
+      if (entry->length == length && (length == 0 || memcmp(entry->data, data, length) == 0))
+        return index;
+    }
+
+    index = (index + 1) & mask;
+  }
+}
+
+// Intern data, when there is guaranteed room for one more string
+static atom intern_insert(intern_table *table, const char *data, size_t length, uint32_t hash,
+                          easy_error *err) {
+  size_t index = intern_probe(table, data, length, hash);
+  if (table->slots[index].a != ATOM_NONE) {
+    SET_CODE_ERROR(err, OK);
+    return table->slots[index].a;
+  }
+
+  const char *stored = intern_store(table, data, length);
+  if (!stored) {
+    SET_CODE_ERROR(err, ALLOCATION_FAILED);
+    return ATOM_NONE;
+  }
+
+  table->entries[table->count].data = stored;
+  table->entries[table->count].length = length;
+  table->count++;
+
+  table->slots[index].a = (atom)table->count;
+  table->slots[index].hash = hash;
+
+  SET_CODE_ERROR(err, OK);
+  return (atom)table->count;
+}
+
+intern_table *intern_table_init(size_t initial_capacity) {
+  intern_table *table = (intern_table *)malloc(sizeof(intern_table));
+  if (!table)
+    return NULL;
+
+  table->blocks = NULL;
+  table->count = 0;
+  table->entries_capacity = 0;
+  table->entries = NULL;
+  table->slots_capacity = intern_slots_for(initial_capacity);
+  table->slots = (intern_slot *)calloc(table->slots_capacity, sizeof(intern_slot));
+  if (!table->slots) {
+    free(table);
+    return NULL;
+  }
+
+  if (initial_capacity > 0) {
+    table->entries = (intern_entry *)malloc(initial_capacity * sizeof(intern_entry));
+    if (!table->entries) {
+      free(table->slots);
+      free(table);
+      return NULL;
+    }
+    table->entries_capacity = initial_capacity;
+  }
+
+  return table;
+}
+
+void intern_table_free_(intern_table *table) {
+  intern_block *block = table->blocks;
+  while (block) {
+    intern_block *next = block->next;
+    free(block);
+    block = next;
+  }
+
+  free(table->entries);
+  free(table->slots);
+  free(table);
+}
+
+atom intern_add_n(intern_table *table, const char *data, size_t length, easy_error *err) {
+  if (!table || !table->slots) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return ATOM_NONE;
+  }
+
+  if (!data && length > 0) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return ATOM_NONE;
+  }
+
+  uint32_t hash = intern_hash(data, length);
+
+  // Lookup first, so interning of known string never grows table
+  size_t index = intern_probe(table, data, length, hash);
+  if (table->slots[index].a != ATOM_NONE) {
+    SET_CODE_ERROR(err, OK);
+    return table->slots[index].a;
+  }
+
+  easy_error e = intern_reserve(table, 1);
+  if (e != OK) {
+    SET_CODE_ERROR(err, e);
+    return ATOM_NONE;
+  }
+
+  return intern_insert(table, data, length, hash, err);
+}
+
+atom intern_add(intern_table *table, const char *cstr, easy_error *err) {
+  if (!cstr) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return ATOM_NONE;
+  }
+
+  return intern_add_n(table, cstr, strlen(cstr), err);
+}
+
+atom intern_add_string(intern_table *table, const string *str, easy_error *err) {
+  if (!str || !str->data) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return ATOM_NONE;
+  }
+
+  return intern_add_n(table, str->data, str->length, err);
+}
+
+easy_error intern_add_many(intern_table *table, const string_view *views, size_t count, atom *out) {
+  CHECK_NULL_PTR((table && table->slots));
+
+  if (count == 0)
+    return OK;
+
+  if (!views || !out)
+    return INVALID_ARGUMENT;
+
+  easy_error err = intern_reserve(table, count);
+  if (err != OK)
+    return err;
+
+  for (size_t i = 0; i < count; i++) {
+    if (!views[i].data && views[i].length > 0)
+      return INVALID_ARGUMENT;
+
+    uint32_t hash = intern_hash(views[i].data, views[i].length);
+    out[i] = intern_insert(table, views[i].data, views[i].length, hash, &err);
+    if (err != OK)
+      return err;
+  }
+
+  return OK;
+}
+
+atom intern_find(const intern_table *table, const char *data, size_t length) {
+  if (!table || !table->slots || (!data && length > 0))
+    return ATOM_NONE;
+
+  size_t index = intern_probe(table, data, length, intern_hash(data, length));
+
+  return table->slots[index].a;
+}
+
+string_view intern_view(const intern_table *table, atom a) {
+  string_view view = {NULL, 0};
+  if (!table || a == ATOM_NONE || a > table->count)
+    return view;
+
+  view.data = table->entries[a - 1].data;
+  view.length = table->entries[a - 1].length;
+
+  return view;
+}
+
+const char *intern_cstr(const intern_table *table, atom a) { return intern_view(table, a).data; }
@@ -0,0 +1,496 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // fileno
+#endif
+
+#include "estd/merkle.h"
+#include "workers.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#include <sys/stat.h>
+#define MERKLE_POSIX 1
+#endif
+
+#define LEAF_PREFIX 0x00
+#define NODE_PREFIX 0x01
+
+#ifdef MERKLE_POSIX
+#define job_lock(job) pthread_mutex_lock(&(job)->lock)
+#define job_unlock(job) pthread_mutex_unlock(&(job)->lock)
+#else
+#define job_lock(job) (void)(job)
+#define job_unlock(job) (void)(job)
+#endif
+
+/// Leaves are read from memory or from file
+typedef struct leaf_source {
+  const uint8_t *data; // NULL if leaves are read from reader
+  freader *reader;
+  uint64_t size;
+  size_t leaf_size;
+
+} leaf_source;
+
+/// Leaves [next, last) are taken by threads in batches
+typedef struct leaf_job {
+  const leaf_source *src;
+  size_t first;
+  size_t next;
+  size_t last;
+  size_t batch;                     // Count of leaves taken at once
+  uint8_t (*out)[SHA256_HASH_SIZE]; // Hash of leaf first + i is stored in out[i]
+  easy_error error;
+#ifdef MERKLE_POSIX
+  pthread_mutex_t lock;
+#endif
+
+} leaf_job;
+
+static easy_error hash_leaf(const leaf_source *src, size_t index, uint8_t *buffer,
+                            size_t buffer_size, uint8_t out[SHA256_HASH_SIZE]) {
+  uint64_t offset = (uint64_t)index * src->leaf_size;
+  uint64_t length = src->size - offset;
+  if (length > src->leaf_size)
+    length = src->leaf_size;
+
+  uint8_t prefix = LEAF_PREFIX;
+  sha256_buff buff;
+  sha256_init(&buff);
+  sha256_update(&buff, &prefix, 1);
+
+  if (src->data)
+    sha256_update(&buff, src->data + offset, (size_t)length);
+  else {
+    while (length > 0) {
+      size_t step = (length < buffer_size) ? (size_t)length : buffer_size;
+      easy_error e = OK;
+      size_t n = read_bytes_at(src->reader, offset, buffer, step, &e);
+      if (e != OK)
+        return e;
+      if (n != step) // File was truncated
+        return FILE_READ_FAILED;
+
+      sha256_update(&buff, buffer, n);
+      offset += n;
+      length -= n;
+    }
+  }
+
+  sha256_finalize(&buff);
+  sha256_read(&buff, out);
+  return OK;
+}
+
+static void *leaf_worker(void *arg) {
+  leaf_job *job = (leaf_job *)arg;
+
+  // Leaves of file are read by parts, so big leaves don't need big buffers
+  size_t buffer_size = job->src->leaf_size;
+  if (buffer_size > SHA256_FILE_BUFFER_SIZE)
+    buffer_size = SHA256_FILE_BUFFER_SIZE;
+  uint8_t *buffer = NULL;
+  easy_error e = OK;
+  if (!job->src->data) {
+    buffer = (uint8_t *)malloc(buffer_size);
+    if (!buffer)
+      e = ALLOCATION_FAILED;
+  }
+
+  while (e == OK) {
+    job_lock(job);
+    size_t first = job->next;
+    bool stop = job->error != OK || first >= job->last;
+    job->next = (job->last - first > job->batch) ? first + job->batch : job->last;
+    size_t last = job->next;
+    job_unlock(job);
+    if (stop)
+      break;
+
+    for (size_t i = first; i < last && e == OK; i++)
+      e = hash_leaf(job->src, i, buffer, buffer_size, job->out[i - job->first]);
+  }
+
+  if (e != OK) {
+    job_lock(job);
+    job->error = e;
+    job_unlock(job);
+  }
+
+  free(buffer);
+  return NULL;
+}
+
+/// Hash leaves [first, last) into out, calling thread hashes too
+static easy_error hash_leaves(const leaf_source *src, size_t first, size_t last,
+                              uint8_t (*out)[SHA256_HASH_SIZE], size_t nthreads) {
+  leaf_job job = {.src = src, .first = first, .next = first, .last = last, .out = out};
+  job.batch = SHA256_FILE_BUFFER_SIZE / src->leaf_size; // Small leaves are taken by 1 MiB
+  if (job.batch == 0)
+    job.batch = 1;
+  job.error = OK;
+
+  size_t batches = (last - first + job.batch - 1) / job.batch;
+#ifdef MERKLE_POSIX
+  pthread_mutex_init(&job.lock, NULL);
+#endif
+  run_workers(leaf_worker, &job, nthreads, batches);
+#ifdef MERKLE_POSIX
+  pthread_mutex_destroy(&job.lock);
+#endif
+
+  return job.error;
+}
+
+static void hash_node(const uint8_t left[SHA256_HASH_SIZE], const uint8_t right[SHA256_HASH_SIZE],
+                      uint8_t out[SHA256_HASH_SIZE]) {
+  uint8_t message[1 + 2 * SHA256_HASH_SIZE];
+  message[0] = NODE_PREFIX;
+  memcpy(message + 1, left, SHA256_HASH_SIZE);
+  memcpy(message + 1 + SHA256_HASH_SIZE, right, SHA256_HASH_SIZE);
+  sha256_hash(message, sizeof(message), out);
+}
+
+/// Recompute all parents of leaves [first, last]
+static void update_parents(merkle_tree *tree, size_t first, size_t last) {
+  for (size_t level = 0; level + 1 < tree->levels; level++) {
+    size_t count = merkle_level_size(tree, level);
+    uint8_t (*nodes)[SHA256_HASH_SIZE] = tree->nodes + tree->level_start[level];
+    uint8_t (*parents)[SHA256_HASH_SIZE] = tree->nodes + tree->level_start[level + 1];
+
+    first /= 2;
+    last /= 2;
+    for (size_t i = first; i <= last; i++) {
+      if (2 * i + 1 < count)
+        hash_node(nodes[2 * i], nodes[2 * i + 1], parents[i]);
+      else // Odd node is moved up
+        memcpy(parents[i], nodes[2 * i], SHA256_HASH_SIZE);
+    }
+  }
+}
+
+static merkle_tree *tree_alloc(uint64_t size, size_t leaf_size, easy_error *err) {
+  if (leaf_size == 0)
+    leaf_size = MERKLE_DEFAULT_LEAF_SIZE;
+  if (leaf_size < MERKLE_MIN_LEAF_SIZE || (leaf_size & (leaf_size - 1)) != 0) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return NULL;
+  }
+
+  uint64_t leaves = (size == 0) ? 1 : (size - 1) / leaf_size + 1;
+  if (leaves > SIZE_MAX / (4 * SHA256_HASH_SIZE)) {
+    SET_CODE_ERROR(err, ALLOCATION_FAILED);
+    return NULL;
+  }
+
+  size_t levels = 1, nodes = (size_t)leaves;
+  for (size_t n = (size_t)leaves; n > 1; levels++) {
+    n = (n + 1) / 2;
+    nodes += n;
+  }
+
+  merkle_tree *tree = (merkle_tree *)malloc(sizeof(merkle_tree));
+  if (!tree) {
+    SET_CODE_ERROR(err, ALLOCATION_FAILED);
+    return NULL;
+  }
+  tree->level_start = (size_t *)malloc((levels + 1) * sizeof(size_t));
+  tree->nodes = (uint8_t (*)[SHA256_HASH_SIZE])malloc(nodes * SHA256_HASH_SIZE);
+  if (!tree->level_start || !tree->nodes) {
+    free(tree->level_start);
+    free(tree->nodes);
+    free(tree);
+    SET_CODE_ERROR(err, ALLOCATION_FAILED);
+    return NULL;
+  }
+
+  tree->size = size;
+  tree->leaf_size = leaf_size;
+  tree->leaf_count = (size_t)leaves;
+  tree->levels = levels;
+  tree->level_start[0] = 0;
+  for (size_t level = 0, n = (size_t)leaves; level < levels; level++, n = (n + 1) / 2)
+    tree->level_start[level + 1] = tree->level_start[level] + n;
+
+  return tree;
+}
+
+static merkle_tree *build_source(leaf_source *src, size_t nthreads, easy_error *err) {
+  merkle_tree *tree = tree_alloc(src->size, src->leaf_size, err);
+  if (!tree)
+    return NULL;
+  src->leaf_size = tree->leaf_size;
+
+  easy_error e = hash_leaves(src, 0, tree->leaf_count, tree->nodes, nthreads);
+  if (e != OK) {
+    merkle_free(tree);
+    SET_CODE_ERROR(err, e);
+    return NULL;
+  }
+
+  update_parents(tree, 0, tree->leaf_count - 1);
+  SET_CODE_ERROR(err, OK);
+  return tree;
+}
+
+/// Size of regular file, pipes and other files can't be read by positions
+static easy_error reader_size(freader *reader, uint64_t *size) {
+#ifdef MERKLE_POSIX
+  struct stat st;
+  if (fstat(fileno(reader->fp), &st) != 0)
+    return FILE_READ_FAILED;
+  if (!S_ISREG(st.st_mode))
+    return INVALID_ARGUMENT;
+
+  *size = (uint64_t)st.st_size;
+#else
+  if (fseek(reader->fp, 0, SEEK_END) != 0)
+    return FILE_SEEK_ERROR;
+  long end = ftell(reader->fp);
+  if (fseek(reader->fp, reader->pos, SEEK_SET) != 0)
+    return FILE_SEEK_ERROR;
+  if (end < 0)
+    return FILE_TELL_ERROR;
+
+  *size = (uint64_t)end;
+#endif
+  return OK;
+}
+
+merkle_tree *merkle_build(const void *data, size_t size, size_t leaf_size, size_t nthreads,
+                          easy_error *err) {
+  if (!data && size > 0) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return NULL;
+  }
+
+  leaf_source src = {(const uint8_t *)data, NULL, size, leaf_size};
+  if (!data)
+    src.data = (const uint8_t *)"";
+
+  return build_source(&src, nthreads, err);
+}
+
+merkle_tree *merkle_build_freader(freader *reader, size_t leaf_size, size_t nthreads,
+                                  easy_error *err) {
+  if (!reader || !reader->fp) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return NULL;
+  }
+
+  leaf_source src = {NULL, reader, 0, leaf_size};
+  easy_error e = reader_size(reader, &src.size);
+  if (e != OK) {
+    SET_CODE_ERROR(err, e);
+    return NULL;
+  }
+
+  return build_source(&src, nthreads, err);
+}
+
+merkle_tree *merkle_build_file(const char *filename, size_t leaf_size, size_t nthreads,
+                               easy_error *err) {
+  if (!filename) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return NULL;
+  }
+
+  freader *reader = openr(filename, READ_BIN, err);
+  if (!reader)
+    return NULL;
+
+  merkle_tree *tree = merkle_build_freader(reader, leaf_size, nthreads, err);
+  closer(reader);
+  return tree;
+}
+
+void merkle_free_(merkle_tree *tree) {
+  if (!tree)
+    return;
+
+  free(tree->level_start);
+  free(tree->nodes);
+  free(tree);
+}
+
+void merkle_root(const merkle_tree *tree, uint8_t out_hash[SHA256_HASH_SIZE]) {
+  if (!tree || !out_hash)
+    return;
+
+  memcpy(out_hash, tree->nodes[tree->level_start[tree->levels - 1]], SHA256_HASH_SIZE);
+}
+
+size_t merkle_level_size(const merkle_tree *tree, size_t level) {
+  if (!tree || level >= tree->levels)
+    return 0;
+
+  return tree->level_start[level + 1] - tree->level_start[level];
+}
+
+const uint8_t *merkle_node(const merkle_tree *tree, size_t level, size_t index) {
+  if (index >= merkle_level_size(tree, level))
+    return NULL;
+
+  return tree->nodes[tree->level_start[level] + index];
+}
+
+/// Hash leaves [*first, *last] which contain bytes of range. Returns NULL if there is nothing to
+/// hash or on error
+static uint8_t *hash_range(const merkle_tree *tree, const leaf_source *src, uint64_t offset,
+                           uint64_t length, size_t nthreads, size_t *first, size_t *last,
+                           easy_error *err) {
+  if (src->size != tree->size || offset > tree->size || length > tree->size - offset) {
+    *err = INVALID_ARGUMENT;
+    return NULL;
+  }
+
+  *err = OK;
+  if (length == 0)
+    return NULL;
+
+  *first = (size_t)(offset / tree->leaf_size);
+  *last = (size_t)((offset + length - 1) / tree->leaf_size);
+  uint8_t *hashes = (uint8_t *)malloc((*last - *first + 1) * SHA256_HASH_SIZE);
+  if (!hashes) {
+    *err = ALLOCATION_FAILED;
+    return NULL;
+  }
+
+  *err = hash_leaves(src, *first, *last + 1, (uint8_t (*)[SHA256_HASH_SIZE])hashes, nthreads);
+  if (*err != OK) {
+    free(hashes);
+    return NULL;
+  }
+
+  return hashes;
+}
+
+static easy_error update_source(merkle_tree *tree, const leaf_source *src, uint64_t offset,
+                                uint64_t length, size_t nthreads) {
+  easy_error e = OK;
+  size_t first = 0, last = 0;
+  uint8_t *hashes = hash_range(tree, src, offset, length, nthreads, &first, &last, &e);
+  if (!hashes) // Tree isn't changed on error
+    return e;
+
+  memcpy(tree->nodes[first], hashes, (last - first + 1) * SHA256_HASH_SIZE);
+  free(hashes);
+  update_parents(tree, first, last);
+
+  return OK;
+}
+
+static size_t verify_source(const merkle_tree *tree, const leaf_source *src, uint64_t offset,
+                            uint64_t length, size_t nthreads, size_t *bad_leaves, size_t max_bad,
+                            easy_error *err) {
+  easy_error e = OK;
+  size_t first = 0, last = 0;
+  uint8_t *hashes = hash_range(tree, src, offset, length, nthreads, &first, &last, &e);
+  SET_CODE_ERROR(err, e);
+  if (!hashes)
+    return 0;
+
+  size_t bad = 0;
+  for (size_t i = first; i <= last; i++) {
+    if (memcmp(hashes + (i - first) * SHA256_HASH_SIZE, tree->nodes[i], SHA256_HASH_SIZE) == 0)
+      continue;
+
+    if (bad_leaves && bad < max_bad)
+      bad_leaves[bad] = i;
+    bad++;
+  }
+  free(hashes);
+
+  return bad;
+}
+
+easy_error merkle_update(merkle_tree *tree, const void *data, uint64_t offset, uint64_t length,
+                         size_t nthreads) {
+  CHECK_NULL_PTR(tree);
+  CHECK_NULL_PTR((data || tree->size == 0));
+
+  leaf_source src = {(const uint8_t *)data, NULL, tree->size, tree->leaf_size};
+  return update_source(tree, &src, offset, length, nthreads);
+}
+
+easy_error merkle_update_freader(merkle_tree *tree, freader *reader, uint64_t offset,
+                                 uint64_t length, size_t nthreads) {
+  CHECK_NULL_PTR(tree);
+  CHECK_NULL_PTR((reader && reader->fp));
+
+  leaf_source src = {NULL, reader, 0, tree->leaf_size};
+  easy_error e = reader_size(reader, &src.size);
+  if (e != OK)
+    return e;
+
+  return update_source(tree, &src, offset, length, nthreads);
+}
+
+size_t merkle_verify(const merkle_tree *tree, const void *data, uint64_t offset, uint64_t length,
+                     size_t nthreads, size_t *bad_leaves, size_t max_bad, easy_error *err) {
+  if (!tree || (!data && tree->size > 0)) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  leaf_source src = {(const uint8_t *)data, NULL, tree->size, tree->leaf_size};
+  return verify_source(tree, &src, offset, length, nthreads, bad_leaves, max_bad, err);
+}
+
+size_t merkle_verify_freader(const merkle_tree *tree, freader *reader, uint64_t offset,
+                             uint64_t length, size_t nthreads, size_t *bad_leaves, size_t max_bad,
+                             easy_error *err) {
+  if (!tree || !reader || !reader->fp) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  leaf_source src = {NULL, reader, 0, tree->leaf_size};
+  easy_error e = reader_size(reader, &src.size);
+  if (e != OK) {
+    SET_CODE_ERROR(err, e);
+    return 0;
+  }
+
+  return verify_source(tree, &src, offset, length, nthreads, bad_leaves, max_bad, err);
+}
+
+/// Visit children only if hashes of nodes are different
+static void diff_node(const merkle_tree *a, const merkle_tree *b, size_t level, size_t index,
+                      size_t *leaves, size_t max_leaves, size_t *found) {
+  if (memcmp(merkle_node(a, level, index), merkle_node(b, level, index), SHA256_HASH_SIZE) == 0)
+    return;
+
+  if (level == 0) {
+    if (leaves && *found < max_leaves)
+      leaves[*found] = index;
+    (*found)++;
+    return;
+  }
+
+  diff_node(a, b, level - 1, 2 * index, leaves, max_leaves, found);
+  if (2 * index + 1 < merkle_level_size(a, level - 1))
+    diff_node(a, b, level - 1, 2 * index + 1, leaves, max_leaves, found);
+}
+
+size_t merkle_diff(const merkle_tree *a, const merkle_tree *b, size_t *leaves, size_t max_leaves,
+                   easy_error *err) {
+  if (!a || !b) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+  if (a->size != b->size || a->leaf_size != b->leaf_size) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return 0;
+  }
+
+  size_t found = 0;
+  diff_node(a, b, a->levels - 1, 0, leaves, max_leaves, &found);
+
+  SET_CODE_ERROR(err, OK);
+  return found;
+}
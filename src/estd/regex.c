@@ -0,0 +1,1606 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "estd/global.h"
+#include "estd/regex.h"
+
+/*
+Pattern is parsed into tree, which is compiled into two programs of NFA: forward one and one for
+reversed pattern. Search runs lazy DFA of forward program to find end of leftmost match, then
+DFA of reversed program from this end back to find its start. Groups are found only inside found
+match by simulating NFA (Pike VM). Everything is linear in size of text
+*/
+
+#define REGEX_MAX_PROGRAM 100000 // Limit of NFA size, big counted repetitions may exceed it
+#define REGEX_MAX_DEPTH 256      // Limit of nesting of groups
+#define REGEX_MAX_REPEAT 1000    // Limit of n and m in {n,m}
+#define REGEX_MAX_PREFIX 64      // Limit of literal prefix used for skipping text
+#define REGEX_DFA_MAX_STATES 4096
+
+// Set of bytes
+typedef struct re_set {
+  uint8_t bits[32];
+} re_set;
+
+#define set_has(set, c) (((set)->bits[(c) >> 3] >> ((c) & 7)) & 1)
+#define set_add(set, c) ((set)->bits[(c) >> 3] |= (uint8_t)(1u << ((c) & 7)))
+
+typedef enum {
+  NODE_EMPTY,
+  NODE_CLASS,  // One byte from set
+  NODE_CONCAT, // Children one after another
+  NODE_ALT,    // One of children
+  NODE_REPEAT, // Child from min to max times (-1 is infinity)
+  NODE_GROUP,  // Capturing group
+  NODE_BOL,
+  NODE_EOL
+} node_type;
+
+typedef struct re_node {
+  node_type type;
+  int set;     // Index of set for NODE_CLASS
+  int literal; // Byte if set contains only it, otherwise -1
+  int min, max;
+  bool greedy;
+  int group;
+  int child; // First child or -1
+  int next;  // Next sibling or -1
+} re_node;
+
+typedef enum { OP_CLASS, OP_SPLIT, OP_JMP, OP_SAVE, OP_BOL, OP_EOL, OP_MATCH } op_type;
+
+// SPLIT continues at x and y, x is preferred
+typedef struct re_inst {
+  uint8_t op;
+  uint32_t x;
+  uint32_t y;
+} re_inst;
+
+typedef struct re_prog {
+  re_inst *insts;
+  size_t count;
+  size_t capacity;
+  uint32_t anchored;   // Start of matching at exact position
+  uint32_t unanchored; // Start of matching at any position
+} re_prog;
+
+typedef struct dfa_state dfa_state;
+
+struct dfa_state {
+  dfa_state **next; // Transitions by class of byte, NULL if not computed yet
+  uint32_t *pcs;    // Instructions of NFA in order of priority
+  uint32_t count;
+  uint32_t hash;
+  uint8_t flags;
+};
+
+#define STATE_MATCH 1     // Match ends at current position
+#define STATE_AT_START 2  // State is at start of text
+#define STATE_END_KNOWN 4 // STATE_END_MATCH is computed
+#define STATE_END_MATCH 8 // Match ends here if it's end of text
+
+typedef struct re_dfa {
+  const regex *re;
+  const re_prog *prog;
+  uint32_t start_pc;
+  bool longest; // Don't drop threads after match, used for reversed search
+
+  dfa_state **table; // Open addressing set of states
+  size_t table_capacity;
+  size_t count;
+  size_t generation; // Incremented when all states are dropped
+
+  dfa_state *start[2]; // Indexed by at_start
+  dfa_state *dead;
+
+  // Scratch buffers
+  uint32_t *sparse;
+  uint32_t *dense;
+  size_t dense_count;
+  uint32_t *stack;
+  uint32_t *buf_in;
+  uint32_t *buf_out;
+} re_dfa;
+
+struct regex {
+  re_prog forward;
+  re_prog reverse;
+  re_set *sets;
+  size_t sets_count;
+  size_t groups; // With group 0
+  uint8_t byte_class[256];
+  uint8_t class_rep[256]; // Any byte of class
+  size_t classes_count;
+  char prefix[REGEX_MAX_PREFIX];
+  size_t prefix_length;
+  re_dfa *fwd;
+  re_dfa *rev;
+};
+
+/* ---------------------------------- Parser ----------------------------------------------- */
+
+typedef struct re_parser {
+  const char *p;
+  const char *end;
+  re_node *nodes;
+  size_t nodes_count;
+  size_t nodes_capacity;
+  re_set *sets;
+  size_t sets_count;
+  size_t sets_capacity;
+  int groups;
+  int depth;
+  easy_error err;
+} re_parser;
+
+static int parse_alt(re_parser *ps);
+
+static int new_node(re_parser *ps, node_type type) {
+  if (ps->nodes_count == ps->nodes_capacity) {
+    size_t new_capacity = EMAX((size_t)16, ps->nodes_capacity * 2);
+    re_node *nodes = (re_node *)realloc(ps->nodes, new_capacity * sizeof(re_node));
+    if (!nodes) {
+      ps->err = ALLOCATION_FAILED;
+      return -1;
+    }
+    ps->nodes = nodes;
+    ps->nodes_capacity = new_capacity;
+  }
+
+  re_node *node = &ps->nodes[ps->nodes_count];
+  node->type = type;
+  node->set = -1;
+  node->literal = -1;
+  node->min = node->max = 0;
+  node->greedy = true;
+  node->group = -1;
+  node->child = node->next = -1;
+
+  return (int)ps->nodes_count++;
+}
+
+static int new_set(re_parser *ps) {
+  if (ps->sets_count == ps->sets_capacity) {
+    size_t new_capacity = EMAX((size_t)16, ps->sets_capacity * 2);
+    re_set *sets = (re_set *)realloc(ps->sets, new_capacity * sizeof(re_set));
+    if (!sets) {
+      ps->err = ALLOCATION_FAILED;
+      return -1;
+    }
+    ps->sets = sets;
+    ps->sets_capacity = new_capacity;
+  }
+
+  memset(&ps->sets[ps->sets_count], 0, sizeof(re_set));
+  return (int)ps->sets_count++;
+}
+
+// Node matching one byte from set. Set is filled by caller
+static int new_class(re_parser *ps, int *set) {
+  *set = new_set(ps);
+  if (*set < 0)
+    return -1;
+
+  int node = new_node(ps, NODE_CLASS);
+  if (node >= 0)
+    ps->nodes[node].set = *set;
+
+  return node;
+}
+
+static int new_literal(re_parser *ps, uint8_t c) {
+  int set;
+  int node = new_class(ps, &set);
+  if (node < 0)
+    return -1;
+
+  set_add(&ps->sets[set], c);
+  ps->nodes[node].literal = c;
+
+  return node;
+}
+
+static void set_add_range(re_set *set, int lo, int hi) {
+  for (int c = lo; c <= hi; c++)
+    set_add(set, c);
+}
+
+static void set_invert(re_set *set) {
+  for (int i = 0; i < 32; i++)
+    set->bits[i] = (uint8_t)~set->bits[i];
+}
+
+// Add class of \d \w \s (and inverted \D \W \S). Returns false if c is not class letter
+static bool set_add_escape_class(re_set *set, char c) {
+  re_set tmp;
+  memset(&tmp, 0, sizeof(tmp));
+
+  switch (c) {
+  case 'd':
+  case 'D':
+    set_add_range(&tmp, '0', '9');
+    break;
+  case 'w':
+  case 'W':
+    set_add_range(&tmp, '0', '9');
+    set_add_range(&tmp, 'a', 'z');
+    set_add_range(&tmp, 'A', 'Z');
+    set_add(&tmp, '_');
+    break;
+  case 's':
+  case 'S':
+    set_add_range(&tmp, '\t', '\r'); // \t \n \v \f \r
+    set_add(&tmp, ' ');
+    break;
+  default:
+    return false;
+  }
+
+  if (c == 'D' || c == 'W' || c == 'S')
+    set_invert(&tmp);
+
+  for (int i = 0; i < 32; i++)
+    set->bits[i] |= tmp.bits[i];
+
+  return true;
+}
+
+static int hex_value(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+
+  return -1;
+}
+
+// Parse escaped literal after '\'. Returns byte or -1 on error
+static int parse_escape_literal(re_parser *ps) {
+  if (ps->p == ps->end)
+    return -1;
+
+  char c = *ps->p++;
+  switch (c) {
+  case 'n':
+    return '\n';
+  case 'r':
+    return '\r';
+  case 't':
+    return '\t';
+  case 'f':
+    return '\f';
+  case 'v':
+    return '\v';
+  case '0':
+    return '\0';
+  case 'x': {
+    if (ps->end - ps->p < 2)
+      return -1;
+
+    int hi = hex_value(ps->p[0]), lo = hex_value(ps->p[1]);
+    if (hi < 0 || lo < 0)
+      return -1;
+
+    ps->p += 2;
+    return hi * 16 + lo;
+  }
+  default:
+    // Letters and digits are reserved for future escapes
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))
+      return -1;
+
+    return (uint8_t)c;
+  }
+}
+
+static int parse_class(re_parser *ps) {
+  int set;
+  int node = new_class(ps, &set);
+  if (node < 0)
+    return -1;
+
+  bool negate = false;
+  if (ps->p < ps->end && *ps->p == '^') {
+    negate = true;
+    ps->p++;
+  }
+
+  bool first = true;
+  for (;;) {
+    if (ps->p == ps->end) {
+      ps->err = REGEX_INVALID;
+      return -1;
+    }
+
+    if (*ps->p == ']' && !first) {
+      ps->p++;
+      break;
+    }
+    first = false;
+
+    int lo;
+    if (*ps->p == '\\') {
+      ps->p++;
+      if (ps->p < ps->end && set_add_escape_class(&ps->sets[set], *ps->p)) {
+        ps->p++;
+        continue;
+      }
+
+      lo = parse_escape_literal(ps);
+      if (lo < 0) {
+        ps->err = REGEX_INVALID;
+        return -1;
+      }
+    } else
+      lo = (uint8_t)*ps->p++;
+
+    int hi = lo;
+    // '-' before ']' is literal
+    if (ps->end - ps->p >= 2 && ps->p[0] == '-' && ps->p[1] != ']') {
+      ps->p++;
+      if (*ps->p == '\\') {
+        ps->p++;
+        hi = parse_escape_literal(ps);
+      } else
+        hi = (uint8_t)*ps->p++;
+
+      if (hi < lo) {
+        ps->err = REGEX_INVALID;
+        return -1;
+      }
+    }
+
+    set_add_range(&ps->sets[set], lo, hi);
+  }
+
+  if (negate)
+    set_invert(&ps->sets[set]);
+
+  return node;
+}
+
+static int parse_atom(re_parser *ps) {
+  char c = *ps->p++;
+
+  switch (c) {
+  case '(': {
+    if (++ps->depth > REGEX_MAX_DEPTH) {
+      ps->err = REGEX_INVALID;
+      return -1;
+    }
+
+    int group = -1;
+    if (ps->end - ps->p >= 2 && ps->p[0] == '?' && ps->p[1] == ':')
+      ps->p += 2;
+    else
+      group = ++ps->groups;
+
+    int child = parse_alt(ps);
+    if (child < 0)
+      return -1;
+
+    if (ps->p == ps->end || *ps->p != ')') {
+      ps->err = REGEX_INVALID;
+      return -1;
+    }
+    ps->p++;
+    ps->depth--;
+
+    if (group < 0)
+      return child;
+
+    int node = new_node(ps, NODE_GROUP);
+    if (node >= 0) {
+      ps->nodes[node].group = group;
+      ps->nodes[node].child = child;
+    }
+    return node;
+  }
+  case '[':
+    return parse_class(ps);
+  case '.': {
+    int set;
+    int node = new_class(ps, &set);
+    if (node >= 0) {
+      set_add_range(&ps->sets[set], 0, 255);
+      ps->sets[set].bits['\n' >> 3] &= (uint8_t)~(1u << ('\n' & 7));
+    }
+    return node;
+  }
+  case '^':
+    return new_node(ps, NODE_BOL);
+  case '$':
+    return new_node(ps, NODE_EOL);
+  case '\\': {
+    if (ps->p < ps->end && *ps->p && strchr("dDwWsS", *ps->p)) {
+      int set;
+      int node = new_class(ps, &set);
+      if (node >= 0)
+        set_add_escape_class(&ps->sets[set], *ps->p++);
+      return node;
+    }
+
+    int literal = parse_escape_literal(ps);
+    if (literal < 0) {
+      ps->err = REGEX_INVALID;
+      return -1;
+    }
+    return new_literal(ps, (uint8_t)literal);
+  }
+  case '*':
+  case '+':
+  case '?':
+  case ')':
+    ps->err = REGEX_INVALID;
+    return -1;
+  default:
+    return new_literal(ps, (uint8_t)c);
+  }
+}
+
+static bool parse_number(re_parser *ps, int *value) {
+  if (ps->p == ps->end || *ps->p < '0' || *ps->p > '9')
+    return false;
+
+  int result = 0;
+  while (ps->p < ps->end && *ps->p >= '0' && *ps->p <= '9') {
+    result = result * 10 + (*ps->p++ - '0');
+    if (result > REGEX_MAX_REPEAT)
+      result = REGEX_MAX_REPEAT + 1; // It's error anyway, so just don't overflow
+  }
+
+  *value = result;
+  return true;
+}
+
+// Parse {n}, {n,} or {n,m}. If it's not valid, '{' is literal and nothing is consumed.
+// Bad bounds ({3,1} or bigger than REGEX_MAX_REPEAT) are error
+static bool parse_braces(re_parser *ps, int *min, int *max) {
+  const char *start = ps->p;
+  ps->p++; // '{'
+
+  if (!parse_number(ps, min))
+    goto literal;
+
+  *max = *min;
+  if (ps->p < ps->end && *ps->p == ',') {
+    ps->p++;
+    *max = -1;
+    if (ps->p < ps->end && *ps->p != '}' && !parse_number(ps, max))
+      goto literal;
+  }
+
+  if (ps->p == ps->end || *ps->p != '}')
+    goto literal;
+
+  ps->p++;
+  if (*min > REGEX_MAX_REPEAT || *max > REGEX_MAX_REPEAT || (*max >= 0 && *max < *min)) {
+    ps->err = REGEX_INVALID;
+    return false;
+  }
+
+  return true;
+
+literal:
+  ps->p = start;
+  return false;
+}
+
+static int parse_repeat(re_parser *ps) {
+  int node = parse_atom(ps);
+
+  while (node >= 0 && ps->p < ps->end) {
+    int min, max;
+    char c = *ps->p;
+
+    if (c == '*') {
+      min = 0;
+      max = -1;
+      ps->p++;
+    } else if (c == '+') {
+      min = 1;
+      max = -1;
+      ps->p++;
+    } else if (c == '?') {
+      min = 0;
+      max = 1;
+      ps->p++;
+    } else if (c != '{' || !parse_braces(ps, &min, &max))
+      return (ps->err == OK) ? node : -1;
+
+    int repeat = new_node(ps, NODE_REPEAT);
+    if (repeat < 0)
+      return -1;
+
+    ps->nodes[repeat].min = min;
+    ps->nodes[repeat].max = max;
+    ps->nodes[repeat].child = node;
+    if (ps->p < ps->end && *ps->p == '?') {
+      ps->nodes[repeat].greedy = false;
+      ps->p++;
+    }
+
+    node = repeat;
+  }
+
+  return node;
+}
+
+static int parse_concat(re_parser *ps) {
+  int first = -1, last = -1;
+
+  while (ps->p < ps->end && *ps->p != '|' && *ps->p != ')') {
+    int item = parse_repeat(ps);
+    if (item < 0)
+      return -1;
+
+    if (first < 0)
+      first = item;
+    else
+      ps->nodes[last].next = item;
+    last = item;
+  }
+
+  if (first < 0)
+    return new_node(ps, NODE_EMPTY);
+
+  if (first == last)
+    return first;
+
+  int node = new_node(ps, NODE_CONCAT);
+  if (node >= 0)
+    ps->nodes[node].child = first;
+
+  return node;
+}
+
+static int parse_alt(re_parser *ps) {
+  int first = parse_concat(ps);
+  if (first < 0 || ps->p == ps->end || *ps->p != '|')
+    return first;
+
+  int last = first;
+  while (ps->p < ps->end && *ps->p == '|') {
+    ps->p++;
+    int item = parse_concat(ps);
+    if (item < 0)
+      return -1;
+
+    ps->nodes[last].next = item;
+    last = item;
+  }
+
+  int node = new_node(ps, NODE_ALT);
+  if (node >= 0)
+    ps->nodes[node].child = first;
+
+  return node;
+}
+
+/* ---------------------------------- Compiler --------------------------------------------- */
+
+typedef struct re_compiler {
+  re_parser *ps;
+  re_prog *prog;
+  bool reversed;
+  easy_error err;
+} re_compiler;
+
+static uint32_t emit(re_compiler *c, op_type op, uint32_t x, uint32_t y) {
+  re_prog *prog = c->prog;
+
+  if (c->err != OK)
+    return 0;
+
+  if (prog->count >= REGEX_MAX_PROGRAM) {
+    c->err = REGEX_INVALID;
+    return 0;
+  }
+
+  if (prog->count == prog->capacity) {
+    size_t new_capacity = EMAX((size_t)32, prog->capacity * 2);
+    re_inst *insts = (re_inst *)realloc(prog->insts, new_capacity * sizeof(re_inst));
+    if (!insts) {
+      c->err = ALLOCATION_FAILED;
+      return 0;
+    }
+    prog->insts = insts;
+    prog->capacity = new_capacity;
+  }
+
+  prog->insts[prog->count].op = (uint8_t)op;
+  prog->insts[prog->count].x = x;
+  prog->insts[prog->count].y = y;
+
+  return (uint32_t)prog->count++;
+}
+
+#define prog_next(c) ((uint32_t)(c)->prog->count)
+#define patch_x(c, pc, target)                                                                     \
+  if ((c)->err == OK)                                                                              \
+  (c)->prog->insts[pc].x = (target)
+#define patch_y(c, pc, target)                                                                     \
+  if ((c)->err == OK)                                                                              \
+  (c)->prog->insts[pc].y = (target)
+
+// Split, which prefers x if greedy
+static uint32_t emit_split(re_compiler *c, bool greedy, uint32_t x, uint32_t y) {
+  return greedy ? emit(c, OP_SPLIT, x, y) : emit(c, OP_SPLIT, y, x);
+}
+
+static void patch_split(re_compiler *c, uint32_t pc, bool greedy, uint32_t body, uint32_t out) {
+  if (greedy) {
+    patch_x(c, pc, body);
+    patch_y(c, pc, out);
+  } else {
+    patch_x(c, pc, out);
+    patch_y(c, pc, body);
+  }
+}
+
+static void compile_node(re_compiler *c, int index);
+
+static void compile_concat(re_compiler *c, int first) {
+  if (!c->reversed) {
+    for (int child = first; child >= 0 && c->err == OK; child = c->ps->nodes[child].next)
+      compile_node(c, child);
+    return;
+  }
+
+  size_t count = 0;
+  for (int child = first; child >= 0; child = c->ps->nodes[child].next)
+    count++;
+
+  int *children = (int *)malloc(count * sizeof(int));
+  if (!children) {
+    c->err = ALLOCATION_FAILED;
+    return;
+  }
+
+  size_t i = 0;
+  for (int child = first; child >= 0; child = c->ps->nodes[child].next)
+    children[i++] = child;
+
+  while (i-- > 0 && c->err == OK)
+    compile_node(c, children[i]);
+
+  free(children);
+}
+
+static void compile_repeat(re_compiler *c, const re_node *node) {
+  for (int i = 0; i < node->min - (node->max < 0 ? 1 : 0); i++)
+    compile_node(c, node->child);
+
+  if (node->max < 0) {
+    if (node->min == 0) {
+      // It's compiled as (child+)?, so child matching empty string still takes part in match
+      // split body, out; body: child; split body, out; out:
+      uint32_t split = emit(c, OP_SPLIT, 0, 0);
+      compile_node(c, node->child);
+      emit_split(c, node->greedy, split + 1, prog_next(c) + 1);
+      patch_split(c, split, node->greedy, split + 1, prog_next(c));
+    } else {
+      // body: child; split body, out
+      uint32_t body = prog_next(c);
+      compile_node(c, node->child);
+      emit_split(c, node->greedy, body, prog_next(c) + 1);
+    }
+    return;
+  }
+
+  // Optional copies: each one can be skipped to the end
+  int optional = node->max - node->min;
+  if (optional == 0)
+    return;
+
+  uint32_t *splits = (uint32_t *)malloc((size_t)optional * sizeof(uint32_t));
+  if (!splits) {
+    c->err = ALLOCATION_FAILED;
+    return;
+  }
+
+  for (int i = 0; i < optional && c->err == OK; i++) {
+    splits[i] = emit(c, OP_SPLIT, 0, 0);
+    compile_node(c, node->child);
+  }
+
+  for (int i = 0; i < optional && c->err == OK; i++)
+    patch_split(c, splits[i], node->greedy, splits[i] + 1, prog_next(c));
+
+  free(splits);
+}
+
+static void compile_node(re_compiler *c, int index) {
+  const re_node *node = &c->ps->nodes[index];
+
+  switch (node->type) {
+  case NODE_EMPTY:
+    break;
+  case NODE_CLASS:
+    emit(c, OP_CLASS, (uint32_t)node->set, 0);
+    break;
+  case NODE_CONCAT:
+    compile_concat(c, node->child);
+    break;
+  case NODE_ALT: {
+    // split L1, next; L1: child1; jmp end; next: split L2, ... ; last child
+    uint32_t jumps_head = UINT32_MAX; // Jumps to end are chained through y
+    for (int child = node->child; child >= 0 && c->err == OK; child = c->ps->nodes[child].next) {
+      if (c->ps->nodes[child].next < 0) {
+        compile_node(c, child);
+        break;
+      }
+
+      uint32_t split = emit(c, OP_SPLIT, 0, 0);
+      compile_node(c, child);
+      uint32_t jump = emit(c, OP_JMP, 0, jumps_head);
+      jumps_head = jump;
+      patch_x(c, split, split + 1);
+      patch_y(c, split, prog_next(c));
+    }
+
+    while (c->err == OK && jumps_head != UINT32_MAX) {
+      uint32_t next = c->prog->insts[jumps_head].y;
+      c->prog->insts[jumps_head].x = prog_next(c);
+      c->prog->insts[jumps_head].y = 0;
+      jumps_head = next;
+    }
+    break;
+  }
+  case NODE_REPEAT:
+    compile_repeat(c, node);
+    break;
+  case NODE_GROUP:
+    if (!c->reversed)
+      emit(c, OP_SAVE, (uint32_t)node->group * 2, 0);
+    compile_node(c, node->child);
+    if (!c->reversed)
+      emit(c, OP_SAVE, (uint32_t)node->group * 2 + 1, 0);
+    break;
+  // In reversed program start and end of text are swapped
+  case NODE_BOL:
+    emit(c, c->reversed ? OP_EOL : OP_BOL, 0, 0);
+    break;
+  case NODE_EOL:
+    emit(c, c->reversed ? OP_BOL : OP_EOL, 0, 0);
+    break;
+  }
+}
+
+static easy_error compile_program(re_parser *ps, int root, re_prog *prog, bool reversed,
+                                  int any_set) {
+  re_compiler c = {ps, prog, reversed, OK};
+
+  // Unanchored search is lazy .* before pattern: L: split anchored, any; any: [\x00-\xff]; jmp L
+  prog->unanchored = emit(&c, OP_SPLIT, 3, 1);
+  emit(&c, OP_CLASS, (uint32_t)any_set, 0);
+  emit(&c, OP_JMP, 0, 0);
+
+  prog->anchored = emit(&c, OP_SAVE, 0, 0);
+  compile_node(&c, root);
+  emit(&c, OP_SAVE, 1, 0);
+  emit(&c, OP_MATCH, 0, 0);
+
+  return c.err;
+}
+
+// Collect literal bytes which every match starts with
+static bool collect_prefix(const re_parser *ps, int index, char *out, size_t *length) {
+  const re_node *node = &ps->nodes[index];
+
+  switch (node->type) {
+  case NODE_EMPTY:
+    return true;
+  case NODE_CLASS:
+    if (node->literal < 0 || *length == REGEX_MAX_PREFIX)
+      return false;
+    out[(*length)++] = (char)node->literal;
+    return true;
+  case NODE_CONCAT:
+    for (int child = node->child; child >= 0; child = ps->nodes[child].next)
+      if (!collect_prefix(ps, child, out, length))
+        return false;
+    return true;
+  case NODE_GROUP:
+    return collect_prefix(ps, node->child, out, length);
+  case NODE_REPEAT:
+    if (node->min > 0)
+      collect_prefix(ps, node->child, out, length);
+    return false;
+  default:
+    return false;
+  }
+}
+
+// Split bytes into classes which are not distinguished by any set of program
+static void compute_byte_classes(regex *re) {
+  int16_t classes[256] = {0};
+  size_t count = 1;
+
+  for (size_t s = 0; s < re->sets_count; s++) {
+    // Bytes of one class, which are in set, move to new class
+    int16_t split_to[512];
+    for (size_t i = 0; i < count; i++)
+      split_to[i] = -1;
+
+    size_t new_count = count;
+    for (int b = 0; b < 256; b++) {
+      if (!set_has(&re->sets[s], b))
+        continue;
+
+      if (split_to[classes[b]] < 0)
+        split_to[classes[b]] = (int16_t)new_count++;
+      classes[b] = split_to[classes[b]];
+    }
+
+    // Classes which were moved fully leave gaps, so classes are renumbered
+    int16_t renumber[512];
+    for (size_t i = 0; i < new_count; i++)
+      renumber[i] = -1;
+
+    count = 0;
+    for (int b = 0; b < 256; b++) {
+      if (renumber[classes[b]] < 0)
+        renumber[classes[b]] = (int16_t)count++;
+      classes[b] = renumber[classes[b]];
+    }
+  }
+
+  re->classes_count = count;
+  for (int b = 255; b >= 0; b--) {
+    re->byte_class[b] = (uint8_t)classes[b];
+    re->class_rep[classes[b]] = (uint8_t)b;
+  }
+}
+
+/* ---------------------------------- Lazy DFA --------------------------------------------- */
+
+static void dfa_flush(re_dfa *d) {
+  for (size_t i = 0; i < d->table_capacity; i++) {
+    free(d->table[i]);
+    d->table[i] = NULL;
+  }
+
+  d->count = 0;
+  d->start[0] = d->start[1] = NULL;
+  d->generation++;
+}
+
+static void dfa_free(re_dfa *d) {
+  if (!d)
+    return;
+
+  if (d->table)
+    dfa_flush(d);
+
+  free(d->table);
+  free(d->dead);
+  free(d->sparse);
+  free(d->dense);
+  free(d->stack);
+  free(d->buf_in);
+  free(d->buf_out);
+  free(d);
+}
+
+static dfa_state *dfa_state_alloc(const re_dfa *d, const uint32_t *pcs, uint32_t count) {
+  size_t classes = d->re->classes_count;
+  dfa_state *s = (dfa_state *)malloc(sizeof(dfa_state) + classes * sizeof(dfa_state *) +
+                                     count * sizeof(uint32_t));
+  if (!s)
+    return NULL;
+
+  s->next = (dfa_state **)(s + 1);
+  s->pcs = (uint32_t *)(s->next + classes);
+  s->count = count;
+  s->flags = 0;
+  s->hash = 0;
+  memset(s->next, 0, classes * sizeof(dfa_state *));
+  if (count > 0)
+    memcpy(s->pcs, pcs, count * sizeof(uint32_t));
+
+  return s;
+}
+
+static re_dfa *dfa_init(const regex *re, const re_prog *prog, uint32_t start_pc, bool longest) {
+  re_dfa *d = (re_dfa *)calloc(1, sizeof(re_dfa));
+  if (!d)
+    return NULL;
+
+  d->re = re;
+  d->prog = prog;
+  d->start_pc = start_pc;
+  d->longest = longest;
+  d->table_capacity = 64;
+  d->table = (dfa_state **)calloc(d->table_capacity, sizeof(dfa_state *));
+
+  size_t n = prog->count;
+  d->sparse = (uint32_t *)calloc(n, sizeof(uint32_t));
+  d->dense = (uint32_t *)malloc(n * sizeof(uint32_t));
+  d->stack = (uint32_t *)malloc((3 * n + 1) * sizeof(uint32_t));
+  d->buf_in = (uint32_t *)malloc(n * sizeof(uint32_t));
+  d->buf_out = (uint32_t *)malloc(n * sizeof(uint32_t));
+  d->dead = dfa_state_alloc(d, NULL, 0);
+
+  if (!d->table || !d->sparse || !d->dense || !d->stack || !d->buf_in || !d->buf_out ||
+      !d->dead) {
+    dfa_free(d);
+    return NULL;
+  }
+
+  // Dead state never leaves itself
+  for (size_t i = 0; i < re->classes_count; i++)
+    d->dead->next[i] = d->dead;
+
+  return d;
+}
+
+#define sparse_clear(d) ((d)->dense_count = 0)
+
+static inline bool sparse_insert(re_dfa *d, uint32_t pc) {
+  uint32_t i = d->sparse[pc];
+  if (i < d->dense_count && d->dense[i] == pc)
+    return false;
+
+  d->sparse[pc] = (uint32_t)d->dense_count;
+  d->dense[d->dense_count++] = pc;
+  return true;
+}
+
+/*
+Follow empty transitions from pcs of in (in order of priority) and write instructions, which wait
+for byte, match or end of text, into out
+*/
+static uint32_t dfa_closure(re_dfa *d, const uint32_t *in, uint32_t n, bool at_start,
+                            uint32_t *out) {
+  const re_inst *insts = d->prog->insts;
+  uint32_t count = 0;
+  size_t top = 0;
+
+  sparse_clear(d);
+  for (uint32_t i = n; i-- > 0;)
+    d->stack[top++] = in[i];
+
+  while (top > 0) {
+    uint32_t pc = d->stack[--top];
+    if (!sparse_insert(d, pc))
+      continue;
+
+    const re_inst *inst = &insts[pc];
+    switch (inst->op) {
+    case OP_JMP:
+      d->stack[top++] = inst->x;
+      break;
+    case OP_SPLIT:
+      d->stack[top++] = inst->y;
+      d->stack[top++] = inst->x;
+      break;
+    case OP_SAVE:
+      d->stack[top++] = pc + 1;
+      break;
+    case OP_BOL:
+      if (at_start)
+        d->stack[top++] = pc + 1;
+      break;
+    case OP_EOL:
+    case OP_CLASS:
+      out[count++] = pc;
+      break;
+    case OP_MATCH:
+      out[count++] = pc;
+      // Threads with lower priority can't win anymore
+      if (!d->longest)
+        return count;
+      break;
+    }
+  }
+
+  return count;
+}
+
+static uint32_t hash_pcs(const uint32_t *pcs, uint32_t count, uint8_t flags) {
+  uint32_t h = 2166136261u ^ flags;
+  for (uint32_t i = 0; i < count; i++)
+    h = (h ^ pcs[i]) * 16777619u;
+
+  return h;
+}
+
+static bool dfa_grow_table(re_dfa *d) {
+  size_t new_capacity = d->table_capacity * 2;
+  dfa_state **table = (dfa_state **)calloc(new_capacity, sizeof(dfa_state *));
+  if (!table)
+    return false;
+
+  for (size_t i = 0; i < d->table_capacity; i++) {
+    dfa_state *s = d->table[i];
+    if (!s)
+      continue;
+
+    size_t index = s->hash & (new_capacity - 1);
+    while (table[index])
+      index = (index + 1) & (new_capacity - 1);
+    table[index] = s;
+  }
+
+  free(d->table);
+  d->table = table;
+  d->table_capacity = new_capacity;
+
+  return true;
+}
+
+// Find or create state with given pcs. May drop all states if there are too many
+static dfa_state *dfa_intern(re_dfa *d, const uint32_t *pcs, uint32_t count, bool at_start) {
+  if (count == 0)
+    return d->dead;
+
+  uint8_t flags = 0;
+  for (uint32_t i = 0; i < count; i++)
+    if (d->prog->insts[pcs[i]].op == OP_MATCH)
+      flags |= STATE_MATCH;
+  if (at_start)
+    flags |= STATE_AT_START;
+
+  uint32_t hash = hash_pcs(pcs, count, flags & STATE_AT_START);
+  size_t mask = d->table_capacity - 1;
+  size_t index = hash & mask;
+
+  for (dfa_state *s; (s = d->table[index]); index = (index + 1) & mask)
+    if (s->hash == hash && s->count == count &&
+        (s->flags & STATE_AT_START) == (flags & STATE_AT_START) &&
+        memcmp(s->pcs, pcs, count * sizeof(uint32_t)) == 0)
+      return s;
+
+  if (d->count >= REGEX_DFA_MAX_STATES)
+    dfa_flush(d);
+
+  if ((d->count + 1) * 2 > d->table_capacity && !dfa_grow_table(d))
+    return NULL;
+
+  dfa_state *s = dfa_state_alloc(d, pcs, count);
+  if (!s)
+    return NULL;
+
+  s->hash = hash;
+  s->flags = flags;
+
+  mask = d->table_capacity - 1;
+  index = hash & mask;
+  while (d->table[index])
+    index = (index + 1) & mask;
+  d->table[index] = s;
+  d->count++;
+
+  return s;
+}
+
+static dfa_state *dfa_start(re_dfa *d, bool at_start) {
+  if (d->start[at_start])
+    return d->start[at_start];
+
+  uint32_t count = dfa_closure(d, &d->start_pc, 1, at_start, d->buf_out);
+  dfa_state *s = dfa_intern(d, d->buf_out, count, at_start);
+  d->start[at_start] = s;
+
+  return s;
+}
+
+static dfa_state *dfa_next(re_dfa *d, dfa_state *s, uint8_t byte) {
+  size_t cls = d->re->byte_class[byte];
+  if (s->next[cls])
+    return s->next[cls];
+
+  const re_inst *insts = d->prog->insts;
+  const re_set *sets = d->re->sets;
+  uint8_t rep = d->re->class_rep[cls];
+  uint32_t n = 0;
+
+  for (uint32_t i = 0; i < s->count; i++) {
+    const re_inst *inst = &insts[s->pcs[i]];
+    if (inst->op == OP_CLASS && set_has(&sets[inst->x], rep))
+      d->buf_in[n++] = s->pcs[i] + 1;
+  }
+
+  uint32_t count = dfa_closure(d, d->buf_in, n, false, d->buf_out);
+
+  size_t generation = d->generation;
+  dfa_state *next = dfa_intern(d, d->buf_out, count, false);
+  // After flush s is freed, so transition can't be cached
+  if (next && generation == d->generation)
+    s->next[cls] = next;
+
+  return next;
+}
+
+// Checks that match ends at s if it's end of text
+static bool dfa_match_at_end(re_dfa *d, dfa_state *s) {
+  if (s->flags & STATE_END_KNOWN)
+    return (s->flags & STATE_END_MATCH) != 0;
+
+  bool match = (s->flags & STATE_MATCH) != 0;
+  const re_inst *insts = d->prog->insts;
+  size_t top = 0;
+
+  sparse_clear(d);
+  for (uint32_t i = 0; i < s->count && !match; i++)
+    if (insts[s->pcs[i]].op == OP_EOL)
+      d->stack[top++] = s->pcs[i] + 1;
+
+  while (top > 0 && !match) {
+    uint32_t pc = d->stack[--top];
+    if (!sparse_insert(d, pc))
+      continue;
+
+    const re_inst *inst = &insts[pc];
+    switch (inst->op) {
+    case OP_JMP:
+      d->stack[top++] = inst->x;
+      break;
+    case OP_SPLIT:
+      d->stack[top++] = inst->y;
+      d->stack[top++] = inst->x;
+      break;
+    case OP_BOL:
+      if (s->flags & STATE_AT_START)
+        d->stack[top++] = pc + 1;
+      break;
+    case OP_SAVE:
+    case OP_EOL:
+      d->stack[top++] = pc + 1;
+      break;
+    case OP_MATCH:
+      match = true;
+      break;
+    default:
+      break;
+    }
+  }
+
+  s->flags |= STATE_END_KNOWN | (match ? STATE_END_MATCH : 0);
+  return match;
+}
+
+// Find first occurrence of prefix starting from pos
+static size_t find_prefix(const regex *re, const char *text, size_t length, size_t pos) {
+  if (re->prefix_length == 1) {
+    const char *found = (const char *)memchr(text + pos, re->prefix[0], length - pos);
+    return found ? (size_t)(found - text) : REGEX_NO_POS;
+  }
+
+  ptrdiff_t found =
+      boyer_moore_search_n(text + pos, length - pos, re->prefix, re->prefix_length);
+
+  return (found >= 0) ? pos + (size_t)found : REGEX_NO_POS;
+}
+
+// Find end of leftmost match starting at from or later. If earliest, stop on first match end
+static easy_error dfa_forward(regex *re, const char *text, size_t length, size_t from,
+                              bool earliest, size_t *match_end) {
+  re_dfa *d = re->fwd;
+  dfa_state *s = dfa_start(d, from == 0);
+  size_t last = REGEX_NO_POS;
+  size_t i = from;
+
+  *match_end = REGEX_NO_POS;
+  if (!s)
+    return ALLOCATION_FAILED;
+
+  for (;;) {
+    if (s->flags & STATE_MATCH) {
+      last = i;
+      if (earliest)
+        break;
+    }
+
+    if (i == length) {
+      if (dfa_match_at_end(d, s))
+        last = length;
+      break;
+    }
+
+    if (s == d->dead)
+      break;
+
+    // Nothing is started yet, so next match can start only at prefix
+    if (re->prefix_length > 0 && s == d->start[0]) {
+      i = find_prefix(re, text, length, i);
+      if (i == REGEX_NO_POS)
+        break;
+    }
+
+    s = dfa_next(d, s, (uint8_t)text[i]);
+    if (!s)
+      return ALLOCATION_FAILED;
+    i++;
+  }
+
+  *match_end = last;
+  return OK;
+}
+
+// Find start of the longest match ending at end and starting not before limit
+static easy_error dfa_reverse(regex *re, const char *text, size_t length, size_t end,
+                              size_t limit, size_t *match_start) {
+  re_dfa *d = re->rev;
+  dfa_state *s = dfa_start(d, end == length);
+  size_t last = REGEX_NO_POS;
+  size_t i = end;
+
+  *match_start = REGEX_NO_POS;
+  if (!s)
+    return ALLOCATION_FAILED;
+
+  for (;;) {
+    if (s->flags & STATE_MATCH)
+      last = i;
+
+    if (i == limit) {
+      if (i == 0 && dfa_match_at_end(d, s))
+        last = 0;
+      break;
+    }
+
+    if (s == d->dead)
+      break;
+
+    s = dfa_next(d, s, (uint8_t)text[i - 1]);
+    if (!s)
+      return ALLOCATION_FAILED;
+    i--;
+  }
+
+  *match_start = last;
+  return OK;
+}
+
+/* ---------------------------------- Pike VM ---------------------------------------------- */
+
+typedef struct pike_list {
+  uint32_t *sparse;
+  uint32_t *dense;
+  size_t *caps; // Groups of thread i are caps[i * nslots...]
+  size_t count;
+} pike_list;
+
+typedef struct pike_job {
+  uint32_t pc;
+  uint32_t slot; // UINT32_MAX to explore pc, otherwise restore slot to value
+  size_t value;
+} pike_job;
+
+static void pike_add(const regex *re, pike_list *list, pike_job *stack, uint32_t pc, size_t *cap,
+                     size_t pos, size_t length) {
+  const re_inst *insts = re->forward.insts;
+  size_t nslots = re->groups * 2;
+  size_t top = 0;
+
+  stack[top++] = (pike_job){pc, UINT32_MAX, 0};
+  while (top > 0) {
+    pike_job job = stack[--top];
+    if (job.slot != UINT32_MAX) {
+      cap[job.slot] = job.value;
+      continue;
+    }
+
+    pc = job.pc;
+    uint32_t i = list->sparse[pc];
+    if (i < list->count && list->dense[i] == pc)
+      continue;
+
+    list->sparse[pc] = (uint32_t)list->count;
+    list->dense[list->count] = pc;
+    memcpy(list->caps + list->count * nslots, cap, nslots * sizeof(size_t));
+    list->count++;
+
+    const re_inst *inst = &insts[pc];
+    switch (inst->op) {
+    case OP_JMP:
+      stack[top++] = (pike_job){inst->x, UINT32_MAX, 0};
+      break;
+    case OP_SPLIT:
+      stack[top++] = (pike_job){inst->y, UINT32_MAX, 0};
+      stack[top++] = (pike_job){inst->x, UINT32_MAX, 0};
+      break;
+    case OP_SAVE:
+      stack[top++] = (pike_job){0, inst->x, cap[inst->x]};
+      stack[top++] = (pike_job){pc + 1, UINT32_MAX, 0};
+      cap[inst->x] = pos;
+      break;
+    case OP_BOL:
+      if (pos == 0)
+        stack[top++] = (pike_job){pc + 1, UINT32_MAX, 0};
+      break;
+    case OP_EOL:
+      if (pos == length)
+        stack[top++] = (pike_job){pc + 1, UINT32_MAX, 0};
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+// Find groups of match, which starts at start and ends not after end
+static easy_error pike_run(const regex *re, const char *text, size_t length, size_t start,
+                           size_t end, size_t *slots) {
+  size_t n = re->forward.count;
+  size_t nslots = re->groups * 2;
+  pike_list lists[2];
+  easy_error err = OK;
+
+  for (int i = 0; i < 2; i++) {
+    lists[i].sparse = (uint32_t *)calloc(n, sizeof(uint32_t));
+    lists[i].dense = (uint32_t *)malloc(n * sizeof(uint32_t));
+    lists[i].caps = (size_t *)malloc(n * nslots * sizeof(size_t));
+    lists[i].count = 0;
+  }
+  pike_job *stack = (pike_job *)malloc((2 * n + 1) * sizeof(pike_job));
+  size_t *cap = (size_t *)malloc(nslots * sizeof(size_t));
+
+  if (!lists[0].sparse || !lists[0].dense || !lists[0].caps || !lists[1].sparse ||
+      !lists[1].dense || !lists[1].caps || !stack || !cap) {
+    err = ALLOCATION_FAILED;
+    goto cleanup;
+  }
+
+  for (size_t i = 0; i < nslots; i++)
+    cap[i] = slots[i] = REGEX_NO_POS;
+
+  pike_list *clist = &lists[0], *nlist = &lists[1];
+  pike_add(re, clist, stack, re->forward.anchored, cap, start, length);
+
+  for (size_t pos = start; clist->count > 0; pos++) {
+    nlist->count = 0;
+
+    for (size_t i = 0; i < clist->count; i++) {
+      const re_inst *inst = &re->forward.insts[clist->dense[i]];
+      size_t *thread = clist->caps + i * nslots;
+
+      if (inst->op == OP_CLASS) {
+        if (pos < end && set_has(&re->sets[inst->x], (uint8_t)text[pos])) {
+          memcpy(cap, thread, nslots * sizeof(size_t));
+          pike_add(re, nlist, stack, clist->dense[i] + 1, cap, pos + 1, length);
+        }
+      } else if (inst->op == OP_MATCH) {
+        memcpy(slots, thread, nslots * sizeof(size_t));
+        break; // Threads with lower priority are dropped
+      }
+    }
+
+    pike_list *tmp = clist;
+    clist = nlist;
+    nlist = tmp;
+
+    if (pos >= end)
+      break;
+  }
+
+cleanup:
+  for (int i = 0; i < 2; i++) {
+    free(lists[i].sparse);
+    free(lists[i].dense);
+    free(lists[i].caps);
+  }
+  free(stack);
+  free(cap);
+
+  return err;
+}
+
+/* ---------------------------------- Public API ------------------------------------------- */
+
+regex *regex_compile_n(const char *pattern, size_t length, easy_error *err) {
+  if (!pattern && length > 0) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return NULL;
+  }
+
+  re_parser ps;
+  memset(&ps, 0, sizeof(ps));
+  ps.p = pattern;
+  ps.end = pattern + length;
+
+  regex *re = (regex *)calloc(1, sizeof(regex));
+  if (!re) {
+    SET_CODE_ERROR(err, ALLOCATION_FAILED);
+    return NULL;
+  }
+
+  int root = parse_alt(&ps);
+  if (root >= 0 && ps.p != ps.end)
+    ps.err = REGEX_INVALID; // Unbalanced ')'
+
+  int any_set = (ps.err == OK) ? new_set(&ps) : -1;
+  if (any_set >= 0)
+    set_add_range(&ps.sets[any_set], 0, 255);
+
+  easy_error e = ps.err;
+  if (e == OK) {
+    re->groups = (size_t)ps.groups + 1;
+    e = compile_program(&ps, root, &re->forward, false, any_set);
+  }
+  if (e == OK)
+    e = compile_program(&ps, root, &re->reverse, true, any_set);
+
+  if (e == OK) {
+    collect_prefix(&ps, root, re->prefix, &re->prefix_length);
+
+    re->sets = ps.sets;
+    re->sets_count = ps.sets_count;
+    ps.sets = NULL;
+    compute_byte_classes(re);
+
+    re->fwd = dfa_init(re, &re->forward, re->forward.unanchored, false);
+    re->rev = dfa_init(re, &re->reverse, re->reverse.anchored, true);
+    if (!re->fwd || !re->rev)
+      e = ALLOCATION_FAILED;
+  }
+
+  free(ps.nodes);
+  free(ps.sets);
+
+  if (e != OK) {
+    regex_free_(re);
+    SET_CODE_ERROR(err, e);
+    return NULL;
+  }
+
+  SET_CODE_ERROR(err, OK);
+  return re;
+}
+
+regex *regex_compile(const char *pattern, easy_error *err) {
+  if (!pattern) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return NULL;
+  }
+
+  return regex_compile_n(pattern, strlen(pattern), err);
+}
+
+void regex_free_(regex *re) {
+  dfa_free(re->fwd);
+  dfa_free(re->rev);
+  free(re->forward.insts);
+  free(re->reverse.insts);
+  free(re->sets);
+  free(re);
+}
+
+size_t regex_groups(const regex *re) { return re ? re->groups : 0; }
+
+bool regex_is_match(regex *re, string_view text) {
+  if (!re || (!text.data && text.length > 0))
+    return false;
+
+  size_t end;
+  if (dfa_forward(re, text.data, text.length, 0, true, &end) != OK)
+    return false;
+
+  return end != REGEX_NO_POS;
+}
+
+bool regex_is_match_string(regex *re, const string *str) {
+  if (!str || !str->data)
+    return false;
+
+  return regex_is_match(re, string_as_view(str));
+}
+
+bool regex_find(regex *re, string_view text, size_t from, regex_match *groups,
+                size_t groups_count, easy_error *err) {
+  if (!re) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return false;
+  }
+
+  if ((!text.data && text.length > 0) || (!groups && groups_count > 0)) {
+    SET_CODE_ERROR(err, INVALID_ARGUMENT);
+    return false;
+  }
+
+  if (from > text.length) {
+    SET_CODE_ERROR(err, INVALID_INDEX);
+    return false;
+  }
+
+  for (size_t i = 0; i < groups_count; i++)
+    groups[i].start = groups[i].end = REGEX_NO_POS;
+
+  size_t start, end;
+  easy_error e = dfa_forward(re, text.data, text.length, from, false, &end);
+  if (e == OK && end != REGEX_NO_POS)
+    e = dfa_reverse(re, text.data, text.length, end, from, &start);
+
+  if (e != OK || end == REGEX_NO_POS) {
+    SET_CODE_ERROR(err, e);
+    return false;
+  }
+
+  if (groups_count > 1) {
+    size_t nslots = re->groups * 2;
+    size_t *slots = (size_t *)malloc(nslots * sizeof(size_t));
+    if (!slots) {
+      SET_CODE_ERROR(err, ALLOCATION_FAILED);
+      return false;
+    }
+
+    e = pike_run(re, text.data, text.length, start, end, slots);
+    for (size_t i = 0; e == OK && i < EMIN(groups_count, re->groups); i++) {
+      groups[i].start = slots[i * 2];
+      groups[i].end = slots[i * 2 + 1];
+    }
+    free(slots);
+
+    if (e != OK) {
+      SET_CODE_ERROR(err, e);
+      return false;
+    }
+  } else if (groups_count == 1) {
+    groups[0].start = start;
+    groups[0].end = end;
+  }
+
+  SET_CODE_ERROR(err, OK);
+  return true;
+}
+
+size_t regex_find_all(regex *re, string_view text, regex_match *out, size_t out_size,
+                      easy_error *err) {
+  size_t count = 0;
+  size_t pos = 0;
+  regex_match match;
+  easy_error e = OK;
+
+  while (pos <= text.length && regex_find(re, text, pos, &match, 1, &e)) {
+    if (out && count < out_size)
+      out[count] = match;
+    count++;
+
+    // Empty match can't be found at the same position again
+    pos = (match.end == match.start) ? match.end + 1 : match.end;
+  }
+
+  SET_CODE_ERROR(err, e);
+  return count;
+}
+
+size_t regex_find_all_string(regex *re, const string *str, regex_match *out, size_t out_size,
+                             easy_error *err) {
+  if (!str || !str->data) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  return regex_find_all(re, string_as_view(str), out, out_size, err);
+}
+
+size_t regex_grep(regex *re, freader *reader, regex_line_fn fn, void *ctx, easy_error *err) {
+  if (!re || !reader || !reader->fp) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  line_reader *lr = line_reader_init(reader, 0, false, err);
+  if (!lr)
+    return 0;
+
+  size_t matched = 0;
+  string_view line;
+  easy_error e = OK;
+  while (line_reader_next(lr, &line, &e)) {
+    if (regex_is_match(re, line)) {
+      matched++;
+      if (fn && !fn(line, lr->line_number, ctx))
+        break;
+    }
+  }
+
+  line_reader_free(lr);
+  SET_CODE_ERROR(err, e);
+  return matched;
+}
@@ -0,0 +1,408 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "estd/global.h"
+#include "estd/rope.h"
+
+struct rope_node {
+  rope_node *left;
+  rope_node *right;
+  size_t offset; // Position of piece in its buffer
+  size_t length; // Size of piece
+  size_t total;  // Size of all pieces in subtree
+  uint32_t priority;
+  bool added; // true if piece is in added buffer, false if it's in original text
+};
+
+#define ROPE_ADDED_MIN_CAPACITY 256
+
+#define node_total(node) ((node) ? (node)->total : 0)
+
+static inline void node_update(rope_node *node) {
+  node->total = node_total(node->left) + node->length + node_total(node->right);
+}
+
+static inline const char *node_text(const rope *r, const rope_node *node) {
+  return (node->added ? r->added : r->original) + node->offset;
+}
+
+static uint32_t rope_random(rope *r) {
+  // xorshift64*
+  r->seed ^= r->seed >> 12;
+  r->seed ^= r->seed << 25;
+  r->seed ^= r->seed >> 27;
+
+  return (uint32_t)((r->seed * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+static rope_node *node_init(rope *r, bool added, size_t offset, size_t length) {
+  rope_node *node = (rope_node *)malloc(sizeof(rope_node));
+  if (!node)
+    return NULL;
+
+  node->left = node->right = NULL;
+  node->offset = offset;
+  node->length = length;
+  node->total = length;
+  node->priority = rope_random(r);
+  node->added = added;
+
+  return node;
+}
+
+static void node_free(rope_node *node) {
+  while (node) {
+    node_free(node->left);
+    rope_node *right = node->right;
+    free(node);
+    node = right;
+  }
+}
+
+/*
+Split tree into first pos chars (left) and rest (right). If pos is inside piece, piece is cut in
+two and *spare node is used for second part, so split never fails
+*/
+static void rope_split(rope_node *node, size_t pos, rope_node **left, rope_node **right,
+                       rope_node **spare) {
+  if (!node) {
+    *left = *right = NULL;
+    return;
+  }
+
+  size_t left_total = node_total(node->left);
+
+  if (pos <= left_total) {
+    rope_split(node->left, pos, left, &node->left, spare);
+    node_update(node);
+    *right = node;
+  } else if (pos >= left_total + node->length) {
+    rope_split(node->right, pos - left_total - node->length, &node->right, right, spare);
+    node_update(node);
+    *left = node;
+  } else {
+    size_t cut = pos - left_total;
+
+    // Tail gets priority of node, so heap order of right subtree is kept
+    rope_node *tail = *spare;
+    *spare = NULL;
+    tail->left = NULL;
+    tail->right = node->right;
+    tail->offset = node->offset + cut;
+    tail->length = node->length - cut;
+    tail->priority = node->priority;
+    tail->added = node->added;
+    node_update(tail);
+
+    node->right = NULL;
+    node->length = cut;
+    node_update(node);
+
+    *left = node;
+    *right = tail;
+  }
+}
+
+static rope_node *rope_merge(rope_node *left, rope_node *right) {
+  if (!left)
+    return right;
+  if (!right)
+    return left;
+
+  if (left->priority > right->priority) {
+    left->right = rope_merge(left->right, right);
+    node_update(left);
+    return left;
+  }
+
+  right->left = rope_merge(left, right->left);
+  node_update(right);
+  return right;
+}
+
+// Find node containing char at pos. *offset is set to position of char inside node
+static const rope_node *rope_find(const rope_node *node, size_t pos, size_t *offset) {
+  while (node) {
+    size_t left_total = node_total(node->left);
+
+    if (pos < left_total)
+      node = node->left;
+    else if (pos < left_total + node->length) {
+      *offset = pos - left_total;
+      return node;
+    } else {
+      pos -= left_total + node->length;
+      node = node->right;
+    }
+  }
+
+  return NULL;
+}
+
+static rope *rope_alloc(void) {
+  rope *r = (rope *)malloc(sizeof(rope));
+  if (!r)
+    return NULL;
+
+  r->root = NULL;
+  r->owned = NULL;
+  r->original = NULL;
+  r->added = NULL;
+  r->added_length = 0;
+  r->added_capacity = 0;
+  r->seed = 0x9E3779B97F4A7C15ULL ^ (uint64_t)(uintptr_t)r;
+
+  return r;
+}
+
+rope *rope_init_empty(void) { return rope_alloc(); }
+
+rope *rope_from_view(string_view text) {
+  if (!text.data && text.length > 0)
+    return NULL;
+
+  rope *r = rope_alloc();
+  if (!r)
+    return NULL;
+
+  r->original = text.data;
+  if (text.length > 0) {
+    r->root = node_init(r, false, 0, text.length);
+    if (!r->root) {
+      free(r);
+      return NULL;
+    }
+  }
+
+  return r;
+}
+
+rope *rope_from_string(string *str) {
+  if (!str || !str->data)
+    return NULL;
+
+  rope *r = rope_from_view(string_as_view(str));
+  if (r)
+    r->owned = str;
+
+  return r;
+}
+
+void rope_free_(rope *r) {
+  node_free(r->root);
+  if (r->owned)
+    string_free_(r->owned);
+  free(r->added);
+  free(r);
+}
+
+size_t rope_length(const rope *r) { return r ? node_total(r->root) : 0; }
+
+// Copy data to end of added buffer
+static easy_error rope_add_text(rope *r, const char *data, size_t n) {
+  if (n > SIZE_MAX / 2 - r->added_length)
+    return INVALID_ARGUMENT;
+
+  if (r->added_length + n > r->added_capacity) {
+    size_t new_capacity =
+        EMAX(r->added_length + n, EMAX(r->added_capacity * 2, (size_t)ROPE_ADDED_MIN_CAPACITY));
+    char *added = (char *)realloc(r->added, new_capacity);
+    CHECK_ALLOCATION(added);
+
+    r->added = added;
+    r->added_capacity = new_capacity;
+  }
+
+  memcpy(r->added + r->added_length, data, n);
+  r->added_length += n;
+
+  return OK;
+}
+
+// Extend last piece of tree by n chars if it ends where new text starts in added buffer
+static bool rope_extend_last(rope_node *node, size_t added_offset, size_t n) {
+  rope_node *last = node;
+  while (last && last->right)
+    last = last->right;
+
+  if (!last || !last->added || last->offset + last->length != added_offset)
+    return false;
+
+  last->length += n;
+  for (; node; node = node->right)
+    node->total += n;
+
+  return true;
+}
+
+easy_error rope_insert_n(rope *r, size_t pos, const char *data, size_t n) {
+  CHECK_NULL_PTR(r);
+
+  if (!data && n > 0)
+    return INVALID_ARGUMENT;
+
+  if (pos > rope_length(r))
+    return INVALID_INDEX;
+
+  if (n == 0)
+    return OK;
+
+  rope_node *spare = (rope_node *)malloc(sizeof(rope_node));
+  CHECK_ALLOCATION(spare);
+
+  size_t added_offset = r->added_length;
+  easy_error err = rope_add_text(r, data, n);
+  if (err != OK) {
+    free(spare);
+    return err;
+  }
+
+  rope_node *left, *right;
+  rope_split(r->root, pos, &left, &right, &spare);
+  free(spare);
+
+  // Sequential typing keeps growing one piece instead of creating new ones
+  if (!rope_extend_last(left, added_offset, n)) {
+    rope_node *node = node_init(r, true, added_offset, n);
+    if (!node) {
+      r->root = rope_merge(left, right);
+      return ALLOCATION_FAILED;
+    }
+    left = rope_merge(left, node);
+  }
+
+  r->root = rope_merge(left, right);
+
+  return OK;
+}
+
+easy_error rope_insert(rope *r, size_t pos, const char *cstr) {
+  CHECK_NULL_PTR(r);
+
+  if (!cstr)
+    return INVALID_ARGUMENT;
+
+  return rope_insert_n(r, pos, cstr, strlen(cstr));
+}
+
+easy_error rope_append_n(rope *r, const char *data, size_t n) {
+  return rope_insert_n(r, rope_length(r), data, n);
+}
+
+easy_error rope_erase(rope *r, size_t pos, size_t count) {
+  CHECK_NULL_PTR(r);
+
+  size_t length = rope_length(r);
+  if (pos > length)
+    return INVALID_INDEX;
+
+  count = EMIN(count, length - pos);
+  if (count == 0)
+    return OK;
+
+  // Both ends of range can be inside one piece, so two spare nodes may be needed
+  rope_node *spare1 = (rope_node *)malloc(sizeof(rope_node));
+  rope_node *spare2 = (rope_node *)malloc(sizeof(rope_node));
+  if (!spare1 || !spare2) {
+    free(spare1);
+    free(spare2);
+    return ALLOCATION_FAILED;
+  }
+
+  rope_node *left, *middle, *right;
+  rope_split(r->root, pos, &left, &right, &spare1);
+  rope_split(right, count, &middle, &right, spare1 ? &spare1 : &spare2);
+
+  node_free(middle);
+  free(spare1);
+  free(spare2);
+
+  r->root = rope_merge(left, right);
+
+  return OK;
+}
+
+char rope_at(const rope *r, size_t index, easy_error *err) {
+  if (!r) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return '\0';
+  }
+
+  size_t offset;
+  const rope_node *node = rope_find(r->root, index, &offset);
+  if (!node) {
+    SET_CODE_ERROR(err, INVALID_INDEX);
+    return '\0';
+  }
+
+  SET_CODE_ERROR(err, OK);
+  return node_text(r, node)[offset];
+}
+
+string *rope_substring(const rope *r, size_t pos, size_t count, easy_error *err) {
+  if (!r) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return NULL;
+  }
+
+  size_t length = rope_length(r);
+  if (pos > length) {
+    SET_CODE_ERROR(err, INVALID_INDEX);
+    return NULL;
+  }
+  count = EMIN(count, length - pos);
+
+  string *str = (string *)malloc(sizeof(string));
+  if (!str) {
+    SET_CODE_ERROR(err, ALLOCATION_FAILED);
+    return NULL;
+  }
+
+  str->length = count;
+  str->capacity = count + 1;
+  string_invalidate_hash(str);
+  str->data = (char *)malloc(str->capacity);
+  if (!str->data) {
+    free(str);
+    SET_CODE_ERROR(err, ALLOCATION_FAILED);
+    return NULL;
+  }
+
+  rope_iter it = rope_iter_init(r, pos);
+  string_view chunk;
+  size_t copied = 0;
+  while (copied < count && rope_iter_next(&it, &chunk)) {
+    size_t part = EMIN(chunk.length, count - copied);
+    memcpy(str->data + copied, chunk.data, part);
+    copied += part;
+  }
+  str->data[count] = '\0';
+
+  SET_CODE_ERROR(err, OK);
+  return str;
+}
+
+string *rope_flatten(const rope *r, easy_error *err) {
+  return rope_substring(r, 0, rope_length(r), err);
+}
+
+rope_iter rope_iter_init(const rope *r, size_t pos) {
+  rope_iter it = {r, pos};
+  return it;
+}
+
+bool rope_iter_next(rope_iter *it, string_view *chunk) {
+  if (!it || !it->r || !chunk)
+    return false;
+
+  size_t offset;
+  const rope_node *node = rope_find(it->r->root, it->pos, &offset);
+  if (!node)
+    return false;
+
+  chunk->data = node_text(it->r, node) + offset;
+  chunk->length = node->length - offset;
+  it->pos += chunk->length;
+
+  return true;
+}
@@ -0,0 +1,220 @@
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef __STDC_NO_ATOMICS__
+#include <stdatomic.h>
+#endif
+
+#include "estd/global.h"
+#include "estd/shstring.h"
+
+#ifndef __STDC_NO_ATOMICS__
+typedef atomic_size_t ref_count;
+#define ref_init(ref, value) atomic_init((ref), (value))
+#define ref_load(ref) atomic_load_explicit((ref), memory_order_acquire)
+#define ref_inc(ref) atomic_fetch_add_explicit((ref), 1, memory_order_relaxed)
+// Release orders our changes before freeing in other thread, acquire fence pairs with it
+#define ref_dec(ref) atomic_fetch_sub_explicit((ref), 1, memory_order_release)
+#define ref_fence() atomic_thread_fence(memory_order_acquire)
+#else
+// Without atomics shared_string can be used only from one thread
+typedef size_t ref_count;
+#define ref_init(ref, value) (*(ref) = (value))
+#define ref_load(ref) (*(ref))
+#define ref_inc(ref) ((*(ref))++)
+#define ref_dec(ref) ((*(ref))--)
+#define ref_fence() ((void)0)
+#endif
+
+struct shared_string {
+  ref_count refs;
+  size_t length;
+  size_t capacity; // Size of data without '\0'
+  char data[];
+};
+
+static shared_string *shared_string_alloc(size_t capacity) {
+  shared_string *str = (shared_string *)malloc(sizeof(shared_string) + capacity + 1);
+  if (!str)
+    return NULL;
+
+  ref_init(&str->refs, 1);
+  str->length = 0;
+  str->capacity = capacity;
+  str->data[0] = '\0';
+
+  return str;
+}
+
+shared_string *shared_string_from_n(const char *data, size_t length) {
+  if (!data && length > 0)
+    return NULL;
+
+  shared_string *str = shared_string_alloc(length);
+  if (!str)
+    return NULL;
+
+  if (length > 0)
+    memcpy(str->data, data, length);
+  str->data[length] = '\0';
+  str->length = length;
+
+  return str;
+}
+
+shared_string *shared_string_from_cstr(const char *cstr) {
+  if (!cstr)
+    return NULL;
+
+  return shared_string_from_n(cstr, strlen(cstr));
+}
+
+shared_string *shared_string_from_string(const string *str) {
+  if (!str || !str->data)
+    return NULL;
+
+  return shared_string_from_n(str->data, str->length);
+}
+
+shared_string *shared_string_copy(shared_string *str) {
+  if (!str)
+    return NULL;
+
+  ref_inc(&str->refs);
+  return str;
+}
+
+void shared_string_free_(shared_string *str) {
+  if (!str)
+    return;
+
+  if (ref_dec(&str->refs) == 1) {
+    ref_fence();
+    free(str);
+  }
+}
+
+size_t shared_string_refs(const shared_string *str) {
+  return str ? ref_load((ref_count *)&str->refs) : 0;
+}
+
+size_t shared_string_length(const shared_string *str) { return str ? str->length : 0; }
+
+const char *shared_string_cstr(const shared_string *str) { return str ? str->data : NULL; }
+
+string_view shared_string_view(const shared_string *str) {
+  string_view view = {NULL, 0};
+  if (str) {
+    view.data = str->data;
+    view.length = str->length;
+  }
+
+  return view;
+}
+
+// Make *str unique owner of buffer which can hold at least capacity chars
+static easy_error shared_string_prepare(shared_string **str, size_t capacity) {
+  shared_string *old = *str;
+
+  if (ref_load(&old->refs) == 1) {
+    if (capacity <= old->capacity)
+      return OK;
+
+    shared_string *grown = (shared_string *)realloc(old, sizeof(shared_string) + capacity + 1);
+    CHECK_ALLOCATION(grown);
+
+    grown->capacity = capacity;
+    *str = grown;
+    return OK;
+  }
+
+  shared_string *copy = shared_string_alloc(EMAX(capacity, old->length));
+  CHECK_ALLOCATION(copy);
+
+  memcpy(copy->data, old->data, old->length + 1);
+  copy->length = old->length;
+
+  shared_string_free_(old);
+  *str = copy;
+
+  return OK;
+}
+
+easy_error shared_string_make_unique(shared_string **str) {
+  CHECK_NULL_PTR((str && *str));
+
+  return shared_string_prepare(str, (*str)->capacity);
+}
+
+char *shared_string_data_mut(shared_string **str, easy_error *err) {
+  easy_error e = shared_string_make_unique(str);
+  if (e != OK) {
+    SET_CODE_ERROR(err, e);
+    return NULL;
+  }
+
+  SET_CODE_ERROR(err, OK);
+  return (*str)->data;
+}
+
+easy_error shared_string_append_n(shared_string **str, const char *data, size_t n) {
+  CHECK_NULL_PTR((str && *str));
+
+  if (!data && n > 0)
+    return INVALID_ARGUMENT;
+
+  size_t length = (*str)->length;
+  if (n > SIZE_MAX / 2 - length)
+    return INVALID_ARGUMENT;
+
+  size_t capacity = (*str)->capacity;
+  if (length + n > capacity)
+    capacity = EMAX(length + n, capacity * 2);
+
+  easy_error err = shared_string_prepare(str, capacity);
+  if (err != OK)
+    return err;
+
+  if (n > 0)
+    memcpy((*str)->data + length, data, n);
+  (*str)->length = length + n;
+  (*str)->data[length + n] = '\0';
+
+  return OK;
+}
+
+easy_error shared_string_append(shared_string **str, const char *cstr) {
+  CHECK_NULL_PTR((str && *str));
+
+  if (!cstr)
+    return INVALID_ARGUMENT;
+
+  return shared_string_append_n(str, cstr, strlen(cstr));
+}
+
+string *shared_string_to_string(const shared_string *str, easy_error *err) {
+  if (!str) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return NULL;
+  }
+
+  string *result = (string *)malloc(sizeof(string));
+  if (!result) {
+    SET_CODE_ERROR(err, ALLOCATION_FAILED);
+    return NULL;
+  }
+
+  result->length = str->length;
+  result->capacity = str->length + 1;
+  string_invalidate_hash(result);
+  result->data = (char *)malloc(result->capacity);
+  if (!result->data) {
+    free(result);
+    SET_CODE_ERROR(err, ALLOCATION_FAILED);
+    return NULL;
+  }
+  memcpy(result->data, str->data, str->length + 1);
+
+  SET_CODE_ERROR(err, OK);
+  return result;
+}
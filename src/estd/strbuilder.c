@@ -0,0 +1,193 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "estd/global.h"
+#include "estd/strbuilder.h"
+
+struct sb_chunk {
+  sb_chunk *next;
+  size_t used;
+  size_t capacity;
+  char data[];
+};
+
+static sb_chunk *sb_chunk_init(size_t capacity) {
+  sb_chunk *chunk = (sb_chunk *)malloc(sizeof(sb_chunk) + capacity);
+  if (!chunk)
+    return NULL;
+
+  chunk->next = NULL;
+  chunk->used = 0;
+  chunk->capacity = capacity;
+
+  return chunk;
+}
+
+string_builder *string_builder_init(size_t chunk_size) {
+  string_builder *sb = (string_builder *)malloc(sizeof(string_builder));
+  if (!sb)
+    return NULL;
+
+  sb->chunk_size = (chunk_size > 0) ? chunk_size : STRING_BUILDER_CHUNK_SIZE;
+  sb->length = 0;
+  sb->head = sb->tail = sb_chunk_init(sb->chunk_size);
+  if (!sb->head) {
+    free(sb);
+    return NULL;
+  }
+
+  return sb;
+}
+
+void string_builder_free_(string_builder *sb) {
+  sb_chunk *chunk = sb->head;
+  while (chunk) {
+    sb_chunk *next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+
+  sb->head = sb->tail = NULL;
+  sb->length = 0;
+  free(sb);
+}
+
+easy_error string_builder_append_n(string_builder *sb, const char *data, size_t n) {
+  CHECK_NULL_PTR((sb && sb->tail));
+
+  if (!data && n > 0)
+    return INVALID_ARGUMENT;
+
+  if (n == 0)
+    return OK;
+
+  // Fill the rest of the last chunk
+  sb_chunk *tail = sb->tail;
+  size_t part = EMIN(n, tail->capacity - tail->used);
+  memcpy(tail->data + tail->used, data, part);
+  tail->used += part;
+  sb->length += part;
+  data += part;
+  n -= part;
+
+  if (n == 0)
+    return OK;
+
+  // Big pieces get own chunk, so they are copied only once
+  sb_chunk *chunk = sb_chunk_init(EMAX(n, sb->chunk_size));
+  CHECK_ALLOCATION(chunk);
+
+  memcpy(chunk->data, data, n);
+  chunk->used = n;
+  tail->next = chunk;
+  sb->tail = chunk;
+  sb->length += n;
+
+  return OK;
+}
+
+easy_error string_builder_append(string_builder *sb, const char *cstr) {
+  CHECK_NULL_PTR((sb && sb->tail));
+
+  if (!cstr)
+    return INVALID_ARGUMENT;
+
+  return string_builder_append_n(sb, cstr, strlen(cstr));
+}
+
+easy_error string_builder_appendc(string_builder *sb, const char ch) {
+  CHECK_NULL_PTR((sb && sb->tail));
+
+  sb_chunk *tail = sb->tail;
+  if (tail->used < tail->capacity) {
+    tail->data[tail->used++] = ch;
+    sb->length++;
+    return OK;
+  }
+
+  return string_builder_append_n(sb, &ch, 1);
+}
+
+easy_error string_builder_append_view(string_builder *sb, string_view view) {
+  return string_builder_append_n(sb, view.data, view.length);
+}
+
+easy_error string_builder_clear(string_builder *sb) {
+  CHECK_NULL_PTR((sb && sb->head));
+
+  sb_chunk *chunk = sb->head->next;
+  while (chunk) {
+    sb_chunk *next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+
+  sb->head->next = NULL;
+  sb->head->used = 0;
+  sb->tail = sb->head;
+  sb->length = 0;
+
+  return OK;
+}
+
+string *string_builder_build(const string_builder *sb, easy_error *err) {
+  if (!sb || !sb->head) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return NULL;
+  }
+
+  string *str = (string *)malloc(sizeof(string));
+  if (!str) {
+    SET_CODE_ERROR(err, ALLOCATION_FAILED);
+    return NULL;
+  }
+
+  str->length = sb->length;
+  str->capacity = sb->length + 1;
+  string_invalidate_hash(str);
+  str->data = (char *)malloc(str->capacity);
+  if (!str->data) {
+    free(str);
+    SET_CODE_ERROR(err, ALLOCATION_FAILED);
+    return NULL;
+  }
+
+  size_t offset = 0;
+  for (const sb_chunk *chunk = sb->head; chunk; chunk = chunk->next) {
+    memcpy(str->data + offset, chunk->data, chunk->used);
+    offset += chunk->used;
+  }
+  str->data[offset] = '\0';
+
+  SET_CODE_ERROR(err, OK);
+  return str;
+}
+
+size_t string_builder_write(const string_builder *sb, fwriter *writer, easy_error *err) {
+  if (!sb || !sb->head) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  size_t written = 0;
+  for (const sb_chunk *chunk = sb->head; chunk; chunk = chunk->next) {
+    if (chunk->used == 0)
+      continue;
+
+    easy_error e = OK;
+    size_t n = write_bytes(writer, chunk->data, 1, chunk->used, &e);
+    written += n;
+    if (e != OK) {
+      SET_CODE_ERROR(err, e);
+      return written;
+    }
+
+    if (n != chunk->used) {
+      SET_CODE_ERROR(err, FILE_WRITE_FAILED);
+      return written;
+    }
+  }
+
+  SET_CODE_ERROR(err, OK);
+  return written;
+}
@@ -0,0 +1,351 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "estd/global.h"
+#include "estd/strtable.h"
+
+#define STRING_TABLE_MAGIC "ESTB"
+#define STRING_TABLE_VERSION 1
+#define STRING_TABLE_HEADER_SIZE 24 // magic, version, count, data_length
+#define STRING_TABLE_IO_CHUNK 512   // Offsets converted at once during reading/writing
+
+static void put_u32_le(uint8_t *out, uint32_t value) {
+  for (int i = 0; i < 4; i++)
+    out[i] = (uint8_t)(value >> (i * 8));
+}
+
+static void put_u64_le(uint8_t *out, uint64_t value) {
+  for (int i = 0; i < 8; i++)
+    out[i] = (uint8_t)(value >> (i * 8));
+}
+
+static uint32_t get_u32_le(const uint8_t *in) {
+  uint32_t value = 0;
+  for (int i = 3; i >= 0; i--)
+    value = (value << 8) | in[i];
+
+  return value;
+}
+
+static uint64_t get_u64_le(const uint8_t *in) {
+  uint64_t value = 0;
+  for (int i = 7; i >= 0; i--)
+    value = (value << 8) | in[i];
+
+  return value;
+}
+
+string_table *string_table_init(size_t count_hint, size_t bytes_hint) {
+  string_table *table = (string_table *)malloc(sizeof(string_table));
+  if (!table)
+    return NULL;
+
+  table->count = 0;
+  table->data_length = 0;
+  table->data_capacity = 0;
+  table->data = NULL;
+  table->offsets_capacity = count_hint + 1;
+  table->offsets = (size_t *)malloc(table->offsets_capacity * sizeof(size_t));
+  if (!table->offsets) {
+    free(table);
+    return NULL;
+  }
+  table->offsets[0] = 0;
+
+  if (count_hint > 0 || bytes_hint > 0) {
+    table->data_capacity = bytes_hint + count_hint; // Place for '\0' of each string
+    table->data = (char *)malloc(table->data_capacity);
+    if (!table->data) {
+      free(table->offsets);
+      free(table);
+      return NULL;
+    }
+  }
+
+  return table;
+}
+
+void string_table_free_(string_table *table) {
+  free(table->data);
+  free(table->offsets);
+  free(table);
+}
+
+easy_error string_table_reserve(string_table *table, size_t count, size_t bytes) {
+  CHECK_NULL_PTR((table && table->offsets));
+
+  if (count > SIZE_MAX / sizeof(size_t) - table->count - 1 ||
+      bytes > SIZE_MAX - table->data_length - count)
+    return INVALID_ARGUMENT;
+
+  size_t need_offsets = table->count + count + 1;
+  if (need_offsets > table->offsets_capacity) {
+    size_t new_capacity = EMAX(need_offsets, table->offsets_capacity * 2);
+    size_t *offsets = (size_t *)realloc(table->offsets, new_capacity * sizeof(size_t));
+    CHECK_ALLOCATION(offsets);
+
+    table->offsets = offsets;
+    table->offsets_capacity = new_capacity;
+  }
+
+  size_t need_data = table->data_length + bytes + count;
+  if (need_data > table->data_capacity) {
+    size_t new_capacity = EMAX(need_data, table->data_capacity * 2);
+    char *data = (char *)realloc(table->data, new_capacity);
+    CHECK_ALLOCATION(data);
+
+    table->data = data;
+    table->data_capacity = new_capacity;
+  }
+
+  return OK;
+}
+
+easy_error string_table_push_n(string_table *table, const char *data, size_t length) {
+  CHECK_NULL_PTR((table && table->offsets));
+
+  if (!data && length > 0)
+    return INVALID_ARGUMENT;
+
+  easy_error err = string_table_reserve(table, 1, length);
+  if (err != OK)
+    return err;
+
+  char *dst = table->data + table->data_length;
+  if (length > 0)
+    memcpy(dst, data, length);
+  dst[length] = '\0';
+
+  table->data_length += length + 1;
+  table->count++;
+  table->offsets[table->count] = table->data_length;
+
+  return OK;
+}
+
+easy_error string_table_push(string_table *table, const char *cstr) {
+  CHECK_NULL_PTR((table && table->offsets));
+
+  if (!cstr)
+    return INVALID_ARGUMENT;
+
+  return string_table_push_n(table, cstr, strlen(cstr));
+}
+
+easy_error string_table_push_view(string_table *table, string_view view) {
+  return string_table_push_n(table, view.data, view.length);
+}
+
+string_view string_table_get(const string_table *table, size_t index, easy_error *err) {
+  string_view view = {NULL, 0};
+
+  if (!table || !table->offsets) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return view;
+  }
+
+  if (index >= table->count) {
+    SET_CODE_ERROR(err, INVALID_INDEX);
+    return view;
+  }
+
+  view.data = table->data + table->offsets[index];
+  view.length = table->offsets[index + 1] - table->offsets[index] - 1;
+
+  SET_CODE_ERROR(err, OK);
+  return view;
+}
+
+const char *string_table_cstr(const string_table *table, size_t index, easy_error *err) {
+  return string_table_get(table, index, err).data;
+}
+
+easy_error string_table_clear(string_table *table) {
+  CHECK_NULL_PTR((table && table->offsets));
+
+  table->count = 0;
+  table->data_length = 0;
+
+  return OK;
+}
+
+static int view_compare(const void *a, const void *b) {
+  const string_view *arg1 = (const string_view *)a;
+  const string_view *arg2 = (const string_view *)b;
+
+  int result = memcmp(arg1->data, arg2->data, EMIN(arg1->length, arg2->length));
+  if (result != 0)
+    return result;
+
+  return (arg1->length > arg2->length) - (arg1->length < arg2->length);
+}
+
+easy_error string_table_sort(string_table *table) {
+  CHECK_NULL_PTR((table && table->offsets));
+
+  if (table->count < 2)
+    return OK;
+
+  string_view *views = (string_view *)malloc(table->count * sizeof(string_view));
+  CHECK_ALLOCATION(views);
+
+  char *data = (char *)malloc(table->data_capacity);
+  if (!data) {
+    free(views);
+    return ALLOCATION_FAILED;
+  }
+
+  for (size_t i = 0; i < table->count; i++) {
+    views[i].data = table->data + table->offsets[i];
+    views[i].length = table->offsets[i + 1] - table->offsets[i] - 1;
+  }
+
+  qsort(views, table->count, sizeof(string_view), view_compare);
+
+  // Copy strings in sorted order into new buffer, so they stay in order in memory
+  size_t offset = 0;
+  for (size_t i = 0; i < table->count; i++) {
+    memcpy(data + offset, views[i].data, views[i].length + 1);
+    table->offsets[i] = offset;
+    offset += views[i].length + 1;
+  }
+
+  free(views);
+  free(table->data);
+  table->data = data;
+
+  return OK;
+}
+
+easy_error string_table_dedup(string_table *table) {
+  CHECK_NULL_PTR((table && table->offsets));
+
+  if (table->count < 2)
+    return OK;
+
+  size_t count = 1;
+  size_t last = 0; // Offset of last kept string
+  size_t last_length = table->offsets[1] - 1;
+
+  for (size_t i = 1; i < table->count; i++) {
+    size_t start = table->offsets[i];
+    size_t size = table->offsets[i + 1] - start; // With '\0'
+
+    if (size - 1 == last_length && memcmp(table->data + last, table->data + start, size) == 0)
+      continue;
+
+    // Kept strings only move to lower positions
+    size_t dst = last + last_length + 1;
+    if (dst != start)
+      memmove(table->data + dst, table->data + start, size);
+
+    table->offsets[count++] = dst;
+    last = dst;
+    last_length = size - 1;
+  }
+
+  table->count = count;
+  table->data_length = last + last_length + 1;
+  table->offsets[count] = table->data_length;
+
+  return OK;
+}
+
+easy_error string_table_write(const string_table *table, fwriter *writer) {
+  CHECK_NULL_PTR((table && table->offsets && writer && writer->fp));
+
+  uint8_t buffer[STRING_TABLE_IO_CHUNK * 8];
+  easy_error err = OK;
+
+  memcpy(buffer, STRING_TABLE_MAGIC, 4);
+  put_u32_le(buffer + 4, STRING_TABLE_VERSION);
+  put_u64_le(buffer + 8, table->count);
+  put_u64_le(buffer + 16, table->data_length);
+  if (write_bytes(writer, buffer, 1, STRING_TABLE_HEADER_SIZE, &err) != STRING_TABLE_HEADER_SIZE)
+    return (err != OK) ? err : FILE_WRITE_FAILED;
+
+  for (size_t i = 0; i < table->count; i += STRING_TABLE_IO_CHUNK) {
+    size_t n = EMIN((size_t)STRING_TABLE_IO_CHUNK, table->count - i);
+    for (size_t j = 0; j < n; j++)
+      put_u64_le(buffer + j * 8, table->offsets[i + j]);
+
+    if (write_bytes(writer, buffer, 8, n, &err) != n)
+      return (err != OK) ? err : FILE_WRITE_FAILED;
+  }
+
+  if (table->data_length > 0 &&
+      write_bytes(writer, table->data, 1, table->data_length, &err) != table->data_length)
+    return (err != OK) ? err : FILE_WRITE_FAILED;
+
+  return OK;
+}
+
+string_table *string_table_read(freader *reader, easy_error *err) {
+  if (!reader || !reader->fp) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return NULL;
+  }
+
+  uint8_t buffer[STRING_TABLE_IO_CHUNK * 8];
+  easy_error e = OK;
+
+  if (read_bytes(reader, buffer, 1, STRING_TABLE_HEADER_SIZE, &e) != STRING_TABLE_HEADER_SIZE ||
+      memcmp(buffer, STRING_TABLE_MAGIC, 4) != 0 ||
+      get_u32_le(buffer + 4) != STRING_TABLE_VERSION) {
+    SET_CODE_ERROR(err, (e != OK) ? e : FILE_READ_FAILED);
+    return NULL;
+  }
+
+  uint64_t count = get_u64_le(buffer + 8);
+  uint64_t data_length = get_u64_le(buffer + 16);
+
+  // Each string takes at least one byte ('\0')
+  if (count > data_length || data_length > SIZE_MAX / 2 || count > SIZE_MAX / sizeof(size_t) - 1) {
+    SET_CODE_ERROR(err, FILE_READ_FAILED);
+    return NULL;
+  }
+
+  string_table *table = string_table_init((size_t)count, (size_t)(data_length - count));
+  if (!table) {
+    SET_CODE_ERROR(err, ALLOCATION_FAILED);
+    return NULL;
+  }
+
+  for (size_t i = 0; i < count; i += STRING_TABLE_IO_CHUNK) {
+    size_t n = EMIN((size_t)STRING_TABLE_IO_CHUNK, (size_t)count - i);
+    if (read_bytes(reader, buffer, 8, n, &e) != n) {
+      string_table_free_(table);
+      SET_CODE_ERROR(err, (e != OK) ? e : FILE_READ_FAILED);
+      return NULL;
+    }
+
+    for (size_t j = 0; j < n; j++)
+      table->offsets[i + j] = (size_t)get_u64_le(buffer + j * 8);
+  }
+  table->offsets[count] = (size_t)data_length;
+
+  if (data_length > 0 && read_bytes(reader, table->data, 1, data_length, &e) != data_length) {
+    string_table_free_(table);
+    SET_CODE_ERROR(err, (e != OK) ? e : FILE_READ_FAILED);
+    return NULL;
+  }
+
+  // Check that offsets describe null-terminated strings in order
+  bool valid = (count == 0) ? (data_length == 0) : (table->offsets[0] == 0);
+  for (size_t i = 0; valid && i < count; i++)
+    valid = table->offsets[i] < table->offsets[i + 1] &&
+            table->data[table->offsets[i + 1] - 1] == '\0';
+
+  if (!valid) {
+    string_table_free_(table);
+    SET_CODE_ERROR(err, FILE_READ_FAILED);
+    return NULL;
+  }
+
+  table->count = (size_t)count;
+  table->data_length = (size_t)data_length;
+
+  SET_CODE_ERROR(err, OK);
+  return table;
+}
@@ -0,0 +1,600 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "estd/utf8.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define UTF8_SSE2 1
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define UTF8_X86_DISPATCH 1
+#endif
+
+/// Decode one code point. Returns length of sequence or 0 if sequence is invalid
+static inline size_t utf8_decode(const uint8_t *p, size_t avail, uint32_t *cp) {
+  uint8_t b0 = p[0];
+  if (b0 < 0x80) {
+    *cp = b0;
+    return 1;
+  }
+
+  if (b0 < 0xC2) // Continuation byte or overlong 2-byte form
+    return 0;
+
+  if (b0 < 0xE0) {
+    if (avail < 2 || (p[1] & 0xC0) != 0x80)
+      return 0;
+    *cp = (uint32_t)(b0 & 0x1F) << 6 | (p[1] & 0x3F);
+    return 2;
+  }
+
+  if (b0 < 0xF0) {
+    if (avail < 3 || (p[1] & 0xC0) != 0x80 || (p[2] & 0xC0) != 0x80)
+      return 0;
+    uint32_t c = (uint32_t)(b0 & 0x0F) << 12 | (uint32_t)(p[1] & 0x3F) << 6 | (p[2] & 0x3F);
+    if (c < 0x800 || (c >= 0xD800 && c <= 0xDFFF)) // Overlong form or surrogate
+      return 0;
+    *cp = c;
+    return 3;
+  }
+
+  if (b0 < 0xF5) {
+    if (avail < 4 || (p[1] & 0xC0) != 0x80 || (p[2] & 0xC0) != 0x80 || (p[3] & 0xC0) != 0x80)
+      return 0;
+    uint32_t c = (uint32_t)(b0 & 0x07) << 18 | (uint32_t)(p[1] & 0x3F) << 12 |
+                 (uint32_t)(p[2] & 0x3F) << 6 | (p[3] & 0x3F);
+    if (c < 0x10000 || c > 0x10FFFF)
+      return 0;
+    *cp = c;
+    return 4;
+  }
+
+  return 0;
+}
+
+/// Encode code point into out. Returns length of sequence or 0 if code point is invalid
+static inline size_t utf8_encode(uint32_t cp, char out[4]) {
+  if (cp < 0x80) {
+    out[0] = (char)cp;
+    return 1;
+  }
+
+  if (cp < 0x800) {
+    out[0] = (char)(0xC0 | (cp >> 6));
+    out[1] = (char)(0x80 | (cp & 0x3F));
+    return 2;
+  }
+
+  if (cp < 0x10000) {
+    if (cp >= 0xD800 && cp <= 0xDFFF)
+      return 0;
+    out[0] = (char)(0xE0 | (cp >> 12));
+    out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[2] = (char)(0x80 | (cp & 0x3F));
+    return 3;
+  }
+
+  if (cp <= 0x10FFFF) {
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+  }
+
+  return 0;
+}
+
+static bool utf8_validate_scalar(const uint8_t *p, size_t length) {
+  size_t i = 0;
+  while (i < length) {
+    // Skip ASCII 8 bytes at a time
+    if (length - i >= 8) {
+      uint64_t chunk;
+      memcpy(&chunk, p + i, sizeof(chunk));
+      if (!(chunk & 0x8080808080808080)) {
+        i += 8;
+        continue;
+      }
+    }
+
+    uint32_t cp;
+    size_t len = utf8_decode(p + i, length - i, &cp);
+    if (!len)
+      return false;
+    i += len;
+  }
+
+  return true;
+}
+
+static size_t utf8_count_scalar(const uint8_t *p, size_t length) {
+  size_t count = 0;
+  for (size_t i = 0; i < length; i++)
+    count += (p[i] & 0xC0) != 0x80; // Count everything except continuation bytes
+
+  return count;
+}
+
+#ifdef UTF8_X86_DISPATCH
+
+// Error bits of lookup tables
+#define TOO_SHORT (1 << 0)  // Lead byte or ASCII followed by lead byte or ASCII
+#define TOO_LONG (1 << 1)   // ASCII followed by continuation
+#define OVERLONG_3 (1 << 2) // E0 followed by 80..9F
+#define TOO_LARGE (1 << 3)  // F4 followed by 90..BF or F5..FF lead
+#define SURROGATE (1 << 4)  // ED followed by A0..BF
+#define OVERLONG_2 (1 << 5) // C0 or C1 lead
+#define TOO_LARGE_1000 (1 << 6)
+#define OVERLONG_4 (1 << 6) // F0 followed by 80..8F
+#define TWO_CONTS (1 << 7)  // Two continuation bytes in a row
+#define CARRY (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+// Tables are indexed by high nibble of previous byte, low nibble of previous byte and high
+// nibble of current byte. Valid pair of bytes gives zero after AND of three lookups.
+// Each table is repeated twice to fill both lanes of AVX2 register
+#define BYTE_1_HIGH_TABLE                                                                          \
+  TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TWO_CONTS,       \
+      TWO_CONTS, TWO_CONTS, TWO_CONTS, TOO_SHORT | OVERLONG_2, TOO_SHORT,                          \
+      TOO_SHORT | OVERLONG_3 | SURROGATE, TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+
+#define BYTE_1_LOW_TABLE                                                                           \
+  CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4, CARRY | OVERLONG_2, CARRY, CARRY,                  \
+      CARRY | TOO_LARGE, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,   \
+      CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,                      \
+      CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,                      \
+      CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,                      \
+      CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE, CARRY | TOO_LARGE | TOO_LARGE_1000,          \
+      CARRY | TOO_LARGE | TOO_LARGE_1000
+
+#define BYTE_2_HIGH_TABLE                                                                          \
+  TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,          \
+      TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,                \
+      TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,                                  \
+      TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,                                   \
+      TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE, TOO_SHORT, TOO_SHORT, TOO_SHORT,  \
+      TOO_SHORT
+
+static const uint8_t byte_1_high_table[32] = {BYTE_1_HIGH_TABLE, BYTE_1_HIGH_TABLE};
+static const uint8_t byte_1_low_table[32] = {BYTE_1_LOW_TABLE, BYTE_1_LOW_TABLE};
+static const uint8_t byte_2_high_table[32] = {BYTE_2_HIGH_TABLE, BYTE_2_HIGH_TABLE};
+
+// Saturating subtraction of this table from the last bytes of block is non zero, if they need
+// more bytes after them
+static const uint8_t incomplete_table[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF};
+
+__attribute__((target("ssse3"))) static inline __m128i
+utf8_check_block_ssse3(__m128i input, __m128i prev_input) {
+  const __m128i nibble_mask = _mm_set1_epi8(0x0F);
+  const __m128i byte_1_high = _mm_loadu_si128((const __m128i *)byte_1_high_table);
+  const __m128i byte_1_low = _mm_loadu_si128((const __m128i *)byte_1_low_table);
+  const __m128i byte_2_high = _mm_loadu_si128((const __m128i *)byte_2_high_table);
+
+  __m128i prev1 = _mm_alignr_epi8(input, prev_input, 16 - 1);
+  __m128i special_cases = _mm_and_si128(
+      _mm_and_si128(
+          _mm_shuffle_epi8(byte_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble_mask)),
+          _mm_shuffle_epi8(byte_1_low, _mm_and_si128(prev1, nibble_mask))),
+      _mm_shuffle_epi8(byte_2_high, _mm_and_si128(_mm_srli_epi16(input, 4), nibble_mask)));
+
+  // Third and fourth bytes of sequence must be continuations, it's the only allowed TWO_CONTS
+  __m128i prev2 = _mm_alignr_epi8(input, prev_input, 16 - 2);
+  __m128i prev3 = _mm_alignr_epi8(input, prev_input, 16 - 3);
+  __m128i is_third_byte = _mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xE0 - 0x80)));
+  __m128i is_fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xF0 - 0x80)));
+  __m128i must23_80 =
+      _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8((char)0x80));
+
+  return _mm_xor_si128(must23_80, special_cases);
+}
+
+__attribute__((target("ssse3"))) static bool utf8_validate_ssse3(const uint8_t *p, size_t length) {
+  const __m128i incomplete_max = _mm_loadu_si128((const __m128i *)(incomplete_table + 16));
+  __m128i error = _mm_setzero_si128();
+  __m128i prev_input = _mm_setzero_si128();
+  __m128i prev_incomplete = _mm_setzero_si128();
+
+  size_t i = 0;
+  for (; i < length; i += 16) {
+    __m128i input;
+    if (length - i >= 16) {
+      input = _mm_loadu_si128((const __m128i *)(p + i));
+    } else {
+      uint8_t tail[16] = {0}; // Zero padding is ASCII
+      memcpy(tail, p + i, length - i);
+      input = _mm_loadu_si128((const __m128i *)tail);
+    }
+
+    if (_mm_movemask_epi8(input) == 0) {
+      error = _mm_or_si128(error, prev_incomplete);
+      prev_incomplete = _mm_setzero_si128();
+    } else {
+      error = _mm_or_si128(error, utf8_check_block_ssse3(input, prev_input));
+      prev_incomplete = _mm_subs_epu8(input, incomplete_max);
+    }
+    prev_input = input;
+
+    // Stop early on error, but don't branch on every block
+    if ((i & 1023) == 0 && _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) != 0xFFFF)
+      return false;
+  }
+
+  error = _mm_or_si128(error, prev_incomplete);
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+}
+
+__attribute__((target("avx2"))) static inline __m256i utf8_check_block_avx2(__m256i input,
+                                                                            __m256i prev_input) {
+  const __m256i nibble_mask = _mm256_set1_epi8(0x0F);
+  const __m256i byte_1_high = _mm256_loadu_si256((const __m256i *)byte_1_high_table);
+  const __m256i byte_1_low = _mm256_loadu_si256((const __m256i *)byte_1_low_table);
+  const __m256i byte_2_high = _mm256_loadu_si256((const __m256i *)byte_2_high_table);
+
+  // alignr works inside 128-bit lanes, so previous bytes are taken from shifted lanes
+  __m256i shifted = _mm256_permute2x128_si256(prev_input, input, 0x21);
+  __m256i prev1 = _mm256_alignr_epi8(input, shifted, 16 - 1);
+  __m256i special_cases = _mm256_and_si256(
+      _mm256_and_si256(_mm256_shuffle_epi8(byte_1_high, _mm256_and_si256(
+                                                            _mm256_srli_epi16(prev1, 4), nibble_mask)),
+                       _mm256_shuffle_epi8(byte_1_low, _mm256_and_si256(prev1, nibble_mask))),
+      _mm256_shuffle_epi8(byte_2_high,
+                          _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble_mask)));
+
+  __m256i prev2 = _mm256_alignr_epi8(input, shifted, 16 - 2);
+  __m256i prev3 = _mm256_alignr_epi8(input, shifted, 16 - 3);
+  __m256i is_third_byte = _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xE0 - 0x80)));
+  __m256i is_fourth_byte = _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xF0 - 0x80)));
+  __m256i must23_80 = _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte),
+                                       _mm256_set1_epi8((char)0x80));
+
+  return _mm256_xor_si256(must23_80, special_cases);
+}
+
+__attribute__((target("avx2"))) static bool utf8_validate_avx2(const uint8_t *p, size_t length) {
+  const __m256i incomplete_max = _mm256_loadu_si256((const __m256i *)incomplete_table);
+  __m256i error = _mm256_setzero_si256();
+  __m256i prev_input = _mm256_setzero_si256();
+  __m256i prev_incomplete = _mm256_setzero_si256();
+
+  size_t i = 0;
+  for (; i < length; i += 32) {
+    __m256i input;
+    if (length - i >= 32) {
+      input = _mm256_loadu_si256((const __m256i *)(p + i));
+    } else {
+      uint8_t tail[32] = {0};
+      memcpy(tail, p + i, length - i);
+      input = _mm256_loadu_si256((const __m256i *)tail);
+    }
+
+    if (_mm256_movemask_epi8(input) == 0) {
+      error = _mm256_or_si256(error, prev_incomplete);
+      prev_incomplete = _mm256_setzero_si256();
+    } else {
+      error = _mm256_or_si256(error, utf8_check_block_avx2(input, prev_input));
+      prev_incomplete = _mm256_subs_epu8(input, incomplete_max);
+    }
+    prev_input = input;
+
+    if ((i & 2047) == 0 && !_mm256_testz_si256(error, error))
+      return false;
+  }
+
+  error = _mm256_or_si256(error, prev_incomplete);
+  return _mm256_testz_si256(error, error);
+}
+
+__attribute__((target("avx2"))) static size_t utf8_count_avx2(const uint8_t *p, size_t length) {
+  const __m256i last_continuation = _mm256_set1_epi8((char)0xBF); // -65 as signed char
+  size_t count = 0, i = 0;
+  for (; length - i >= 32; i += 32) {
+    __m256i input = _mm256_loadu_si256((const __m256i *)(p + i));
+    uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpgt_epi8(input, last_continuation));
+    count += (size_t)__builtin_popcount(mask);
+  }
+
+  return count + utf8_count_scalar(p + i, length - i);
+}
+
+#endif // UTF8_X86_DISPATCH
+
+#ifdef UTF8_SSE2
+static size_t utf8_count_sse2(const uint8_t *p, size_t length) {
+  const __m128i last_continuation = _mm_set1_epi8((char)0xBF);
+  size_t count = 0, i = 0;
+  for (; length - i >= 16; i += 16) {
+    __m128i input = _mm_loadu_si128((const __m128i *)(p + i));
+    unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpgt_epi8(input, last_continuation));
+    while (mask) { // Portable popcount, MSVC doesn't have __builtin_popcount
+      mask &= mask - 1;
+      count++;
+    }
+  }
+
+  return count + utf8_count_scalar(p + i, length - i);
+}
+#endif
+
+bool utf8_validate(const char *data, size_t length) {
+  if (!data)
+    return length == 0;
+
+  const uint8_t *p = (const uint8_t *)data;
+#ifdef UTF8_X86_DISPATCH
+  if (__builtin_cpu_supports("avx2"))
+    return utf8_validate_avx2(p, length);
+  if (__builtin_cpu_supports("ssse3"))
+    return utf8_validate_ssse3(p, length);
+#endif
+
+  return utf8_validate_scalar(p, length);
+}
+
+size_t utf8_count(const char *data, size_t length) {
+  if (!data)
+    return 0;
+
+  const uint8_t *p = (const uint8_t *)data;
+#ifdef UTF8_X86_DISPATCH
+  if (__builtin_cpu_supports("avx2"))
+    return utf8_count_avx2(p, length);
+#endif
+#ifdef UTF8_SSE2
+  return utf8_count_sse2(p, length);
+#else
+  return utf8_count_scalar(p, length);
+#endif
+}
+
+easy_error utf8_next(const char *data, size_t length, size_t *pos, uint32_t *cp) {
+  CHECK_NULL_PTR((data && pos && cp));
+
+  if (*pos >= length)
+    return INVALID_INDEX;
+
+  size_t len = utf8_decode((const uint8_t *)data + *pos, length - *pos, cp);
+  if (!len) {
+    (*pos)++;
+    return INVALID_ENCODING;
+  }
+
+  *pos += len;
+  return OK;
+}
+
+size_t utf8_to_utf16(const char *data, size_t length, uint16_t *out, size_t out_size,
+                     easy_error *err) {
+  if (!data && length > 0) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  const uint8_t *p = (const uint8_t *)data;
+  size_t n = 0, i = 0;
+  while (i < length) {
+#ifdef UTF8_SSE2
+    // Widen runs of ASCII 16 bytes at a time
+    if (length - i >= 16) {
+      __m128i input = _mm_loadu_si128((const __m128i *)(p + i));
+      if (_mm_movemask_epi8(input) == 0 && (!out || out_size - n >= 16)) {
+        if (out) {
+          const __m128i zero = _mm_setzero_si128();
+          _mm_storeu_si128((__m128i *)(out + n), _mm_unpacklo_epi8(input, zero));
+          _mm_storeu_si128((__m128i *)(out + n + 8), _mm_unpackhi_epi8(input, zero));
+        }
+        n += 16;
+        i += 16;
+        continue;
+      }
+    }
+#endif
+
+    uint32_t cp;
+    size_t len = utf8_decode(p + i, length - i, &cp);
+    if (!len) {
+      SET_CODE_ERROR(err, INVALID_ENCODING);
+      return n;
+    }
+
+    size_t units = (cp >= 0x10000) ? 2 : 1;
+    if (out) {
+      if (out_size - n < units) {
+        SET_CODE_ERROR(err, INVALID_ARGUMENT);
+        return n;
+      }
+
+      if (units == 1) {
+        out[n] = (uint16_t)cp;
+      } else {
+        cp -= 0x10000;
+        out[n] = (uint16_t)(0xD800 | (cp >> 10));
+        out[n + 1] = (uint16_t)(0xDC00 | (cp & 0x3FF));
+      }
+    }
+
+    n += units;
+    i += len;
+  }
+
+  SET_CODE_ERROR(err, OK);
+  return n;
+}
+
+size_t utf8_to_utf32(const char *data, size_t length, uint32_t *out, size_t out_size,
+                     easy_error *err) {
+  if (!data && length > 0) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  const uint8_t *p = (const uint8_t *)data;
+  size_t n = 0, i = 0;
+  while (i < length) {
+#ifdef UTF8_SSE2
+    if (length - i >= 16) {
+      __m128i input = _mm_loadu_si128((const __m128i *)(p + i));
+      if (_mm_movemask_epi8(input) == 0 && (!out || out_size - n >= 16)) {
+        if (out) {
+          const __m128i zero = _mm_setzero_si128();
+          __m128i lo = _mm_unpacklo_epi8(input, zero), hi = _mm_unpackhi_epi8(input, zero);
+          _mm_storeu_si128((__m128i *)(out + n), _mm_unpacklo_epi16(lo, zero));
+          _mm_storeu_si128((__m128i *)(out + n + 4), _mm_unpackhi_epi16(lo, zero));
+          _mm_storeu_si128((__m128i *)(out + n + 8), _mm_unpacklo_epi16(hi, zero));
+          _mm_storeu_si128((__m128i *)(out + n + 12), _mm_unpackhi_epi16(hi, zero));
+        }
+        n += 16;
+        i += 16;
+        continue;
+      }
+    }
+#endif
+
+    uint32_t cp;
+    size_t len = utf8_decode(p + i, length - i, &cp);
+    if (!len) {
+      SET_CODE_ERROR(err, INVALID_ENCODING);
+      return n;
+    }
+
+    if (out) {
+      if (n >= out_size) {
+        SET_CODE_ERROR(err, INVALID_ARGUMENT);
+        return n;
+      }
+      out[n] = cp;
+    }
+
+    n++;
+    i += len;
+  }
+
+  SET_CODE_ERROR(err, OK);
+  return n;
+}
+
+size_t utf16_to_utf8(const uint16_t *data, size_t length, char *out, size_t out_size,
+                     easy_error *err) {
+  if (!data && length > 0) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  size_t n = 0, i = 0;
+  while (i < length) {
+    uint32_t cp = data[i++];
+    if (cp >= 0xD800 && cp <= 0xDFFF) { // Surrogate pair
+      if (cp >= 0xDC00 || i == length || data[i] < 0xDC00 || data[i] > 0xDFFF) {
+        SET_CODE_ERROR(err, INVALID_ENCODING);
+        return n;
+      }
+      cp = 0x10000 + ((cp - 0xD800) << 10) + (uint32_t)(data[i++] - 0xDC00);
+    }
+
+    char buffer[4];
+    size_t len = utf8_encode(cp, buffer);
+    if (out) {
+      if (out_size - n < len) {
+        SET_CODE_ERROR(err, INVALID_ARGUMENT);
+        return n;
+      }
+      memcpy(out + n, buffer, len);
+    }
+    n += len;
+  }
+
+  SET_CODE_ERROR(err, OK);
+  return n;
+}
+
+size_t utf32_to_utf8(const uint32_t *data, size_t length, char *out, size_t out_size,
+                     easy_error *err) {
+  if (!data && length > 0) {
+    SET_CODE_ERROR(err, NULL_POINTER);
+    return 0;
+  }
+
+  size_t n = 0;
+  for (size_t i = 0; i < length; i++) {
+    char buffer[4];
+    size_t len = utf8_encode(data[i], buffer);
+    if (!len) {
+      SET_CODE_ERROR(err, INVALID_ENCODING);
+      return n;
+    }
+
+    if (out) {
+      if (out_size - n < len) {
+        SET_CODE_ERROR(err, INVALID_ARGUMENT);
+        return n;
+      }
+      memcpy(out + n, buffer, len);
+    }
+    n += len;
+  }
+
+  SET_CODE_ERROR(err, OK);
+  return n;
+}
+
+bool string_is_utf8(const string *str) {
+  if (!str || !str->data)
+    return false;
+
+  return utf8_validate(str->data, str->length);
+}
+
+size_t string_utf8_count(const string *str) {
+  if (!str || !str->data)
+    return 0;
+
+  return utf8_count(str->data, str->length);
+}
+
+easy_error string_append_utf16(string *str, const uint16_t *data, size_t length) {
+  CHECK_NULL_PTR((str && str->data));
+
+  easy_error err = OK;
+  size_t needed = utf16_to_utf8(data, length, NULL, 0, &err);
+  if (err != OK)
+    return err;
+
+  if (str->length + needed + 1 > str->capacity) {
+    err = string_reserve(str, (str->length + needed + 1) * 2);
+    if (err != OK)
+      return err;
+  }
+
+  utf16_to_utf8(data, length, str->data + str->length, needed, NULL);
+  str->length += needed;
+  str->data[str->length] = '\0';
+  string_invalidate_hash(str);
+
+  return OK;
+}
+
+easy_error string_append_utf32(string *str, const uint32_t *data, size_t length) {
+  CHECK_NULL_PTR((str && str->data));
+
+  easy_error err = OK;
+  size_t needed = utf32_to_utf8(data, length, NULL, 0, &err);
+  if (err != OK)
+    return err;
+
+  if (str->length + needed + 1 > str->capacity) {
+    err = string_reserve(str, (str->length + needed + 1) * 2);
+    if (err != OK)
+      return err;
+  }
+
+  utf32_to_utf8(data, length, str->data + str->length, needed, NULL);
+  str->length += needed;
+  str->data[str->length] = '\0';
+  string_invalidate_hash(str);
+
+  return OK;
+}
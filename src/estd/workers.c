@@ -0,0 +1,33 @@
+#include "workers.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#include <unistd.h>
+#define WORKERS_POSIX 1
+#endif
+
+void run_workers(void *(*worker)(void *), void *arg, size_t nthreads, size_t jobs) {
+#ifdef WORKERS_POSIX
+  if (nthreads == 0) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = (cpus > 0) ? (size_t)cpus : 1;
+  }
+  if (nthreads > jobs)
+    nthreads = jobs;
+  if (nthreads > WORKERS_MAX_THREADS)
+    nthreads = WORKERS_MAX_THREADS;
+
+  pthread_t threads[WORKERS_MAX_THREADS];
+  size_t started = 0;
+  while (started + 1 < nthreads && pthread_create(&threads[started], NULL, worker, arg) == 0)
+    started++;
+
+  worker(arg);
+  for (size_t i = 0; i < started; i++)
+    pthread_join(threads[i], NULL);
+#else
+  (void)nthreads;
+  (void)jobs;
+  worker(arg);
+#endif
+}
@@ -0,0 +1,19 @@
+#ifndef WORKERS_H
+#define WORKERS_H
+
+/*
+Internal pool of short-lived threads, used by read_file_parallel (efile.c) and merkle hashing
+(merkle.c). Worker takes jobs from shared state by itself until nothing is left, so any count of
+workers gives same result. On systems without pthreads worker is run only by calling thread
+*/
+
+#include <stddef.h>
+
+#define WORKERS_MAX_THREADS 64 // Max count of threads of one run
+
+/// Run worker(arg) by nthreads threads, calling thread is one of them. 0 means count of CPUs,
+/// count is also limited by jobs (count of parts of work) and WORKERS_MAX_THREADS.
+/// If thread can't be created, others do more jobs. Returns when all workers are finished
+void run_workers(void *(*worker)(void *), void *arg, size_t nthreads, size_t jobs);
+
+#endif // WORKERS_H
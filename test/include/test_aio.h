@@ -0,0 +1,10 @@
+#ifndef TEST_AIO_H
+#define TEST_AIO_H
+
+#include <check.h>
+#include <estd/aio.h>
+#include <estd/eerror.h>
+
+Suite *aio_suite();
+
+#endif // TEST_AIO_H
@@ -0,0 +1,10 @@
+#ifndef TEST_CODEC_H
+#define TEST_CODEC_H
+
+#include <check.h>
+#include <estd/codec.h>
+#include <estd/eerror.h>
+
+Suite *codec_suite();
+
+#endif // TEST_CODEC_H
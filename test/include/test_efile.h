@@ -0,0 +1,10 @@
+#ifndef TEST_EFILE_H
+#define TEST_EFILE_H
+
+#include <check.h>
+#include <estd/eerror.h>
+#include <estd/efile.h>
+
+Suite *efile_suite();
+
+#endif // TEST_EFILE_H
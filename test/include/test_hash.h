@@ -0,0 +1,10 @@
+#ifndef TEST_HASH_H
+#define TEST_HASH_H
+
+#include <check.h>
+#include <estd/eerror.h>
+#include <estd/hash.h>
+
+Suite *hash_suite();
+
+#endif // TEST_HASH_H
@@ -0,0 +1,10 @@
+#ifndef TEST_INTERN_H
+#define TEST_INTERN_H
+
+#include <check.h>
+#include <estd/eerror.h>
+#include <estd/intern.h>
+
+Suite *intern_suite();
+
+#endif // TEST_INTERN_H
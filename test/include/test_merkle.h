@@ -0,0 +1,10 @@
+#ifndef TEST_MERKLE_H
+#define TEST_MERKLE_H
+
+#include <check.h>
+#include <estd/eerror.h>
+#include <estd/merkle.h>
+
+Suite *merkle_suite();
+
+#endif // TEST_MERKLE_H
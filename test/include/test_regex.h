@@ -0,0 +1,10 @@
+#ifndef TEST_REGEX_H
+#define TEST_REGEX_H
+
+#include <check.h>
+#include <estd/eerror.h>
+#include <estd/regex.h>
+
+Suite *regex_suite();
+
+#endif // TEST_REGEX_H
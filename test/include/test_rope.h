@@ -0,0 +1,10 @@
+#ifndef TEST_ROPE_H
+#define TEST_ROPE_H
+
+#include <check.h>
+#include <estd/eerror.h>
+#include <estd/rope.h>
+
+Suite *rope_suite();
+
+#endif // TEST_ROPE_H
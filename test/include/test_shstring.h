@@ -0,0 +1,10 @@
+#ifndef TEST_SHSTRING_H
+#define TEST_SHSTRING_H
+
+#include <check.h>
+#include <estd/eerror.h>
+#include <estd/shstring.h>
+
+Suite *shared_string_suite();
+
+#endif // TEST_SHSTRING_H
@@ -0,0 +1,10 @@
+#ifndef TEST_STRBUILDER_H
+#define TEST_STRBUILDER_H
+
+#include <check.h>
+#include <estd/eerror.h>
+#include <estd/strbuilder.h>
+
+Suite *string_builder_suite();
+
+#endif // TEST_STRBUILDER_H
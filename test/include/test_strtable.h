@@ -0,0 +1,10 @@
+#ifndef TEST_STRTABLE_H
+#define TEST_STRTABLE_H
+
+#include <check.h>
+#include <estd/eerror.h>
+#include <estd/strtable.h>
+
+Suite *string_table_suite();
+
+#endif // TEST_STRTABLE_H
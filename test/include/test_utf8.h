@@ -0,0 +1,10 @@
+#ifndef TEST_UTF8_H
+#define TEST_UTF8_H
+
+#include <check.h>
+#include <estd/eerror.h>
+#include <estd/utf8.h>
+
+Suite *utf8_suite();
+
+#endif // TEST_UTF8_H
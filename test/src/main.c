@@ -1,6 +1,18 @@
+#include "test_aio.h"
 #include "test_array.h"
+#include "test_codec.h"
+#include "test_efile.h"
 #include "test_estring.h"
 #include "test_grow.h"
+#include "test_hash.h"
+#include "test_intern.h"
+#include "test_merkle.h"
+#include "test_regex.h"
+#include "test_rope.h"
+#include "test_shstring.h"
+#include "test_strbuilder.h"
+#include "test_strtable.h"
+#include "test_utf8.h"
 
 #include <check.h>
 
@@ -11,6 +23,18 @@ int main() {
   srunner_add_suite(sr, string_suit());
   srunner_add_suite(sr, array_suite());
   srunner_add_suite(sr, grow_suite());
+  srunner_add_suite(sr, string_builder_suite());
+  srunner_add_suite(sr, utf8_suite());
+  srunner_add_suite(sr, intern_suite());
+  srunner_add_suite(sr, string_table_suite());
+  srunner_add_suite(sr, shared_string_suite());
+  srunner_add_suite(sr, rope_suite());
+  srunner_add_suite(sr, regex_suite());
+  srunner_add_suite(sr, codec_suite());
+  srunner_add_suite(sr, efile_suite());
+  srunner_add_suite(sr, aio_suite());
+  srunner_add_suite(sr, hash_suite());
+  srunner_add_suite(sr, merkle_suite());
   srunner_run_all(sr, CK_NORMAL);
 
   number_failed = srunner_ntests_failed(sr);
@@ -0,0 +1,173 @@
+#include <check.h>
+#include <estd/aio.h>
+#include <estd/eerror.h>
+#include <estd/efile.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_aio.h"
+
+#define BLOCK_SIZE 4096
+#define BLOCKS 64
+
+static void count_completion(aio_request *req, void *ctx) {
+  if (req->error == OK)
+    (*(int *)ctx)++;
+}
+
+// Tests:
+START_TEST(test_aio_read_write) {
+  int backends[] = {AIO_DEFAULT, AIO_FORCE_THREADS};
+  char *data = (char *)malloc(BLOCK_SIZE * BLOCKS);
+  char *copy = (char *)malloc(BLOCK_SIZE * BLOCKS);
+  for (size_t i = 0; i < BLOCK_SIZE * BLOCKS; i++)
+    data[i] = (char)(i * 7 + i / BLOCK_SIZE);
+
+  for (int b = 0; b < 2; b++) {
+    easy_error err = OK;
+    aio_context *ctx = aio_init(8, backends[b], &err);
+    ck_assert_int_eq(err, OK);
+    ck_assert_ptr_nonnull(ctx);
+    if (backends[b] == AIO_FORCE_THREADS)
+      ck_assert(!aio_uses_io_uring(ctx));
+
+    // Blocks are written in reverse order, more requests than queue depth
+    fwriter *writer = openw("aio_data.bin", WRITE_BIN, NULL);
+    aio_request writes[BLOCKS];
+    int written = 0;
+    for (int i = 0; i < BLOCKS; i++) {
+      int block = BLOCKS - 1 - i;
+      aio_prep_write(&writes[i], writer, data + block * BLOCK_SIZE, BLOCK_SIZE,
+                     (uint64_t)block * BLOCK_SIZE);
+      writes[i].callback = count_completion;
+      writes[i].ctx = &written;
+    }
+    ck_assert_int_eq(aio_submit(ctx, writes, BLOCKS), OK);
+    ck_assert_int_eq(aio_wait(ctx, BLOCKS, &err), BLOCKS);
+    ck_assert_int_eq(err, OK);
+    ck_assert_int_eq(written, BLOCKS);
+    ck_assert_int_eq(aio_pending(ctx), 0);
+    for (int i = 0; i < BLOCKS; i++) {
+      ck_assert(writes[i].done);
+      ck_assert_int_eq(writes[i].result, BLOCK_SIZE);
+    }
+    closew(writer);
+
+    // Reads are collected by polling, last one is short because of end of file
+    freader *reader = openr("aio_data.bin", READ_BIN, NULL);
+    aio_request reads[BLOCKS];
+    memset(copy, 0, BLOCK_SIZE * BLOCKS);
+    for (int i = 0; i < BLOCKS; i++)
+      aio_prep_read(&reads[i], reader, copy + i * BLOCK_SIZE,
+                    (i == BLOCKS - 1) ? 2 * BLOCK_SIZE : BLOCK_SIZE, (uint64_t)i * BLOCK_SIZE);
+    ck_assert_int_eq(aio_submit(ctx, reads, BLOCKS - 1), OK);
+    ck_assert_int_eq(aio_submit(ctx, reads + BLOCKS - 1, 1), OK);
+
+    size_t collected = 0;
+    while (collected < BLOCKS) {
+      collected += aio_poll(ctx);
+      if (collected < BLOCKS)
+        collected += aio_wait(ctx, 1, NULL);
+    }
+    ck_assert_int_eq(collected, BLOCKS);
+    ck_assert_int_eq(aio_poll(ctx), 0);
+    ck_assert_int_eq(reads[BLOCKS - 1].result, BLOCK_SIZE);
+    ck_assert_int_eq(reads[0].error, OK);
+    ck_assert_int_eq(memcmp(copy, data, BLOCK_SIZE * BLOCKS), 0);
+    ck_assert_int_eq(reader->pos, 0);
+    closer(reader);
+
+    aio_free(ctx);
+    ck_assert_ptr_null(ctx);
+  }
+
+  remove("aio_data.bin");
+  free(data);
+  free(copy);
+}
+END_TEST
+
+START_TEST(test_aio_registered_buffers) {
+  int backends[] = {AIO_DEFAULT, AIO_FORCE_THREADS};
+  char text[] = "registered buffers are mapped once";
+  size_t length = strlen(text);
+
+  fwriter *writer = openw("aio_fixed.txt", WRITE_BIN, NULL);
+  writef(writer, "%s", text);
+  closew(writer);
+
+  for (int b = 0; b < 2; b++) {
+    aio_context *ctx = aio_init(4, backends[b], NULL);
+    char buffer[64] = {0};
+    void *buffers[] = {buffer};
+    size_t sizes[] = {sizeof(buffer)};
+    ck_assert_int_eq(aio_register_buffers(ctx, buffers, sizes, 1), OK);
+    ck_assert_int_eq(aio_register_buffers(ctx, buffers, sizes, 1), INVALID_ARGUMENT);
+
+    freader *reader = openr("aio_fixed.txt", READ_BIN, NULL);
+    aio_request req;
+    aio_prep_read(&req, reader, buffer + 8, length, 0);
+    req.buffer_index = 0;
+    ck_assert_int_eq(aio_submit(ctx, &req, 1), OK);
+    ck_assert_int_eq(aio_wait(ctx, 1, NULL), 1);
+    ck_assert_int_eq(req.result, length);
+    ck_assert_int_eq(memcmp(buffer + 8, text, length), 0);
+
+    // Request out of registered buffer isn't submitted
+    aio_prep_read(&req, reader, buffer + 32, 64, 0);
+    req.buffer_index = 0;
+    ck_assert_int_eq(aio_submit(ctx, &req, 1), INVALID_ARGUMENT);
+    req.buffer_index = 1;
+    ck_assert_int_eq(aio_submit(ctx, &req, 1), INVALID_ARGUMENT);
+    ck_assert_int_eq(aio_pending(ctx), 0);
+
+    closer(reader);
+    aio_free(ctx);
+  }
+
+  remove("aio_fixed.txt");
+}
+END_TEST
+
+START_TEST(test_aio_errors) {
+  easy_error err = OK;
+  ck_assert_ptr_null(aio_init(0, AIO_DEFAULT, &err));
+  ck_assert_int_eq(err, INVALID_ARGUMENT);
+
+  aio_context *ctx = aio_init(2, AIO_FORCE_THREADS, NULL);
+  aio_request req;
+  aio_prep_read(&req, NULL, NULL, 0, 0);
+  ck_assert_int_eq(aio_submit(ctx, &req, 1), INVALID_ARGUMENT);
+  ck_assert_int_eq(aio_submit(NULL, &req, 1), NULL_POINTER);
+  ck_assert_int_eq(aio_wait(ctx, 1, NULL), 0);
+
+  // Writing into file opened for reading fails
+  fwriter *writer = openw("aio_readonly.txt", WRITE, NULL);
+  closew(writer);
+  freader *reader = openr("aio_readonly.txt", READ, NULL);
+  char data[] = "data";
+  aio_prep_read(&req, reader, data, 4, 0);
+  req.op = AIO_WRITE;
+  ck_assert_int_eq(aio_submit(ctx, &req, 1), OK);
+  ck_assert_int_eq(aio_wait(ctx, 1, NULL), 1);
+  ck_assert_int_eq(req.error, FILE_WRITE_FAILED);
+  closer(reader);
+  remove("aio_readonly.txt");
+
+  aio_free(ctx);
+}
+END_TEST
+
+Suite *aio_suite() {
+  Suite *s = suite_create("Aio");
+  TCase *tc_aio = tcase_create("Core");
+
+  tcase_add_test(tc_aio, test_aio_read_write);
+  tcase_add_test(tc_aio, test_aio_registered_buffers);
+  tcase_add_test(tc_aio, test_aio_errors);
+
+  suite_add_tcase(s, tc_aio);
+
+  return s;
+}
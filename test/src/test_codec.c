@@ -0,0 +1,169 @@
+#include <check.h>
+#include <estd/codec.h>
+#include <estd/eerror.h>
+#include <estd/estring.h>
+#include <string.h>
+
+#include "test_codec.h"
+
+// Tests:
+START_TEST(test_hex) {
+  easy_error err = OK;
+  char out[64];
+  uint8_t bytes[32];
+
+  ck_assert_int_eq(hex_encode("\x01\xab\xff", 3, out, sizeof(out), &err), 6);
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(memcmp(out, "01abff", 6), 0);
+  ck_assert_int_eq(hex_encode("abc", 3, NULL, 0, NULL), 6);
+  hex_encode("abc", 3, out, 5, &err);
+  ck_assert_int_eq(err, INVALID_ARGUMENT);
+
+  ck_assert_int_eq(hex_decode("01ABff", 6, bytes, sizeof(bytes), &err), 3);
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(memcmp(bytes, "\x01\xab\xff", 3), 0);
+
+  hex_decode("01a", 3, bytes, sizeof(bytes), &err);
+  ck_assert_int_eq(err, INVALID_ENCODING);
+  hex_decode("0g", 2, bytes, sizeof(bytes), &err);
+  ck_assert_int_eq(err, INVALID_ENCODING);
+
+  // Long enough for SIMD code, with bad char near the end
+  char text[65];
+  memset(text, 'a', 64);
+  text[64] = '\0';
+  ck_assert_int_eq(hex_decode(text, 64, bytes, sizeof(bytes), &err), 32);
+  ck_assert_int_eq(bytes[31], 0xaa);
+  text[61] = 'x';
+  ck_assert_int_eq(hex_decode(text, 64, bytes, sizeof(bytes), &err), 30);
+  ck_assert_int_eq(err, INVALID_ENCODING);
+}
+END_TEST
+
+START_TEST(test_base64) {
+  const char *plain[] = {"", "f", "fo", "foo", "foob", "fooba", "foobar"};
+  const char *encoded[] = {"", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==", "Zm9vYmE=", "Zm9vYmFy"};
+  easy_error err = OK;
+  char out[16];
+
+  for (size_t i = 0; i < sizeof(plain) / sizeof(plain[0]); i++) {
+    size_t n = base64_encode(plain[i], strlen(plain[i]), out, sizeof(out), BASE64_STANDARD, &err);
+    ck_assert_int_eq(err, OK);
+    ck_assert_int_eq(n, strlen(encoded[i]));
+    ck_assert_int_eq(memcmp(out, encoded[i], n), 0);
+
+    n = base64_decode(encoded[i], strlen(encoded[i]), out, sizeof(out), BASE64_STANDARD, &err);
+    ck_assert_int_eq(err, OK);
+    ck_assert_int_eq(n, strlen(plain[i]));
+    ck_assert_int_eq(memcmp(out, plain[i], n), 0);
+  }
+
+  // URL alphabet has no padding
+  ck_assert_int_eq(base64_encode("\xfb\xff", 2, out, sizeof(out), BASE64_URL, NULL), 3);
+  ck_assert_int_eq(memcmp(out, "-_8", 3), 0);
+  ck_assert_int_eq(base64_decode("-_8", 3, out, sizeof(out), BASE64_URL, &err), 2);
+  ck_assert_int_eq(err, OK);
+  base64_decode("-_8=", 4, out, sizeof(out), BASE64_STANDARD, &err);
+  ck_assert_int_eq(err, INVALID_ENCODING);
+
+  const char *bad[] = {"Z", "Zg=a", "Z===", "Zm9v!A==", "Zg==Zg=="};
+  for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+    base64_decode(bad[i], strlen(bad[i]), out, sizeof(out), BASE64_STANDARD, &err);
+    ck_assert_int_eq(err, INVALID_ENCODING);
+  }
+}
+END_TEST
+
+START_TEST(test_codec_string) {
+  uint8_t data[1000];
+  for (size_t i = 0; i < sizeof(data); i++)
+    data[i] = (uint8_t)(i * 7);
+
+  string *str = string_from_cstr("data:");
+  ck_assert_int_eq(OK, string_append_base64_encoded(str, data, sizeof(data), BASE64_URL));
+  ck_assert_int_eq(string_length(str), 5 + 1334);
+
+  string *decoded = string_init_empty();
+  ck_assert_int_eq(OK, string_append_base64_decoded(decoded, string_cstr(str) + 5, 1334,
+                                                    BASE64_URL));
+  ck_assert_int_eq(string_length(decoded), sizeof(data));
+  ck_assert_int_eq(memcmp(string_cstr(decoded), data, sizeof(data)), 0);
+
+  ck_assert_int_eq(INVALID_ENCODING, string_append_hex_decoded(decoded, "abc", 3));
+  ck_assert_int_eq(string_length(decoded), sizeof(data));
+
+  string_clear(str);
+  ck_assert_int_eq(OK, string_append_hex_encoded(str, data, 4));
+  ck_assert_str_eq(string_cstr(str), "00070e15");
+  ck_assert_int_eq(OK, string_append_hex_decoded(str, "2121", 4));
+  ck_assert_str_eq(string_cstr(str), "00070e15!!");
+
+  string_free(decoded);
+  string_free(str);
+}
+END_TEST
+
+START_TEST(test_codec_stream) {
+  uint8_t data[777];
+  for (size_t i = 0; i < sizeof(data); i++)
+    data[i] = (uint8_t)(i * 13 + 5);
+
+  char expected[BASE64_ENCODED_SIZE(sizeof(data))], text[BASE64_ENCODED_SIZE(sizeof(data))];
+  size_t length = base64_encode(data, sizeof(data), expected, sizeof(expected), BASE64_STANDARD,
+                                NULL);
+
+  // Encode and decode by uneven chunks
+  base64_encoder enc;
+  base64_encoder_init(&enc, BASE64_STANDARD);
+  size_t n = 0;
+  for (size_t i = 0; i < sizeof(data); i += 50)
+    n += base64_encoder_update(&enc, data + i, (sizeof(data) - i < 50) ? sizeof(data) - i : 50,
+                               text + n, sizeof(text) - n, NULL);
+  n += base64_encoder_final(&enc, text + n, sizeof(text) - n, NULL);
+  ck_assert_int_eq(n, length);
+  ck_assert_int_eq(memcmp(text, expected, n), 0);
+
+  uint8_t bytes[sizeof(data) + 3];
+  easy_error err = OK;
+  base64_decoder dec;
+  base64_decoder_init(&dec, BASE64_STANDARD);
+  n = 0;
+  for (size_t i = 0; i < length; i += 37)
+    n += base64_decoder_update(&dec, text + i, (length - i < 37) ? length - i : 37, bytes + n,
+                               sizeof(bytes) - n, &err);
+  ck_assert_int_eq(err, OK);
+  n += base64_decoder_final(&dec, bytes + n, sizeof(bytes) - n, &err);
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(n, sizeof(data));
+  ck_assert_int_eq(memcmp(bytes, data, n), 0);
+
+  // Pair of hex digits is split between chunks
+  hex_decoder hex;
+  hex_decoder_init(&hex);
+  n = hex_decoder_update(&hex, "a", 1, bytes, sizeof(bytes), NULL);
+  n += hex_decoder_update(&hex, "bcd", 3, bytes + n, sizeof(bytes) - n, NULL);
+  ck_assert_int_eq(n, 2);
+  ck_assert_int_eq(bytes[0], 0xab);
+  ck_assert_int_eq(bytes[1], 0xcd);
+  ck_assert_int_eq(hex_decoder_final(&hex), OK);
+  hex_decoder_update(&hex, "a", 1, bytes, sizeof(bytes), NULL);
+  ck_assert_int_eq(hex_decoder_final(&hex), INVALID_ENCODING);
+}
+END_TEST
+
+Suite *codec_suite() {
+  Suite *s = suite_create("Codec");
+  TCase *tc_codec_hex = tcase_create("Hex"), *tc_codec_base64 = tcase_create("Base64"),
+        *tc_codec_stream = tcase_create("Stream");
+
+  tcase_add_test(tc_codec_hex, test_hex);
+  tcase_add_test(tc_codec_base64, test_base64);
+  tcase_add_test(tc_codec_base64, test_codec_string);
+  tcase_add_test(tc_codec_stream, test_codec_stream);
+
+  suite_add_tcase(s, tc_codec_hex);
+  suite_add_tcase(s, tc_codec_base64);
+  suite_add_tcase(s, tc_codec_stream);
+
+  return s;
+}
@@ -0,0 +1,520 @@
+#include <check.h>
+#include <estd/eerror.h>
+#include <estd/efile.h>
+#include <estd/estring.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "test_efile.h"
+
+#define POSITIONED_RECORDS 4096
+#define POSITIONED_THREADS 8
+
+typedef struct positioned_job {
+  freader *reader;
+  int first;
+  int mismatches;
+} positioned_job;
+
+// Each record is its number in 8 chars
+static void *read_records_at(void *arg) {
+  positioned_job *job = (positioned_job *)arg;
+  for (int i = job->first; i < POSITIONED_RECORDS; i += POSITIONED_THREADS) {
+    char record[9] = {0}, expected[12];
+    snprintf(expected, sizeof(expected), "%08d", i);
+    if (read_bytes_at(job->reader, (uint64_t)i * 8, record, 8, NULL) != 8 ||
+        strcmp(record, expected) != 0)
+      job->mismatches++;
+  }
+
+  return NULL;
+}
+
+// Tests:
+START_TEST(test_read_file_mapped) {
+  easy_error err = OK;
+
+  fwriter *writer = openw("efile_mapped.txt", WRITE_BIN, NULL);
+  for (int i = 0; i < 10000; i++)
+    writef(writer, "line %d\n", i);
+  closew(writer);
+
+  freader *reader = freader_mmap("efile_mapped.txt", FILE_MAP_SEQUENTIAL | FILE_MAP_WILLNEED, &err);
+  ck_assert_int_eq(err, OK);
+  string_view view = read_file_mapped(reader, &err);
+  ck_assert_int_eq(err, OK);
+
+  string *copy = read_file(reader, NULL);
+  ck_assert_int_eq(view.length, string_length(copy));
+  ck_assert_int_eq(memcmp(view.data, string_cstr(copy), view.length), 0);
+  ck_assert_int_eq(memcmp(view.data + view.length - 10, "line 9999\n", 10), 0);
+  string_free(copy);
+  closer(reader);
+
+  // File opened by openr is mapped on first call
+  reader = openr("efile_mapped.txt", READ, NULL);
+  ck_assert_int_eq(read_file_mapped(reader, &err).length, view.length);
+  ck_assert_int_eq(err, OK);
+  closer(reader);
+  remove("efile_mapped.txt");
+
+  writer = openw("efile_empty.txt", WRITE, NULL);
+  closew(writer);
+  reader = freader_mmap("efile_empty.txt", FILE_MAP_NORMAL, &err);
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(read_file_mapped(reader, &err).length, 0);
+  closer(reader);
+  remove("efile_empty.txt");
+
+  ck_assert_ptr_null(freader_mmap("efile_missing.txt", FILE_MAP_NORMAL, &err));
+  ck_assert_int_eq(err, FILE_OPEN_ERROR);
+
+#ifdef __linux__
+  // Pipes and pseudo-files have no size, their content isn't lost as empty view
+  reader = openr("/proc/self/status", READ, NULL);
+  ck_assert_int_eq(read_file_mapped(reader, &err).length, 0);
+  ck_assert_int_eq(err, INVALID_ARGUMENT);
+  closer(reader);
+
+  remove("efile_mapped.fifo");
+  ck_assert_int_eq(mkfifo("efile_mapped.fifo", 0600), 0);
+  int fd = open("efile_mapped.fifo", O_RDWR); // Keeps openr from blocking
+  reader = openr("efile_mapped.fifo", READ, NULL);
+  ck_assert_ptr_nonnull(reader);
+  ck_assert_int_eq(read_file_mapped(reader, &err).length, 0);
+  ck_assert_int_eq(err, INVALID_ARGUMENT);
+  closer(reader);
+  close(fd);
+  remove("efile_mapped.fifo");
+#endif
+}
+END_TEST
+
+START_TEST(test_line_reader) {
+  easy_error err = OK;
+  char long_line[100];
+  memset(long_line, 'x', sizeof(long_line) - 1);
+  long_line[sizeof(long_line) - 1] = '\0';
+
+  fwriter *writer = openw("efile_lines.txt", WRITE_BIN, NULL);
+  writef(writer, "first\r\n\n%s\r\nshort\nlast", long_line);
+  closew(writer);
+
+  const char *expected[] = {"first", "", long_line, "short", "last"};
+  freader *reader = openr("efile_lines.txt", READ_BIN, NULL);
+  line_reader *lr = line_reader_init(reader, 16, true, &err); // Long line makes buffer grow
+  ck_assert_int_eq(err, OK);
+
+  string_view line;
+  size_t count = 0;
+  while (line_reader_next(lr, &line, &err)) {
+    ck_assert_int_eq(line.length, strlen(expected[count]));
+    ck_assert_int_eq(memcmp(line.data, expected[count], line.length), 0);
+    count++;
+    ck_assert_int_eq(lr->line_number, count);
+  }
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(count, 5);
+  ck_assert(!line_reader_next(lr, &line, &err));
+  line_reader_free(lr);
+  ck_assert_ptr_null(lr);
+
+  // Without strip_cr '\r' stays in line
+  file_rewind(reader);
+  lr = line_reader_init(reader, 0, false, NULL);
+  ck_assert(line_reader_next(lr, &line, NULL));
+  ck_assert_int_eq(line.length, 6);
+  line_reader_free(lr);
+
+  closer(reader);
+  remove("efile_lines.txt");
+}
+END_TEST
+
+START_TEST(test_file_position) {
+  fwriter *writer = openw("efile_pos.bin", WRITE_BIN, NULL);
+  for (int i = 0; i < 100; i++) {
+    write_bytes(writer, "record", 1, 6, NULL);
+    writef(writer, "%03d\n", i);
+  }
+  ck_assert_int_eq(file_position(writer), 1000);
+  ck_assert_int_eq(file_seek(writer, 10, SEEK_SET), 0);
+  ck_assert_int_eq(file_position(writer), 10);
+  closew(writer);
+
+  // Writes in append mode go to end of file even after seek
+  writer = openw("efile_pos.bin", APPEND_BIN, NULL);
+  write_bytes(writer, "tail", 1, 4, NULL);
+  ck_assert_int_eq(file_position(writer), 1004);
+  file_rewind(writer);
+  ck_assert_int_eq(file_position(writer), 0);
+  writef(writer, "%s", "!");
+  ck_assert_int_eq(file_position(writer), 1005);
+  closew(writer);
+
+  char buffer[16];
+  freader *reader = openr("efile_pos.bin", READ_BIN, NULL);
+  read_bytes(reader, buffer, 1, 10, NULL);
+  ck_assert_int_eq(file_position(reader), 10);
+  string *line = read_line(reader, NULL);
+  ck_assert_int_eq(file_position(reader), 20);
+  ck_assert_int_eq(file_position(reader), ftell(reader->fp));
+  string_free(line);
+
+  int value = 0;
+  file_seek(reader, 6, SEEK_SET);
+  ck_assert_int_eq(readf(reader, "%d", &value), 1);
+  ck_assert_int_eq(file_position(reader), 9);
+
+  file_seek(reader, 1000, SEEK_SET);
+  ck_assert_int_eq(read_bytes(reader, buffer, 2, 8, NULL), 2); // Half of element at end of file
+  ck_assert_int_eq(file_position(reader), 1005);
+  closer(reader);
+  remove("efile_pos.bin");
+}
+END_TEST
+
+START_TEST(test_buffered_writer) {
+  easy_error err = OK;
+  struct stat st;
+  string *expected = string_init_empty();
+
+  fwriter *writer = openw("efile_buffered.txt", WRITE_BIN, NULL);
+  fwriter_policy policy = {.flush_records = 3};
+  ck_assert_int_eq(OK, fwriter_set_buffer(writer, 64, &policy));
+
+  write_bytes(writer, "ab", 1, 2, &err);
+  writef(writer, "%d;", 42);
+  string_append(expected, "ab42;");
+  stat("efile_buffered.txt", &st);
+  ck_assert_int_eq(st.st_size, 0); // Still in buffer
+
+  write_bytes(writer, "c", 1, 1, &err);
+  string_append(expected, "c");
+  stat("efile_buffered.txt", &st);
+  ck_assert_int_eq(st.st_size, 6); // Third record flushes buffer
+
+  // Many pieces and text longer than buffer
+  string_view parts[100];
+  for (int i = 0; i < 100; i++) {
+    parts[i] = (string_view){(i % 2) ? "xyz" : "-", (i % 2) ? 3 : 1};
+    string_append_n(expected, parts[i].data, parts[i].length);
+  }
+  ck_assert_int_eq(write_bytesv(writer, parts, 100, &err), 200);
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(writef(writer, "%0100d", 7), 100);
+  string_appendf(expected, "%0100d", 7);
+  ck_assert_int_eq(file_position(writer), 306);
+
+  ck_assert_int_eq(OK, fwriter_sync(writer));
+  stat("efile_buffered.txt", &st);
+  ck_assert_int_eq(st.st_size, 306);
+  ck_assert_int_eq(OK, closew(writer));
+
+  freader *reader = openr("efile_buffered.txt", READ_BIN, NULL);
+  string *text = read_file(reader, NULL);
+  ck_assert_str_eq(string_cstr(text), string_cstr(expected));
+  closer(reader);
+  remove("efile_buffered.txt");
+
+  string_free(text);
+  string_free(expected);
+}
+END_TEST
+
+START_TEST(test_buffered_writer_errors) {
+  easy_error err = OK;
+  size_t size = 100 * 1024;
+  char *data = (char *)malloc(size);
+  char *received = (char *)malloc(size);
+  for (size_t i = 0; i < size; i++)
+    data[i] = (char)(i * 7 + i / 1000);
+
+  // Pipe takes only part of buffer, the rest stays in buffer and is written by next flush
+  remove("efile_short.fifo");
+  ck_assert_int_eq(mkfifo("efile_short.fifo", 0600), 0);
+  int fd = open("efile_short.fifo", O_RDONLY | O_NONBLOCK);
+  fwriter *writer = openw("efile_short.fifo", WRITE_BIN, NULL);
+  ck_assert_ptr_nonnull(writer);
+  int wfd = fileno(writer->fp);
+  fcntl(wfd, F_SETFL, fcntl(wfd, F_GETFL) | O_NONBLOCK);
+  ck_assert_int_eq(OK, fwriter_set_buffer(writer, 2 * size, NULL));
+  ck_assert_int_eq(write_bytes(writer, data, 1, size, &err), size);
+  ck_assert_int_eq(fwriter_flush(writer), FILE_WRITE_FAILED);
+  ck_assert_int_gt(writer->buffered, 0);
+  ck_assert_int_gt(size, writer->buffered);
+
+  size_t got = 0;
+  while (got < size) {
+    ssize_t n = read(fd, received + got, size - got);
+    if (n > 0)
+      got += (size_t)n;
+    else if (writer->buffered > 0)
+      fwriter_flush(writer);
+    else
+      break;
+  }
+  ck_assert_int_eq(writer->buffered, 0);
+  ck_assert_int_eq(memcmp(received, data, size), 0);
+  ck_assert_int_eq(closew(writer), OK);
+  close(fd);
+
+  // Buffer and big piece are written together, pipe takes only their start. Written part of piece
+  // is returned
+  fd = open("efile_short.fifo", O_RDONLY | O_NONBLOCK);
+  writer = openw("efile_short.fifo", WRITE_BIN, NULL);
+  wfd = fileno(writer->fp);
+  fcntl(wfd, F_SETFL, fcntl(wfd, F_GETFL) | O_NONBLOCK);
+  ck_assert_int_eq(OK, fwriter_set_buffer(writer, 4096, NULL));
+  ck_assert_int_eq(write_bytes(writer, "abc", 1, 3, &err), 3);
+  string_view piece = {data, size};
+  size_t written = write_bytesv(writer, &piece, 1, &err);
+  ck_assert_int_eq(err, FILE_WRITE_FAILED);
+  ck_assert_int_gt(written, 0);
+  ck_assert_int_gt(size, written);
+  ck_assert_int_eq(writer->buffered, 0);
+
+  got = 0;
+  ssize_t n;
+  while ((n = read(fd, received + got, size - got)) > 0)
+    got += (size_t)n;
+  ck_assert_int_eq(got, written + 3);
+  ck_assert_int_eq(memcmp(received, "abc", 3), 0);
+  ck_assert_int_eq(memcmp(received + 3, data, written), 0);
+  closew(writer);
+  close(fd);
+  remove("efile_short.fifo");
+
+  // Size of data overflows
+  writer = openw("efile_short.txt", WRITE_BIN, NULL);
+  fwriter_set_buffer(writer, 0, NULL);
+  ck_assert_int_eq(write_bytes(writer, data, SIZE_MAX / 2, 3, &err), 0);
+  ck_assert_int_eq(err, INVALID_ARGUMENT);
+  closew(writer);
+  remove("efile_short.txt");
+
+#ifdef __linux__
+  // Full disk: data isn't lost, flush can be repeated
+  writer = openw("/dev/full", WRITE_BIN, NULL);
+  fwriter_set_buffer(writer, 64, NULL);
+  write_bytes(writer, "abc", 1, 3, &err);
+  ck_assert_int_eq(fwriter_flush(writer), FILE_WRITE_FAILED);
+  ck_assert_int_eq(writer->buffered, 3);
+  ck_assert_int_eq(fwriter_sync(writer), FILE_WRITE_FAILED);
+  ck_assert_int_eq(writer->buffered, 3);
+  ck_assert_int_eq(write_bytes(writer, data, 1, 100, &err), 0);
+  ck_assert_int_eq(err, FILE_WRITE_FAILED);
+  ck_assert_int_eq(writer->buffered, 3);
+  ck_assert_int_eq(writer->pos, 3);
+
+  // Position counts bytes kept in buffer after failed writef too
+  ck_assert_int_eq(writef(writer, "%0100d", 1), FILE_WRITE_FAILED);
+  ck_assert_int_eq(writer->buffered, 3);
+  ck_assert_int_eq(writer->pos, 3);
+  ck_assert_int_eq(closew(writer), FILE_WRITE_FAILED);
+#endif
+
+  free(data);
+  free(received);
+}
+END_TEST
+
+START_TEST(test_read_bytes_at) {
+  easy_error err = OK;
+
+  fwriter *writer = openw("efile_positioned.bin", WRITE_BIN, NULL);
+  for (int i = 0; i < POSITIONED_RECORDS; i++)
+    writef(writer, "%08d", i);
+  closew(writer);
+
+  freader *reader = openr("efile_positioned.bin", READ_BIN, NULL);
+  char buffer[16];
+  read_bytes(reader, buffer, 1, 4, NULL);
+
+  pthread_t threads[POSITIONED_THREADS];
+  positioned_job jobs[POSITIONED_THREADS];
+  for (int i = 0; i < POSITIONED_THREADS; i++) {
+    jobs[i] = (positioned_job){reader, i, 0};
+    pthread_create(&threads[i], NULL, read_records_at, &jobs[i]);
+  }
+  for (int i = 0; i < POSITIONED_THREADS; i++) {
+    pthread_join(threads[i], NULL);
+    ck_assert_int_eq(jobs[i].mismatches, 0);
+  }
+
+  // Shared position isn't changed
+  ck_assert_int_eq(reader->pos, 4);
+  read_bytes(reader, buffer, 1, 4, NULL);
+  ck_assert_int_eq(memcmp(buffer, "0000", 4), 0);
+
+  // Read is short only at end of file
+  ck_assert_int_eq(read_bytes_at(reader, POSITIONED_RECORDS * 8 - 3, buffer, 16, &err), 3);
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(read_bytes_at(reader, POSITIONED_RECORDS * 8 + 100, buffer, 16, &err), 0);
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(read_bytes_at(reader, 0, NULL, 16, &err), 0);
+  ck_assert_int_eq(err, INVALID_ARGUMENT);
+  ck_assert_int_eq(read_bytes_at(NULL, 0, buffer, 16, &err), 0);
+  ck_assert_int_eq(err, NULL_POINTER);
+
+  closer(reader);
+  remove("efile_positioned.bin");
+}
+END_TEST
+
+START_TEST(test_read_file_parallel) {
+  easy_error err = OK;
+  size_t size = FILE_PARALLEL_CHUNK * 2 + 12345;
+  char *data = (char *)malloc(size);
+  for (size_t i = 0; i < size; i++)
+    data[i] = (char)('a' + (i * 31 + i / 4096) % 26);
+
+  fwriter *writer = openw("efile_parallel.bin", WRITE_BIN, NULL);
+  write_bytes(writer, data, 1, size, NULL);
+  closew(writer);
+
+  size_t threads[] = {0, 1, 3, 100};
+  for (size_t i = 0; i < 4; i++) {
+    for (int flags = FILE_READ_DEFAULT; flags <= FILE_READ_DIRECT; flags++) {
+      string *text = read_file_parallel("efile_parallel.bin", threads[i], flags, &err);
+      ck_assert_int_eq(err, OK);
+      ck_assert_int_eq(string_length(text), size);
+      ck_assert_int_eq(memcmp(string_cstr(text), data, size), 0);
+      ck_assert_int_eq(string_cstr(text)[size], '\0');
+      string_free(text);
+    }
+  }
+  remove("efile_parallel.bin");
+  free(data);
+
+  writer = openw("efile_parallel_empty.bin", WRITE_BIN, NULL);
+  closew(writer);
+  string *text = read_file_parallel("efile_parallel_empty.bin", 4, FILE_READ_DIRECT, &err);
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(string_length(text), 0);
+  ck_assert_str_eq(string_cstr(text), "");
+  string_free(text);
+  remove("efile_parallel_empty.bin");
+
+  ck_assert_ptr_null(read_file_parallel("efile_missing.bin", 2, FILE_READ_DEFAULT, &err));
+  ck_assert_int_eq(err, FILE_OPEN_ERROR);
+  ck_assert_ptr_null(read_file_parallel(NULL, 2, FILE_READ_DEFAULT, &err));
+  ck_assert_int_eq(err, NULL_POINTER);
+}
+END_TEST
+
+// Writes text into fifo, which is read by other thread
+static void *write_fifo(void *arg) {
+  fwriter *writer = openw("efile_copy.fifo", WRITE_BIN, NULL);
+  writef(writer, "%s", (const char *)arg);
+  closew(writer);
+
+  return NULL;
+}
+
+START_TEST(test_file_copy) {
+  easy_error err = OK;
+  size_t size = 3 * 1024 * 1024 + 7;
+  char *data = (char *)malloc(size);
+  for (size_t i = 0; i < size; i++)
+    data[i] = (char)(i * 13 + i / 1000);
+
+  fwriter *writer = openw("efile_copy_src.bin", WRITE_BIN, NULL);
+  write_bytes(writer, data, 1, size, NULL);
+  closew(writer);
+
+  // Existing longer file is truncated
+  writer = openw("efile_copy_dst.bin", WRITE_BIN, NULL);
+  write_bytes(writer, data, 1, size, NULL);
+  write_bytes(writer, data, 1, 100, NULL);
+  closew(writer);
+
+  ck_assert_int_eq(file_copy("efile_copy_src.bin", "efile_copy_dst.bin"), OK);
+  string *copy = read_file_parallel("efile_copy_dst.bin", 1, FILE_READ_DEFAULT, NULL);
+  ck_assert_int_eq(string_length(copy), size);
+  ck_assert_int_eq(memcmp(string_cstr(copy), data, size), 0);
+  string_free(copy);
+
+  ck_assert_int_eq(file_copy("efile_copy_src.bin", "efile_copy_src.bin"), INVALID_ARGUMENT);
+  ck_assert_int_eq(file_copy("efile_missing.bin", "efile_copy_dst.bin"), FILE_OPEN_ERROR);
+  ck_assert_int_eq(file_copy(NULL, "efile_copy_dst.bin"), NULL_POINTER);
+
+  // Range is copied into middle of file, positions aren't changed
+  freader *reader = openr("efile_copy_src.bin", READ_BIN, NULL);
+  writer = openw("efile_copy_dst.bin", WRITE_UPDATE_BIN, NULL);
+  writef(writer, "head");
+  ck_assert_int_eq(file_copy_range(reader, 1000, writer, 10, 5000, &err), 5000);
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(writer->pos, 4);
+  ck_assert_int_eq(reader->pos, 0);
+  ck_assert_int_eq(file_copy_range(reader, size - 10, writer, 5010, FILE_COPY_ALL, &err), 10);
+  ck_assert_int_eq(err, OK);
+  writef(writer, "tail");
+  closew(writer);
+  closer(reader);
+
+  copy = read_file_parallel("efile_copy_dst.bin", 1, FILE_READ_DEFAULT, NULL);
+  ck_assert_int_eq(string_length(copy), 5020);
+  ck_assert_int_eq(memcmp(string_cstr(copy), "headtail", 8), 0);
+  ck_assert_int_eq(memcmp(string_cstr(copy) + 10, data + 1000, 5000), 0);
+  ck_assert_int_eq(memcmp(string_cstr(copy) + 5010, data + size - 10, 10), 0);
+  string_free(copy);
+
+  reader = openr("efile_copy_src.bin", READ_BIN, NULL);
+  writer = openw("efile_copy_dst.bin", APPEND_BIN, NULL);
+  ck_assert_int_eq(file_copy_range(reader, 0, writer, 0, 10, &err), 0);
+  ck_assert_int_eq(err, FILE_INVALID_MODE);
+  closew(writer);
+  closer(reader);
+
+  // Pipe is read until writer closes it
+  remove("efile_copy.fifo");
+  ck_assert_int_eq(mkfifo("efile_copy.fifo", 0600), 0);
+  pthread_t thread;
+  pthread_create(&thread, NULL, write_fifo, "through pipe");
+  ck_assert_int_eq(file_copy("efile_copy.fifo", "efile_copy_dst.bin"), OK);
+  pthread_join(thread, NULL);
+  copy = read_file_parallel("efile_copy_dst.bin", 1, FILE_READ_DEFAULT, NULL);
+  ck_assert_str_eq(string_cstr(copy), "through pipe");
+  string_free(copy);
+  remove("efile_copy.fifo");
+
+#ifdef __linux__
+  // Files of /proc have zero size, but aren't empty
+  ck_assert_int_eq(file_copy("/proc/self/status", "efile_copy_dst.bin"), OK);
+  copy = read_file_parallel("efile_copy_dst.bin", 1, FILE_READ_DEFAULT, NULL);
+  ck_assert_int_gt(string_length(copy), 0);
+  string_free(copy);
+#endif
+
+  remove("efile_copy_src.bin");
+  remove("efile_copy_dst.bin");
+  free(data);
+}
+END_TEST
+
+Suite *efile_suite() {
+  Suite *s = suite_create("File");
+  TCase *tc_efile_read = tcase_create("Read"), *tc_efile_position = tcase_create("Position"),
+        *tc_efile_write = tcase_create("Write");
+
+  tcase_add_test(tc_efile_read, test_read_file_mapped);
+  tcase_add_test(tc_efile_read, test_line_reader);
+  tcase_add_test(tc_efile_read, test_read_bytes_at);
+  tcase_add_test(tc_efile_read, test_read_file_parallel);
+  tcase_add_test(tc_efile_position, test_file_position);
+  tcase_add_test(tc_efile_write, test_buffered_writer);
+  tcase_add_test(tc_efile_write, test_buffered_writer_errors);
+  tcase_add_test(tc_efile_write, test_file_copy);
+
+  suite_add_tcase(s, tc_efile_read);
+  suite_add_tcase(s, tc_efile_position);
+  suite_add_tcase(s, tc_efile_write);
+
+  return s;
+}
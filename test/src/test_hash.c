@@ -0,0 +1,273 @@
+#include <check.h>
+#include <estd/eerror.h>
+#include <estd/efile.h>
+#include <estd/hash.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_hash.h"
+
+// Tests:
+START_TEST(test_sha256_vectors) {
+  char hex[SHA256_HEX_SIZE];
+
+  sha256_hash_hex("", 0, hex);
+  ck_assert_str_eq(hex, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+
+  sha256_hash_hex("abc", 3, hex);
+  ck_assert_str_eq(hex, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+  const char *two_blocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+  sha256_hash_hex(two_blocks, strlen(two_blocks), hex);
+  ck_assert_str_eq(hex, "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+  // Streaming by uneven parts gives same hash
+  sha256_buff buff;
+  uint8_t streamed[SHA256_HASH_SIZE], whole[SHA256_HASH_SIZE];
+  char data[1000];
+  for (size_t i = 0; i < sizeof(data); i++)
+    data[i] = (char)(i * 7);
+
+  sha256_init(&buff);
+  for (size_t i = 0, step = 1; i < sizeof(data); i += step, step = step * 2 + 1)
+    sha256_update(&buff, data + i, (i + step < sizeof(data)) ? step : sizeof(data) - i);
+  sha256_finalize(&buff);
+  sha256_read(&buff, streamed);
+  sha256_hash(data, sizeof(data), whole);
+  ck_assert_int_eq(memcmp(streamed, whole, SHA256_HASH_SIZE), 0);
+}
+END_TEST
+
+START_TEST(test_sha256_impls) {
+  SHA256_IMPL impls[] = {SHA256_SSSE3, SHA256_AVX2, SHA256_SHANI, SHA256_ARMV8};
+  size_t lengths[] = {0, 1, 55, 56, 63, 64, 65, 119, 128, 1000, 4096 + 17};
+  uint8_t data[4096 + 17 + 3], expected[SHA256_HASH_SIZE], hash[SHA256_HASH_SIZE];
+  for (size_t i = 0; i < sizeof(data); i++)
+    data[i] = (uint8_t)(i * 37 + (i >> 5));
+
+  ck_assert(sha256_impl() != SHA256_AUTO);
+  for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+    for (size_t offset = 0; offset < 4; offset += 3) { // Unaligned input too
+      ck_assert(sha256_set_impl(SHA256_SCALAR));
+      sha256_hash(data + offset, lengths[l], expected);
+
+      for (size_t i = 0; i < 4; i++) {
+        if (!sha256_set_impl(impls[i]))
+          continue;
+        ck_assert_int_eq(sha256_impl(), impls[i]);
+        sha256_hash(data + offset, lengths[l], hash);
+        ck_assert_int_eq(memcmp(hash, expected, SHA256_HASH_SIZE), 0);
+      }
+    }
+  }
+
+  ck_assert(sha256_set_impl(SHA256_AUTO));
+  ck_assert(sha256_impl() != SHA256_AUTO);
+}
+END_TEST
+
+START_TEST(test_sha256_many) {
+  SHA256_IMPL impls[] = {SHA256_SCALAR, SHA256_SSSE3, SHA256_AVX2, SHA256_SHANI};
+  uint8_t data[24000];
+  const void *inputs[37];
+  size_t lengths[37];
+  uint8_t hashes[37][SHA256_HASH_SIZE], expected[SHA256_HASH_SIZE];
+  for (size_t i = 0; i < sizeof(data); i++)
+    data[i] = (uint8_t)(i * 13 + (i >> 7));
+
+  // Lengths are uneven, so lanes are finished and refilled at different blocks
+  for (size_t i = 0; i < 37; i++) {
+    inputs[i] = data + i;
+    lengths[i] = (i * i * 71) % 2900;
+  }
+  lengths[3] = 0;
+  lengths[4] = 55;
+  lengths[5] = 56;
+  lengths[6] = 64;
+  lengths[7] = 20000; // Long message among short ones
+
+  for (size_t k = 0; k < 4; k++) {
+    if (!sha256_set_impl(impls[k]))
+      continue;
+    for (size_t count = 0; count <= 37; count += 9) {
+      memset(hashes, 0, sizeof(hashes));
+      sha256_hash_many(inputs, lengths, count, hashes);
+      for (size_t i = 0; i < count; i++) {
+        sha256_hash(inputs[i], lengths[i], expected);
+        ck_assert_int_eq(memcmp(hashes[i], expected, SHA256_HASH_SIZE), 0);
+      }
+    }
+  }
+
+  ck_assert(sha256_set_impl(SHA256_AUTO));
+}
+END_TEST
+
+// Writes checksum of changed state, so import checks its fields
+static void reseal_state(uint8_t state[SHA256_STATE_SIZE]) {
+  uint8_t checksum[SHA256_HASH_SIZE];
+  sha256_hash(state, SHA256_STATE_SIZE - 4, checksum);
+  memcpy(state + SHA256_STATE_SIZE - 4, checksum, 4);
+}
+
+START_TEST(test_sha256_state) {
+  uint8_t data[1000], expected[SHA256_HASH_SIZE], hash[SHA256_HASH_SIZE];
+  uint8_t state[SHA256_STATE_SIZE];
+  for (size_t i = 0; i < sizeof(data); i++)
+    data[i] = (uint8_t)(i * 11);
+  sha256_hash(data, sizeof(data), expected);
+
+  // Hash is continued from exported state at any split
+  size_t splits[] = {0, 1, 63, 64, 65, 500, 1000};
+  for (size_t i = 0; i < sizeof(splits) / sizeof(splits[0]); i++) {
+    sha256_buff buff, resumed;
+    sha256_init(&buff);
+    sha256_update(&buff, data, splits[i]);
+    ck_assert_int_eq(sha256_export(&buff, state), OK);
+    ck_assert_int_eq(state[4], SHA256_STATE_VERSION);
+
+    memset(&resumed, 0xAB, sizeof(resumed));
+    ck_assert_int_eq(sha256_import(&resumed, state, sizeof(state)), OK);
+    sha256_update(&resumed, data + splits[i], sizeof(data) - splits[i]);
+    sha256_finalize(&resumed);
+    sha256_read(&resumed, hash);
+    ck_assert_int_eq(memcmp(hash, expected, SHA256_HASH_SIZE), 0);
+  }
+
+  // Encoding doesn't depend on platform: length and words are big-endian
+  sha256_buff buff;
+  sha256_init(&buff);
+  sha256_update(&buff, "abc", 3);
+  ck_assert_int_eq(sha256_export(&buff, state), OK);
+  ck_assert_int_eq(memcmp(state, "S256\x02\x03\0\0\0\0\0\0\0\x03\x6a\x09\xe6\x67", 18), 0);
+  ck_assert_int_eq(memcmp(state + 46, "abc\0", 4), 0);
+
+  // Prefix is hashed once, clones continue with different data
+  sha256_buff prefix, clone;
+  sha256_init(&prefix);
+  sha256_update(&prefix, data, 100);
+  sha256_clone(&clone, &prefix);
+  sha256_update(&clone, data + 100, sizeof(data) - 100);
+  sha256_finalize(&clone);
+  sha256_read(&clone, hash);
+  ck_assert_int_eq(memcmp(hash, expected, SHA256_HASH_SIZE), 0);
+  sha256_clone(&clone, &prefix);
+  sha256_finalize(&clone);
+  sha256_read(&clone, hash);
+  sha256_hash(data, 100, expected);
+  ck_assert_int_eq(memcmp(hash, expected, SHA256_HASH_SIZE), 0);
+
+  // Damaged, unknown and finalized states are refused
+  ck_assert_int_eq(sha256_export(&clone, state), INVALID_ARGUMENT);
+  ck_assert_int_eq(sha256_export(&prefix, state), OK);
+  ck_assert_int_eq(sha256_import(&buff, state, SHA256_STATE_SIZE - 1), INVALID_ARGUMENT);
+
+  // Every single-bit flip is caught by checksum
+  for (size_t i = 0; i < SHA256_STATE_SIZE * 8; i++) {
+    state[i / 8] ^= (uint8_t)(1 << (i % 8));
+    ck_assert_int_eq(sha256_import(&buff, state, sizeof(state)), INVALID_ENCODING);
+    state[i / 8] ^= (uint8_t)(1 << (i % 8));
+  }
+  ck_assert_int_eq(sha256_import(&buff, state, sizeof(state)), OK);
+
+  // Fields are checked even if checksum matches
+  state[4] = SHA256_STATE_VERSION + 1;
+  reseal_state(state);
+  ck_assert_int_eq(sha256_import(&buff, state, sizeof(state)), INVALID_ENCODING);
+  state[4] = SHA256_STATE_VERSION;
+  state[5] = 37;
+  reseal_state(state);
+  ck_assert_int_eq(sha256_import(&buff, state, sizeof(state)), INVALID_ENCODING);
+  state[5] = 100 % 64;
+  state[0] = 'X';
+  reseal_state(state);
+  ck_assert_int_eq(sha256_import(&buff, state, sizeof(state)), INVALID_ENCODING);
+}
+END_TEST
+
+START_TEST(test_sha256_file) {
+  size_t sizes[] = {0, 100, 64 * 1024, 3 * SHA256_FILE_BUFFER_SIZE + 17};
+  uint8_t expected[SHA256_HASH_SIZE], hash[SHA256_HASH_SIZE];
+  size_t max_size = sizes[3];
+  char *data = (char *)malloc(max_size);
+  for (size_t i = 0; i < max_size; i++)
+    data[i] = (char)(i * 131 + i / 4096);
+
+  for (size_t i = 0; i < 4; i++) {
+    fwriter *writer = openw("hash_file.bin", WRITE_BIN, NULL);
+    write_bytes(writer, data, 1, sizes[i], NULL);
+    closew(writer);
+
+    sha256_hash(data, sizes[i], expected);
+    ck_assert_int_eq(sha256_file("hash_file.bin", hash), OK);
+    ck_assert_int_eq(memcmp(hash, expected, SHA256_HASH_SIZE), 0);
+
+    // Whole file is hashed, position isn't changed
+    freader *reader = openr("hash_file.bin", READ_BIN, NULL);
+    char first[4];
+    read_bytes(reader, first, 1, sizes[i] ? 4 : 0, NULL);
+    int64_t pos = reader->pos;
+    memset(hash, 0, SHA256_HASH_SIZE);
+    ck_assert_int_eq(sha256_freader(reader, hash), OK);
+    ck_assert_int_eq(memcmp(hash, expected, SHA256_HASH_SIZE), 0);
+    ck_assert_int_eq(reader->pos, pos);
+    closer(reader);
+  }
+
+  // Growing file is hashed from saved state, old part isn't read again
+  fwriter *writer = openw("hash_file.bin", WRITE_BIN, NULL);
+  write_bytes(writer, data, 1, 1000, NULL);
+  closew(writer);
+  sha256_buff buff;
+  uint8_t state[SHA256_STATE_SIZE];
+  sha256_init(&buff);
+  freader *reader = openr("hash_file.bin", READ_BIN, NULL);
+  ck_assert_int_eq(sha256_update_freader(&buff, reader), OK);
+  closer(reader);
+  ck_assert_int_eq(sha256_export(&buff, state), OK);
+
+  writer = openw("hash_file.bin", APPEND_BIN, NULL);
+  write_bytes(writer, data + 1000, 1, max_size - 1000, NULL);
+  closew(writer);
+  ck_assert_int_eq(sha256_import(&buff, state, sizeof(state)), OK);
+  reader = openr("hash_file.bin", READ_BIN, NULL);
+  ck_assert_int_eq(sha256_update_freader(&buff, reader), OK);
+  ck_assert_int_eq(buff.data_size, max_size);
+  ck_assert_int_eq(sha256_update_freader(&buff, reader), OK);
+  sha256_finalize(&buff);
+  sha256_read(&buff, hash);
+  sha256_hash(data, max_size, expected);
+  ck_assert_int_eq(memcmp(hash, expected, SHA256_HASH_SIZE), 0);
+
+  // File is shorter than hashed data
+  sha256_init(&buff);
+  sha256_update(&buff, data, max_size);
+  sha256_update(&buff, data, 1);
+  ck_assert_int_eq(sha256_update_freader(&buff, reader), INVALID_ARGUMENT);
+  closer(reader);
+
+  remove("hash_file.bin");
+  free(data);
+
+  ck_assert_int_eq(sha256_file("hash_missing.bin", hash), FILE_OPEN_ERROR);
+  ck_assert_int_eq(sha256_file(NULL, hash), NULL_POINTER);
+  ck_assert_int_eq(sha256_freader(NULL, hash), NULL_POINTER);
+}
+END_TEST
+
+Suite *hash_suite() {
+  Suite *s = suite_create("Hash");
+  TCase *tc_sha256 = tcase_create("SHA256"), *tc_sha256_file = tcase_create("File");
+
+  tcase_add_test(tc_sha256, test_sha256_vectors);
+  tcase_add_test(tc_sha256, test_sha256_impls);
+  tcase_add_test(tc_sha256, test_sha256_many);
+  tcase_add_test(tc_sha256, test_sha256_state);
+  tcase_add_test(tc_sha256_file, test_sha256_file);
+
+  suite_add_tcase(s, tc_sha256);
+  suite_add_tcase(s, tc_sha256_file);
+
+  return s;
+}
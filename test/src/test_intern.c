@@ -0,0 +1,84 @@
+#include <check.h>
+#include <estd/eerror.h>
+#include <estd/estring.h>
+#include <estd/intern.h>
+
+#include <stdio.h>
+
+#include "test_intern.h"
+
+// Tests:
+START_TEST(test_intern_add) {
+  intern_table *table = intern_table_init(0);
+  easy_error err = OK;
+
+  atom foo = intern_add(table, "foo", &err);
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_ne(foo, ATOM_NONE);
+  ck_assert(atom_equal(foo, intern_add_n(table, "foobar", 3, NULL)));
+
+  string *str = string_from_cstr("bar");
+  atom bar = intern_add_string(table, str, NULL);
+  ck_assert(!atom_equal(foo, bar));
+  ck_assert_int_eq(intern_count(table), 2);
+
+  ck_assert_str_eq(intern_cstr(table, bar), "bar");
+  ck_assert_int_eq(intern_view(table, foo).length, 3);
+  ck_assert_ptr_null(intern_cstr(table, ATOM_NONE));
+  ck_assert_ptr_null(intern_cstr(table, 100));
+
+  ck_assert_int_eq(intern_find(table, "bar", 3), bar);
+  ck_assert_int_eq(intern_find(table, "baz", 3), ATOM_NONE);
+
+  intern_add(NULL, "foo", &err);
+  ck_assert_int_eq(err, NULL_POINTER);
+
+  string_free(str);
+  intern_table_free(table);
+}
+END_TEST
+
+START_TEST(test_intern_many) {
+  intern_table *table = intern_table_init(4);
+  char buf[32];
+  atom first[1000];
+
+  for (int i = 0; i < 1000; i++) {
+    snprintf(buf, sizeof(buf), "key_%d", i);
+    first[i] = intern_add(table, buf, NULL);
+  }
+  ck_assert_int_eq(intern_count(table), 1000);
+
+  // Strings are not moved when table grows
+  const char *key = intern_cstr(table, first[0]);
+  for (int i = 0; i < 1000; i++) {
+    snprintf(buf, sizeof(buf), "key_%d", i);
+    ck_assert_int_eq(intern_add(table, buf, NULL), first[i]);
+  }
+  ck_assert_ptr_eq(key, intern_cstr(table, first[0]));
+
+  string_view views[] = {string_view_from_cstr("key_7"), string_view_from_cstr("new"),
+                         string_view_from_cstr("new"), string_view_from_cstr("")};
+  atom out[4];
+  ck_assert_int_eq(OK, intern_add_many(table, views, 4, out));
+  ck_assert_int_eq(out[0], first[7]);
+  ck_assert_int_eq(out[1], out[2]);
+  ck_assert_str_eq(intern_cstr(table, out[3]), "");
+  ck_assert_int_eq(intern_count(table), 1002);
+
+  intern_table_free(table);
+}
+END_TEST
+
+Suite *intern_suite() {
+  Suite *s = suite_create("Intern");
+  TCase *tc_intern_add = tcase_create("Add"), *tc_intern_many = tcase_create("Many");
+
+  tcase_add_test(tc_intern_add, test_intern_add);
+  tcase_add_test(tc_intern_many, test_intern_many);
+
+  suite_add_tcase(s, tc_intern_add);
+  suite_add_tcase(s, tc_intern_many);
+
+  return s;
+}
@@ -0,0 +1,185 @@
+#include <check.h>
+#include <estd/codec.h>
+#include <estd/eerror.h>
+#include <estd/efile.h>
+#include <estd/hash.h>
+#include <estd/merkle.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_merkle.h"
+
+#define LEAF 1024
+#define DATA_SIZE (100 * LEAF + 300)
+
+static void fill(uint8_t *data, size_t size) {
+  for (size_t i = 0; i < size; i++)
+    data[i] = (uint8_t)(i * 31 + (i >> 8));
+}
+
+// Tests:
+START_TEST(test_merkle_layout) {
+  uint8_t data[2500], root[SHA256_HASH_SIZE];
+  char hex[SHA256_HEX_SIZE] = {0};
+  fill(data, sizeof(data));
+
+  // Three leaves: root = H(1 || H(1 || leaf0 || leaf1) || leaf2)
+  easy_error err = OK;
+  merkle_tree *tree = merkle_build(data, sizeof(data), LEAF, 2, &err);
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(tree->leaf_count, 3);
+  ck_assert_int_eq(tree->levels, 3);
+  ck_assert_int_eq(merkle_level_size(tree, 0), 3);
+  ck_assert_int_eq(merkle_level_size(tree, 1), 2);
+  ck_assert_int_eq(merkle_level_size(tree, 2), 1);
+  ck_assert_int_eq(merkle_level_size(tree, 3), 0);
+  ck_assert_ptr_null(merkle_node(tree, 1, 2));
+  ck_assert_int_eq(memcmp(merkle_node(tree, 0, 2), merkle_node(tree, 1, 1), SHA256_HASH_SIZE), 0);
+
+  merkle_root(tree, root);
+  hex_encode(root, SHA256_HASH_SIZE, hex, sizeof(hex), NULL);
+  ck_assert_str_eq(hex, "464b9559ef63f52848fab4a18d2ad36e54d9527d1d1058259e506a8290d54253");
+
+  uint8_t leaf[1 + LEAF], hash[SHA256_HASH_SIZE];
+  leaf[0] = 0x00;
+  memcpy(leaf + 1, data + LEAF, LEAF);
+  sha256_hash(leaf, sizeof(leaf), hash);
+  ck_assert_int_eq(memcmp(merkle_node(tree, 0, 1), hash, SHA256_HASH_SIZE), 0);
+  merkle_free(tree);
+  ck_assert_ptr_null(tree);
+
+  // Empty data is one empty leaf
+  tree = merkle_build(NULL, 0, 0, 0, &err);
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(tree->leaf_size, MERKLE_DEFAULT_LEAF_SIZE);
+  ck_assert_int_eq(tree->levels, 1);
+  merkle_root(tree, root);
+  hex_encode(root, SHA256_HASH_SIZE, hex, sizeof(hex), NULL);
+  ck_assert_str_eq(hex, "6e340b9cffb37a989ca544e6bb780a2c78901d3fb33738768511a30617afa01d");
+  merkle_free(tree);
+
+  ck_assert_ptr_null(merkle_build(data, sizeof(data), 512, 1, &err));
+  ck_assert_int_eq(err, INVALID_ARGUMENT);
+  ck_assert_ptr_null(merkle_build(data, sizeof(data), 3 * LEAF, 1, &err));
+  ck_assert_int_eq(err, INVALID_ARGUMENT);
+  ck_assert_ptr_null(merkle_build(NULL, 10, LEAF, 1, &err));
+  ck_assert_int_eq(err, NULL_POINTER);
+}
+END_TEST
+
+START_TEST(test_merkle_update) {
+  uint8_t *data = (uint8_t *)malloc(DATA_SIZE);
+  fill(data, DATA_SIZE);
+
+  // Count of threads doesn't change tree
+  merkle_tree *old = merkle_build(data, DATA_SIZE, LEAF, 1, NULL);
+  merkle_tree *tree = merkle_build(data, DATA_SIZE, LEAF, 8, NULL);
+  ck_assert_int_eq(tree->leaf_count, 101);
+  ck_assert_int_eq(tree->level_start[tree->levels], old->level_start[old->levels]);
+  ck_assert_int_eq(memcmp(tree->nodes, old->nodes, tree->level_start[tree->levels] * 32), 0);
+
+  // Changed bytes are found only in leaves which contain them
+  data[5 * LEAF + 10] ^= 1;
+  data[7 * LEAF - 1] ^= 1;
+  data[DATA_SIZE - 1] ^= 1;
+  size_t bad[4];
+  easy_error err = OK;
+  ck_assert_int_eq(merkle_verify(tree, data, 0, DATA_SIZE, 0, bad, 4, &err), 3);
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(bad[0], 5);
+  ck_assert_int_eq(bad[1], 6);
+  ck_assert_int_eq(bad[2], 100);
+  ck_assert_int_eq(merkle_verify(tree, data, 6 * LEAF, LEAF, 2, bad, 1, &err), 1);
+  ck_assert_int_eq(merkle_verify(tree, data, 8 * LEAF, 20 * LEAF, 2, bad, 4, &err), 0);
+  ck_assert_int_eq(merkle_verify(tree, data, DATA_SIZE, 1, 2, bad, 4, &err), 0);
+  ck_assert_int_eq(err, INVALID_ARGUMENT);
+
+  // Update of changed ranges gives same tree as building again
+  ck_assert_int_eq(merkle_update(tree, data, 5 * LEAF + 10, 2 * LEAF, 2), OK);
+  ck_assert_int_eq(merkle_update(tree, data, DATA_SIZE - 1, 1, 2), OK);
+  ck_assert_int_eq(merkle_update(tree, data, DATA_SIZE - 1, 2, 2), INVALID_ARGUMENT);
+  ck_assert_int_eq(merkle_verify(tree, data, 0, DATA_SIZE, 0, NULL, 0, NULL), 0);
+  merkle_tree *fresh = merkle_build(data, DATA_SIZE, LEAF, 3, NULL);
+  uint8_t root[SHA256_HASH_SIZE], expected[SHA256_HASH_SIZE];
+  merkle_root(tree, root);
+  merkle_root(fresh, expected);
+  ck_assert_int_eq(memcmp(root, expected, SHA256_HASH_SIZE), 0);
+
+  // Diff visits only different subtrees
+  size_t leaves[8];
+  ck_assert_int_eq(merkle_diff(old, tree, leaves, 8, &err), 3);
+  ck_assert_int_eq(leaves[0], 5);
+  ck_assert_int_eq(leaves[1], 6);
+  ck_assert_int_eq(leaves[2], 100);
+  ck_assert_int_eq(merkle_diff(tree, fresh, leaves, 8, &err), 0);
+  merkle_tree *small = merkle_build(data, LEAF, LEAF, 1, NULL);
+  ck_assert_int_eq(merkle_diff(tree, small, leaves, 8, &err), 0);
+  ck_assert_int_eq(err, INVALID_ARGUMENT);
+
+  merkle_free(small);
+  merkle_free(fresh);
+  merkle_free(old);
+  merkle_free(tree);
+  free(data);
+}
+END_TEST
+
+START_TEST(test_merkle_file) {
+  uint8_t *data = (uint8_t *)malloc(DATA_SIZE);
+  fill(data, DATA_SIZE);
+  fwriter *writer = openw("merkle_data.bin", WRITE_BIN, NULL);
+  write_bytes(writer, data, 1, DATA_SIZE, NULL);
+  closew(writer);
+
+  easy_error err = OK;
+  merkle_tree *tree = merkle_build_file("merkle_data.bin", LEAF, 4, &err);
+  ck_assert_int_eq(err, OK);
+  merkle_tree *expected = merkle_build(data, DATA_SIZE, LEAF, 1, NULL);
+  ck_assert_int_eq(merkle_diff(tree, expected, NULL, 0, NULL), 0);
+
+  // Leaves bigger than buffer of reading
+  merkle_tree *big = merkle_build_file("merkle_data.bin", 0, 2, &err);
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(big->leaf_count, 1);
+  merkle_free(big);
+
+  // Part of file is changed, only its leaves are read again
+  data[50 * LEAF] ^= 0xFF;
+  writer = openw("merkle_data.bin", READ_UPDATE_BIN, NULL);
+  fseek(writer->fp, 50 * LEAF, SEEK_SET);
+  fputc(data[50 * LEAF], writer->fp);
+  closew(writer);
+
+  freader *reader = openr("merkle_data.bin", READ_BIN, NULL);
+  size_t bad = 0;
+  ck_assert_int_eq(merkle_verify_freader(tree, reader, 0, DATA_SIZE, 4, &bad, 1, &err), 1);
+  ck_assert_int_eq(bad, 50);
+  ck_assert_int_eq(merkle_update_freader(tree, reader, 50 * LEAF, 1, 4), OK);
+  ck_assert_int_eq(merkle_diff(tree, expected, &bad, 1, NULL), 1);
+  ck_assert_int_eq(bad, 50);
+  ck_assert_int_eq(reader->pos, 0);
+  closer(reader);
+
+  ck_assert_ptr_null(merkle_build_file("merkle_missing.bin", LEAF, 1, &err));
+  ck_assert_int_eq(err, FILE_OPEN_ERROR);
+
+  merkle_free(expected);
+  merkle_free(tree);
+  remove("merkle_data.bin");
+  free(data);
+}
+END_TEST
+
+Suite *merkle_suite() {
+  Suite *s = suite_create("Merkle");
+  TCase *tc_merkle = tcase_create("Core");
+
+  tcase_add_test(tc_merkle, test_merkle_layout);
+  tcase_add_test(tc_merkle, test_merkle_update);
+  tcase_add_test(tc_merkle, test_merkle_file);
+
+  suite_add_tcase(s, tc_merkle);
+
+  return s;
+}
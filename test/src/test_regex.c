@@ -0,0 +1,144 @@
+#include <check.h>
+#include <estd/eerror.h>
+#include <estd/efile.h>
+#include <estd/estring.h>
+#include <estd/regex.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "test_regex.h"
+
+static string_view view(const char *cstr) { return (string_view){cstr, strlen(cstr)}; }
+
+static bool count_line(string_view line, size_t line_number, void *ctx) {
+  (void)line_number;
+  if (line.length > 0 && line.data[0] == 'e')
+    (*(int *)ctx)++;
+  return true;
+}
+
+// Tests:
+START_TEST(test_regex_compile) {
+  easy_error err = OK;
+
+  regex *re = regex_compile("(a|b)(?:c+)\\d{2,3}", &err);
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(regex_groups(re), 2);
+  regex_free(re);
+  ck_assert_ptr_null(re);
+
+  const char *bad[] = {"(a", "a)", "[a", "*a", "a{3,1}", "\\", "a{1001}"};
+  for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+    re = regex_compile(bad[i], &err);
+    ck_assert_ptr_null(re);
+    ck_assert_int_eq(err, REGEX_INVALID);
+  }
+
+  regex_compile(NULL, &err);
+  ck_assert_int_eq(err, NULL_POINTER);
+}
+END_TEST
+
+START_TEST(test_regex_find) {
+  easy_error err = OK;
+  regex_match groups[3];
+
+  regex *re = regex_compile("(\\w+)@(\\w+)\\.com", NULL);
+  string_view text = view("mail: john@example.com, bob@test.org");
+
+  ck_assert(regex_is_match(re, text));
+  ck_assert(regex_find(re, text, 0, groups, 3, &err));
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(groups[0].start, 6);
+  ck_assert_int_eq(groups[0].end, 22);
+  ck_assert_int_eq(groups[1].start, 6);
+  ck_assert_int_eq(groups[1].end, 10);
+  ck_assert_int_eq(groups[2].start, 11);
+  ck_assert_int_eq(groups[2].end, 18);
+  ck_assert(!regex_find(re, text, 7 + 16, groups, 3, &err));
+  regex_free(re);
+
+  // Leftmost match, then Perl preference: lazy and alternatives
+  re = regex_compile("a+?b|a", NULL);
+  ck_assert(regex_find(re, view("xaaab"), 0, groups, 1, NULL));
+  ck_assert_int_eq(groups[0].start, 1);
+  ck_assert_int_eq(groups[0].end, 5);
+  regex_free(re);
+
+  re = regex_compile("^(a)?b$", NULL);
+  ck_assert(regex_find(re, view("b"), 0, groups, 2, NULL));
+  ck_assert_int_eq(groups[1].start, REGEX_NO_POS);
+  ck_assert(!regex_is_match(re, view("ab\n")));
+  regex_free(re);
+}
+END_TEST
+
+START_TEST(test_regex_find_all) {
+  regex_match out[4];
+
+  regex *re = regex_compile("[0-9]+", NULL);
+  string *str = string_from_cstr("1 22 333 4444 55555");
+  ck_assert_int_eq(regex_find_all_string(re, str, out, 4, NULL), 5);
+  ck_assert_int_eq(out[3].start, 9);
+  ck_assert_int_eq(out[3].end, 13);
+  ck_assert_int_eq(regex_find_all_string(re, str, NULL, 0, NULL), 5);
+  string_free(str);
+  regex_free(re);
+
+  // Empty matches don't loop forever
+  re = regex_compile("x*", NULL);
+  ck_assert_int_eq(regex_find_all(re, view("axxb"), out, 4, NULL), 4);
+  ck_assert_int_eq(out[1].start, 1);
+  ck_assert_int_eq(out[1].end, 3);
+  regex_free(re);
+
+  // Long text uses literal prefix skipping and DFA cache
+  char big[1 << 16];
+  for (size_t i = 0; i < sizeof(big); i++)
+    big[i] = 'a' + (char)(i % 23);
+  memcpy(big + 50000, "needle123", 9);
+  re = regex_compile("needle\\d+", NULL);
+  ck_assert_int_eq(regex_find_all(re, (string_view){big, sizeof(big)}, out, 4, NULL), 1);
+  ck_assert_int_eq(out[0].start, 50000);
+  ck_assert_int_eq(out[0].end, 50009);
+  regex_free(re);
+}
+END_TEST
+
+START_TEST(test_regex_grep) {
+  easy_error err = OK;
+
+  fwriter *writer = openw("regex_grep.txt", WRITE_BIN, NULL);
+  for (int i = 0; i < 10000; i++)
+    fprintf(writer->fp, (i % 100 == 0) ? "error %d\n" : "line %d\n", i);
+  closew(writer);
+
+  regex *re = regex_compile("^error \\d+$", NULL);
+  freader *reader = openr("regex_grep.txt", READ_BIN, NULL);
+  int lines = 0;
+  ck_assert_int_eq(regex_grep(re, reader, count_line, &lines, &err), 100);
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(lines, 100);
+  closer(reader);
+  remove("regex_grep.txt");
+
+  regex_free(re);
+}
+END_TEST
+
+Suite *regex_suite() {
+  Suite *s = suite_create("Regex");
+  TCase *tc_regex_compile = tcase_create("Compile"), *tc_regex_find = tcase_create("Find"),
+        *tc_regex_grep = tcase_create("Grep");
+
+  tcase_add_test(tc_regex_compile, test_regex_compile);
+  tcase_add_test(tc_regex_find, test_regex_find);
+  tcase_add_test(tc_regex_find, test_regex_find_all);
+  tcase_add_test(tc_regex_grep, test_regex_grep);
+
+  suite_add_tcase(s, tc_regex_compile);
+  suite_add_tcase(s, tc_regex_find);
+  suite_add_tcase(s, tc_regex_grep);
+
+  return s;
+}
@@ -0,0 +1,79 @@
+#include <check.h>
+#include <estd/eerror.h>
+#include <estd/estring.h>
+#include <estd/rope.h>
+
+#include "test_rope.h"
+
+// Tests:
+START_TEST(test_rope_edit) {
+  rope *r = rope_from_string(string_from_cstr("Hello world"));
+  easy_error err = OK;
+
+  ck_assert_int_eq(rope_length(r), 11);
+  ck_assert_int_eq(OK, rope_insert(r, 5, ","));
+  ck_assert_int_eq(OK, rope_insert(r, 12, "!"));
+  ck_assert_int_eq(OK, rope_insert(r, 0, ">> "));
+  ck_assert_int_eq(INVALID_INDEX, rope_insert(r, 100, "?"));
+  ck_assert_int_eq(INVALID_ARGUMENT, rope_insert(r, 0, NULL));
+  ck_assert_int_eq(NULL_POINTER, rope_insert(NULL, 0, "?"));
+
+  string *str = rope_flatten(r, &err);
+  ck_assert_int_eq(err, OK);
+  ck_assert_str_eq(string_cstr(str), ">> Hello, world!");
+  string_free(str);
+
+  ck_assert_int_eq(OK, rope_erase(r, 3, 7));
+  ck_assert_int_eq(OK, rope_erase(r, 8, 100));
+  str = rope_flatten(r, NULL);
+  ck_assert_str_eq(string_cstr(str), ">> world");
+  string_free(str);
+
+  ck_assert_int_eq(rope_at(r, 3, NULL), 'w');
+  rope_at(r, 8, &err);
+  ck_assert_int_eq(err, INVALID_INDEX);
+
+  str = rope_substring(r, 1, 4, NULL);
+  ck_assert_str_eq(string_cstr(str), "> wo");
+  string_free(str);
+
+  rope_free(r);
+  ck_assert_ptr_null(r);
+}
+END_TEST
+
+START_TEST(test_rope_iter) {
+  rope *r = rope_init_empty();
+
+  for (int i = 0; i < 100; i++)
+    rope_append_n(r, "ab", 2);
+  rope_insert(r, 100, "--");
+  ck_assert_int_eq(rope_length(r), 202);
+
+  rope_iter it = rope_iter_init(r, 0);
+  string_view chunk;
+  size_t total = 0, chunks = 0;
+  while (rope_iter_next(&it, &chunk)) {
+    total += chunk.length;
+    chunks++;
+  }
+
+  ck_assert_int_eq(total, 202);
+  ck_assert_int_eq(chunks, 3); // Appends are merged into one piece
+
+  rope_free(r);
+}
+END_TEST
+
+Suite *rope_suite() {
+  Suite *s = suite_create("Rope");
+  TCase *tc_rope_edit = tcase_create("Edit"), *tc_rope_iter = tcase_create("Iterator");
+
+  tcase_add_test(tc_rope_edit, test_rope_edit);
+  tcase_add_test(tc_rope_iter, test_rope_iter);
+
+  suite_add_tcase(s, tc_rope_edit);
+  suite_add_tcase(s, tc_rope_iter);
+
+  return s;
+}
@@ -0,0 +1,69 @@
+#include <check.h>
+#include <estd/eerror.h>
+#include <estd/estring.h>
+#include <estd/shstring.h>
+
+#include "test_shstring.h"
+
+// Tests:
+START_TEST(test_shared_string_copy) {
+  shared_string *str = shared_string_from_cstr("payload");
+  shared_string *copy = shared_string_copy(str);
+
+  ck_assert_ptr_eq(str, copy);
+  ck_assert_int_eq(shared_string_refs(str), 2);
+  ck_assert_int_eq(shared_string_length(copy), 7);
+
+  shared_string_free(copy);
+  ck_assert_ptr_null(copy);
+  ck_assert_int_eq(shared_string_refs(str), 1);
+  ck_assert_str_eq(shared_string_cstr(str), "payload");
+
+  ck_assert_ptr_null(shared_string_from_cstr(NULL));
+  ck_assert_int_eq(shared_string_refs(NULL), 0);
+
+  shared_string_free(str);
+}
+END_TEST
+
+START_TEST(test_shared_string_write) {
+  shared_string *str = shared_string_from_cstr("Foo");
+  shared_string *copy = shared_string_copy(str);
+
+  // Writing into shared string makes private copy
+  ck_assert_int_eq(OK, shared_string_append(&copy, "Bar"));
+  ck_assert_ptr_ne(str, copy);
+  ck_assert_str_eq(shared_string_cstr(str), "Foo");
+  ck_assert_str_eq(shared_string_cstr(copy), "FooBar");
+  ck_assert_int_eq(shared_string_refs(str), 1);
+  ck_assert_int_eq(shared_string_refs(copy), 1);
+
+  char *data = shared_string_data_mut(&str, NULL);
+  data[0] = 'B';
+  ck_assert_str_eq(shared_string_cstr(str), "Boo");
+
+  string *plain = shared_string_to_string(copy, NULL);
+  ck_assert_str_eq(string_cstr(plain), "FooBar");
+  ck_assert_int_eq(shared_string_view(copy).length, 6);
+
+  ck_assert_int_eq(NULL_POINTER, shared_string_append(NULL, "Bar"));
+  ck_assert_int_eq(INVALID_ARGUMENT, shared_string_append(&str, NULL));
+
+  string_free(plain);
+  shared_string_free(copy);
+  shared_string_free(str);
+}
+END_TEST
+
+Suite *shared_string_suite() {
+  Suite *s = suite_create("Shared string");
+  TCase *tc_sh_copy = tcase_create("Copy"), *tc_sh_write = tcase_create("Write");
+
+  tcase_add_test(tc_sh_copy, test_shared_string_copy);
+  tcase_add_test(tc_sh_write, test_shared_string_write);
+
+  suite_add_tcase(s, tc_sh_copy);
+  suite_add_tcase(s, tc_sh_write);
+
+  return s;
+}
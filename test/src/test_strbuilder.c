@@ -0,0 +1,57 @@
+#include <check.h>
+#include <estd/eerror.h>
+#include <estd/estring.h>
+#include <estd/strbuilder.h>
+
+#include "test_strbuilder.h"
+
+// Tests:
+START_TEST(test_string_builder_append) {
+  string_builder *sb = string_builder_init(4);
+
+  ck_assert_int_eq(NULL_POINTER, string_builder_append(NULL, "Foo"));
+  ck_assert_int_eq(INVALID_ARGUMENT, string_builder_append(sb, NULL));
+
+  ck_assert_int_eq(OK, string_builder_append(sb, "Foo"));
+  ck_assert_int_eq(OK, string_builder_appendc(sb, ','));
+  ck_assert_int_eq(OK, string_builder_appendc(sb, ' '));
+  ck_assert_int_eq(OK, string_builder_append_n(sb, "Barrrr", 3));
+  ck_assert_int_eq(OK, string_builder_append_view(sb, string_view_from_cstr(" and long tail")));
+  ck_assert_int_eq(string_builder_length(sb), 22);
+
+  string *str = string_builder_build(sb, NULL);
+  ck_assert_str_eq(string_cstr(str), "Foo, Bar and long tail");
+  ck_assert_int_eq(str->length, 22);
+
+  string_free(str);
+  string_builder_free(sb);
+}
+END_TEST
+
+START_TEST(test_string_builder_clear) {
+  string_builder *sb = string_builder_init(0);
+
+  string_builder_append(sb, "Foo");
+  ck_assert_int_eq(OK, string_builder_clear(sb));
+  ck_assert_int_eq(string_builder_length(sb), 0);
+
+  string *str = string_builder_build(sb, NULL);
+  ck_assert_str_eq(string_cstr(str), "");
+
+  string_free(str);
+  string_builder_free(sb);
+}
+END_TEST
+
+Suite *string_builder_suite() {
+  Suite *s = suite_create("String builder");
+  TCase *tc_sb_append = tcase_create("Append"), *tc_sb_clear = tcase_create("Clear");
+
+  tcase_add_test(tc_sb_append, test_string_builder_append);
+  tcase_add_test(tc_sb_clear, test_string_builder_clear);
+
+  suite_add_tcase(s, tc_sb_append);
+  suite_add_tcase(s, tc_sb_clear);
+
+  return s;
+}
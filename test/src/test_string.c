@@ -19,6 +19,56 @@ END_TEST
 START_TEST(test_boyer_moore) { ck_assert_int_eq(boyer_moore_search("ABCDE", "CD"), 2); }
 END_TEST
 
+START_TEST(test_boyer_moore_n) {
+  ck_assert_int_eq(boyer_moore_search_n("ABCDE", 5, "CD", 2), 2);
+  ck_assert_int_eq(boyer_moore_search_n("AB\0CD", 5, "CD", 2), 3);
+  ck_assert_int_eq(boyer_moore_search_n("AB", 2, "ABC", 3), -1);
+  ck_assert_int_eq(boyer_moore_search_n(NULL, 0, "A", 1), NULL_POINTER);
+}
+END_TEST
+
+START_TEST(test_string_find) {
+  string *str = string_create("abcabcab");
+
+  ck_assert_int_eq(string_find(NULL, "a"), NULL_POINTER);
+  ck_assert_int_eq(string_find(str, NULL), INVALID_ARGUMENT);
+
+  ck_assert_int_eq(string_find(str, "cab"), 2);
+  ck_assert_int_eq(string_find(str, "abd"), -1);
+  ck_assert_int_eq(string_find_from(str, 3, "ab"), 3);
+  ck_assert_int_eq(string_find_from(str, 4, "ab"), 6);
+  ck_assert_int_eq(string_find_from(str, 9, "ab"), -1);
+  ck_assert_int_eq(string_rfind(str, "abc"), 3);
+  ck_assert_int_eq(string_rfind(str, "b"), 7);
+  ck_assert_int_eq(string_rfind(str, "x"), -1);
+
+  string_free(str);
+}
+END_TEST
+
+START_TEST(test_string_find_all) {
+  string *str = string_create("aaaa-aa");
+  size_t pos[4];
+  easy_error err;
+
+  string_count(str, "", &err);
+  ck_assert_int_eq(err, INVALID_ARGUMENT);
+
+  ck_assert_int_eq(string_count(str, "aa", &err), 3);
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(string_count(str, "b", NULL), 0);
+
+  ck_assert_int_eq(string_find_all(str, "aa", pos, 2, &err), 3);
+  ck_assert_int_eq(pos[0], 0);
+  ck_assert_int_eq(pos[1], 2);
+
+  ck_assert_int_eq(string_find_all(str, "aa", pos, 4, &err), 3);
+  ck_assert_int_eq(pos[2], 5);
+
+  string_free(str);
+}
+END_TEST
+
 START_TEST(test_string_init) {
   string *str1 = string_init_empty();
   ck_assert_str_eq(string_cstr(str1), "");
@@ -113,6 +163,34 @@ START_TEST(test_string_compare) {
 }
 END_TEST
 
+START_TEST(test_string_equal) {
+  string *str1 = string_create("key_1"), *str2 = string_create("key_1"),
+         *str3 = string_create("key_2");
+
+  ck_assert(!string_equal(NULL, str1));
+  ck_assert(string_equal(str1, str2));
+  ck_assert(!string_equal(str1, str3));
+
+  ck_assert_int_eq(string_hash(NULL), 0);
+  ck_assert_int_ne(string_hash(str1), 0);
+  ck_assert(string_hash(str1) == string_hash(str2));
+  ck_assert(string_hash(str1) != string_hash(str3));
+  ck_assert(string_equal(str1, str2));
+  ck_assert(!string_equal(str1, str3));
+
+  // Cached hash is dropped after changing
+  uint64_t old_hash = string_hash(str3);
+  string_appendc(str3, 'x');
+  ck_assert_int_eq(str3->hash, 0);
+  ck_assert(string_hash(str3) != old_hash);
+  ck_assert(string_hash(str3) == hash_bytes("key_2x", 6));
+
+  string_free(str1);
+  string_free(str2);
+  string_free(str3);
+}
+END_TEST
+
 START_TEST(test_string_clear) {
   ck_assert_int_eq(NULL_POINTER, string_clear(NULL));
 
@@ -135,6 +213,102 @@ START_TEST(test_string_shrink_to_fit) {
 }
 END_TEST
 
+START_TEST(test_string_appendf) {
+  ck_assert_int_eq(NULL_POINTER, string_appendf(NULL, "%d", 1));
+
+  string *str = string_create("Foo");
+  ck_assert_int_eq(INVALID_ARGUMENT, string_appendf(str, NULL));
+
+  ck_assert_int_eq(OK, string_appendf(str, " %s %d", "Bar", 42));
+  ck_assert_str_eq(string_cstr(str), "Foo Bar 42");
+
+  ck_assert_int_eq(OK, string_appendf(str, "%040d", 7));
+  ck_assert_int_eq(str->length, 50);
+
+  string_free(str);
+}
+END_TEST
+
+START_TEST(test_string_append_numbers) {
+  string *str = string_init_empty();
+
+  string_append_i64(str, INT64_MIN);
+  string_appendc(str, ' ');
+  string_append_i64(str, -7);
+  string_appendc(str, ' ');
+  string_append_u64(str, UINT64_MAX);
+  string_appendc(str, ' ');
+  string_append_hex(str, 0xdeadbeef);
+  ck_assert_str_eq(string_cstr(str), "-9223372036854775808 -7 18446744073709551615 deadbeef");
+
+  string_clear(str);
+  string_append_f64(str, 0.1);
+  string_appendc(str, ' ');
+  string_append_f64(str, -1.5e300);
+  string_appendc(str, ' ');
+  string_append_f64(str, 100.0);
+  string_appendc(str, ' ');
+  string_append_f64(str, 0.000123);
+  string_appendc(str, ' ');
+  string_append_f64(str, 5e-324);
+  ck_assert_str_eq(string_cstr(str), "0.1 -1.5e+300 100 0.000123 5e-324");
+
+  string_free(str);
+}
+END_TEST
+
+START_TEST(test_string_to_int) {
+  int64_t i64;
+  uint64_t u64;
+  size_t used;
+
+  ck_assert_int_eq(INVALID_ARGUMENT, string_to_i64("1", 1, NULL, NULL));
+  ck_assert_int_eq(NUMBER_INVALID, string_to_i64("-x", 2, &i64, &used));
+  ck_assert_int_eq(used, 0);
+
+  ck_assert_int_eq(OK, string_to_i64("-12345678901,", 13, &i64, &used));
+  ck_assert_int_eq(i64, -12345678901LL);
+  ck_assert_int_eq(used, 12);
+
+  ck_assert_int_eq(OK, string_to_i64("12345", 3, &i64, &used));
+  ck_assert_int_eq(i64, 123);
+
+  ck_assert_int_eq(NUMBER_OUT_OF_RANGE, string_to_i64("9223372036854775808", 19, &i64, NULL));
+  ck_assert_int_eq(i64, INT64_MAX);
+
+  ck_assert_int_eq(OK, string_to_u64("18446744073709551615", 20, &u64, NULL));
+  ck_assert_uint_eq(u64, UINT64_MAX);
+  ck_assert_int_eq(NUMBER_INVALID, string_to_u64("-1", 2, &u64, NULL));
+}
+END_TEST
+
+START_TEST(test_string_to_f64) {
+  double value;
+  size_t used;
+
+  ck_assert_int_eq(NUMBER_INVALID, string_to_f64(".e1", 3, &value, &used));
+
+  ck_assert_int_eq(OK, string_to_f64("0.1;", 4, &value, &used));
+  ck_assert_double_eq(value, 0.1);
+  ck_assert_int_eq(used, 3);
+
+  ck_assert_int_eq(OK, string_to_f64("-1.5e300", 8, &value, NULL));
+  ck_assert_double_eq(value, -1.5e300);
+
+  // Exponent without digits is not consumed
+  ck_assert_int_eq(OK, string_to_f64("2e+", 3, &value, &used));
+  ck_assert_double_eq(value, 2.0);
+  ck_assert_int_eq(used, 1);
+
+  ck_assert_int_eq(OK, string_to_f64("2.2250738585072011e-308", 23, &value, NULL));
+  ck_assert_double_eq(value, 2.2250738585072011e-308);
+
+  ck_assert_int_eq(OK, string_to_f64("-Infinity", 9, &value, &used));
+  ck_assert_int_eq(used, 9);
+  ck_assert(value < 0 && value * 0 != 0);
+}
+END_TEST
+
 Suite *string_suit() {
   Suite *s = suite_create("Easy string");
   TCase *tc_boyer_moore = tcase_create("Boyer Moore search algorithm"),
@@ -143,10 +317,12 @@ Suite *string_suit() {
         *tc_string_clear = tcase_create("Clear"),
         *tc_string_shrink_to_fit = tcase_create("Shrink to fit"),
         *tc_string_at = tcase_create("At index"), *tc_string_insert = tcase_create("Insert"),
-        *tc_string_compare = tcase_create("Compare");
+        *tc_string_compare = tcase_create("Compare"), *tc_string_find = tcase_create("Find"),
+        *tc_string_format = tcase_create("Format"), *tc_string_parse = tcase_create("Parse");
 
   tcase_add_test(tc_boyer_moore, test_bad_char_table);
   tcase_add_test(tc_boyer_moore, test_boyer_moore);
+  tcase_add_test(tc_boyer_moore, test_boyer_moore_n);
   tcase_add_test(tc_string_init, test_string_init);
   tcase_add_test(tc_string_append, test_string_append);
   tcase_add_test(tc_string_reserve, test_string_reserve);
@@ -155,6 +331,13 @@ Suite *string_suit() {
   tcase_add_test(tc_string_clear, test_string_clear);
   tcase_add_test(tc_string_shrink_to_fit, test_string_shrink_to_fit);
   tcase_add_test(tc_string_compare, test_string_compare);
+  tcase_add_test(tc_string_compare, test_string_equal);
+  tcase_add_test(tc_string_find, test_string_find);
+  tcase_add_test(tc_string_find, test_string_find_all);
+  tcase_add_test(tc_string_format, test_string_appendf);
+  tcase_add_test(tc_string_format, test_string_append_numbers);
+  tcase_add_test(tc_string_parse, test_string_to_int);
+  tcase_add_test(tc_string_parse, test_string_to_f64);
 
   suite_add_tcase(s, tc_boyer_moore);
   suite_add_tcase(s, tc_string_init);
@@ -165,6 +348,9 @@ Suite *string_suit() {
   suite_add_tcase(s, tc_string_clear);
   suite_add_tcase(s, tc_string_shrink_to_fit);
   suite_add_tcase(s, tc_string_compare);
+  suite_add_tcase(s, tc_string_find);
+  suite_add_tcase(s, tc_string_format);
+  suite_add_tcase(s, tc_string_parse);
 
   return s;
 }
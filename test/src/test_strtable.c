@@ -0,0 +1,105 @@
+#include <check.h>
+#include <estd/eerror.h>
+#include <estd/efile.h>
+#include <estd/strtable.h>
+
+#include <stdio.h>
+
+#include "test_strtable.h"
+
+// Tests:
+START_TEST(test_string_table_push) {
+  string_table *table = string_table_init(0, 0);
+  easy_error err = OK;
+
+  ck_assert_int_eq(NULL_POINTER, string_table_push(NULL, "Foo"));
+  ck_assert_int_eq(INVALID_ARGUMENT, string_table_push(table, NULL));
+
+  ck_assert_int_eq(OK, string_table_push(table, "Foo"));
+  ck_assert_int_eq(OK, string_table_push_n(table, "Barrrr", 3));
+  ck_assert_int_eq(OK, string_table_push_view(table, string_view_from_cstr("")));
+  ck_assert_int_eq(string_table_count(table), 3);
+
+  ck_assert_str_eq(string_table_cstr(table, 1, &err), "Bar");
+  ck_assert_int_eq(string_table_get(table, 0, NULL).length, 3);
+  ck_assert_int_eq(string_table_get(table, 2, NULL).length, 0);
+
+  string_table_get(table, 3, &err);
+  ck_assert_int_eq(err, INVALID_INDEX);
+
+  ck_assert_int_eq(OK, string_table_clear(table));
+  ck_assert_int_eq(string_table_count(table), 0);
+
+  string_table_free(table);
+}
+END_TEST
+
+START_TEST(test_string_table_sort) {
+  string_table *table = string_table_init(4, 16);
+  const char *words[] = {"pear", "apple", "fig", "apple", "app", "pear", "apple"};
+
+  for (size_t i = 0; i < 7; i++)
+    string_table_push(table, words[i]);
+
+  ck_assert_int_eq(OK, string_table_sort(table));
+  ck_assert_str_eq(string_table_cstr(table, 0, NULL), "app");
+  ck_assert_str_eq(string_table_cstr(table, 1, NULL), "apple");
+  ck_assert_str_eq(string_table_cstr(table, 6, NULL), "pear");
+
+  ck_assert_int_eq(OK, string_table_dedup(table));
+  ck_assert_int_eq(string_table_count(table), 4);
+  ck_assert_str_eq(string_table_cstr(table, 1, NULL), "apple");
+  ck_assert_str_eq(string_table_cstr(table, 2, NULL), "fig");
+  ck_assert_str_eq(string_table_cstr(table, 3, NULL), "pear");
+  ck_assert_int_eq(string_table_bytes(table), 19);
+
+  string_table_free(table);
+}
+END_TEST
+
+START_TEST(test_string_table_serialize) {
+  string_table *table = string_table_init(0, 0);
+  char buf[32];
+  easy_error err = OK;
+
+  for (int i = 0; i < 1000; i++) {
+    snprintf(buf, sizeof(buf), "string_%d", i);
+    string_table_push(table, buf);
+  }
+  string_table_push_n(table, "a\0b", 3);
+
+  fwriter *writer = openw("string_table.bin", WRITE_BIN, NULL);
+  ck_assert_int_eq(OK, string_table_write(table, writer));
+  closew(writer);
+
+  freader *reader = openr("string_table.bin", READ_BIN, NULL);
+  string_table *copy = string_table_read(reader, &err);
+  closer(reader);
+  remove("string_table.bin");
+
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(string_table_count(copy), 1001);
+  ck_assert_int_eq(string_table_bytes(copy), string_table_bytes(table));
+  ck_assert_str_eq(string_table_cstr(copy, 999, NULL), "string_999");
+  ck_assert_int_eq(string_table_get(copy, 1000, NULL).length, 3);
+
+  string_table_free(copy);
+  string_table_free(table);
+}
+END_TEST
+
+Suite *string_table_suite() {
+  Suite *s = suite_create("String table");
+  TCase *tc_st_push = tcase_create("Push"), *tc_st_sort = tcase_create("Sort"),
+        *tc_st_serialize = tcase_create("Serialize");
+
+  tcase_add_test(tc_st_push, test_string_table_push);
+  tcase_add_test(tc_st_sort, test_string_table_sort);
+  tcase_add_test(tc_st_serialize, test_string_table_serialize);
+
+  suite_add_tcase(s, tc_st_push);
+  suite_add_tcase(s, tc_st_sort);
+  suite_add_tcase(s, tc_st_serialize);
+
+  return s;
+}
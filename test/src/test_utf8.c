@@ -0,0 +1,99 @@
+#include <check.h>
+#include <estd/eerror.h>
+#include <estd/estring.h>
+#include <estd/utf8.h>
+
+#include <string.h>
+
+#include "test_utf8.h"
+
+// Tests:
+START_TEST(test_utf8_validate) {
+  const char *text = "Hello, \xD0\x9C\xD0\xB8\xD1\x80! \xE2\x82\xAC \xF0\x9F\x98\x80"
+                     " and some long ASCII tail to pass SIMD block";
+
+  ck_assert(utf8_validate(text, strlen(text)));
+  ck_assert(utf8_validate("", 0));
+  ck_assert(!utf8_validate("\xC0\xAF", 2));         // Overlong
+  ck_assert(!utf8_validate("\xED\xA0\x80", 3));     // Surrogate
+  ck_assert(!utf8_validate("\xF4\x90\x80\x80", 4)); // Above U+10FFFF
+  ck_assert(!utf8_validate("abc\xE2\x82", 5));      // Truncated
+
+  char buf[100];
+  memset(buf, 'a', sizeof(buf));
+  buf[70] = '\x80';
+  ck_assert(!utf8_validate(buf, sizeof(buf)));
+
+  ck_assert_int_eq(utf8_count(text, strlen(text)), strlen(text) - 8);
+}
+END_TEST
+
+START_TEST(test_utf8_next) {
+  const char *text = "a\xD0\x9C\xE2\x82\xAC\xFF";
+  size_t pos = 0;
+  uint32_t cp = 0;
+
+  ck_assert_int_eq(OK, utf8_next(text, 7, &pos, &cp));
+  ck_assert_int_eq(cp, 'a');
+  ck_assert_int_eq(OK, utf8_next(text, 7, &pos, &cp));
+  ck_assert_int_eq(cp, 0x41C);
+  ck_assert_int_eq(OK, utf8_next(text, 7, &pos, &cp));
+  ck_assert_int_eq(cp, 0x20AC);
+  ck_assert_int_eq(INVALID_ENCODING, utf8_next(text, 7, &pos, &cp));
+  ck_assert_int_eq(pos, 7);
+  ck_assert_int_eq(INVALID_INDEX, utf8_next(text, 7, &pos, &cp));
+}
+END_TEST
+
+START_TEST(test_utf8_transcode) {
+  const char *text = "x\xD0\x9C\xE2\x82\xAC\xF0\x9F\x98\x80";
+  uint16_t u16[8];
+  uint32_t u32[8];
+  char back[16];
+  easy_error err = OK;
+
+  ck_assert_int_eq(utf8_to_utf16(text, 10, NULL, 0, &err), 5);
+  ck_assert_int_eq(utf8_to_utf16(text, 10, u16, 8, &err), 5);
+  ck_assert_int_eq(err, OK);
+  ck_assert_int_eq(u16[3], 0xD83D);
+  ck_assert_int_eq(u16[4], 0xDE00);
+
+  ck_assert_int_eq(utf8_to_utf32(text, 10, u32, 8, &err), 4);
+  ck_assert_int_eq(u32[3], 0x1F600);
+
+  ck_assert_int_eq(utf16_to_utf8(u16, 5, back, sizeof(back), &err), 10);
+  ck_assert_int_eq(memcmp(back, text, 10), 0);
+  ck_assert_int_eq(utf32_to_utf8(u32, 4, back, sizeof(back), &err), 10);
+  ck_assert_int_eq(memcmp(back, text, 10), 0);
+
+  utf8_to_utf16(text, 10, u16, 2, &err);
+  ck_assert_int_eq(err, INVALID_ARGUMENT);
+  utf8_to_utf32("\xC0\xAF", 2, u32, 8, &err);
+  ck_assert_int_eq(err, INVALID_ENCODING);
+
+  string *str = string_from_cstr("");
+  ck_assert_int_eq(OK, string_append_utf16(str, u16, 5));
+  ck_assert_int_eq(OK, string_append_utf32(str, u32, 1));
+  ck_assert(string_is_utf8(str));
+  ck_assert_int_eq(string_utf8_count(str), 5);
+  ck_assert_int_eq(str->length, 11);
+
+  string_free(str);
+}
+END_TEST
+
+Suite *utf8_suite() {
+  Suite *s = suite_create("UTF-8");
+  TCase *tc_utf8_validate = tcase_create("Validate"), *tc_utf8_next = tcase_create("Next"),
+        *tc_utf8_transcode = tcase_create("Transcode");
+
+  tcase_add_test(tc_utf8_validate, test_utf8_validate);
+  tcase_add_test(tc_utf8_next, test_utf8_next);
+  tcase_add_test(tc_utf8_transcode, test_utf8_transcode);
+
+  suite_add_tcase(s, tc_utf8_validate);
+  suite_add_tcase(s, tc_utf8_next);
+  suite_add_tcase(s, tc_utf8_transcode);
+
+  return s;
+}